@@ -389,6 +389,17 @@ bool Base::XMLReader::isRegistered(Base::Persistence *Object) const
     return false;
 }
 
+void Base::XMLReader::attachObject(const std::string& Name, std::shared_ptr<Base::Persistence> Object)
+{
+    AttachedObjects[Name] = Object;
+}
+
+Base::Persistence* Base::XMLReader::getAttachedObject(const std::string& Name) const
+{
+    auto it = AttachedObjects.find(Name);
+    return it != AttachedObjects.end() ? it->second.get() : nullptr;
+}
+
 void Base::XMLReader::addName(const char*, const char*)
 {
 }
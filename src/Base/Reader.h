@@ -185,6 +185,10 @@ public:
     /// get all registered file names
     const std::vector<std::string>& getFilenames() const;
     bool isRegistered(Base::Persistence *Object) const;
+    /// keep \a Object under \a Name as long as the reader exists
+    void attachObject(const std::string& Name, std::shared_ptr<Base::Persistence> Object);
+    /// get the object attached under \a Name or null
+    Base::Persistence* getAttachedObject(const std::string& Name) const;
     virtual void addName(const char*, const char*);
     virtual const char* getName(const char*) const;
     virtual bool doNameMapping() const;
@@ -288,6 +292,7 @@ protected:
     bool _verbose;
 
     std::vector<std::string> FileNames;
+    std::map<std::string, std::shared_ptr<Base::Persistence> > AttachedObjects;
 
     std::bitset<32> StatusBits;
 };
@@ -213,6 +213,17 @@ const std::vector<std::string>& Writer::getFilenames() const
     return FileNames;
 }
 
+void Writer::attachObject(const std::string& Name, std::shared_ptr<Base::Persistence> Object)
+{
+    AttachedObjects[Name] = Object;
+}
+
+Base::Persistence* Writer::getAttachedObject(const std::string& Name) const
+{
+    auto it = AttachedObjects.find(Name);
+    return it != AttachedObjects.end() ? it->second.get() : nullptr;
+}
+
 void Writer::incInd()
 {
     if (indent < 1020) {
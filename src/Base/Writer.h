@@ -24,6 +24,8 @@
 #define BASE_WRITER_H
 
 
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <sstream>
@@ -95,6 +97,14 @@ public:
     void clearModes();
     //@}
 
+    /** @name Attached objects */
+    //@{
+    /// keep \a Object under \a Name as long as the writer exists
+    void attachObject(const std::string& Name, std::shared_ptr<Base::Persistence> Object);
+    /// get the object attached under \a Name or null
+    Base::Persistence* getAttachedObject(const std::string& Name) const;
+    //@}
+
     /** @name Error handling */
     //@{
     void addError(const std::string&);
@@ -128,6 +138,7 @@ protected:
     std::vector<std::string> FileNames;
     std::vector<std::string> Errors;
     std::set<std::string> Modes;
+    std::map<std::string, std::shared_ptr<Base::Persistence> > AttachedObjects;
 
     short indent;
     char indBuf[1024];
@@ -23,19 +23,15 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+#include <algorithm>
+#include <functional>
 #include <numeric>
 
-#include <gp_Pnt.hxx>
-#include <BRepExtrema_DistShapeShape.hxx>
-#include <BRepBuilderAPI_MakeVertex.hxx>
-#include <BRepClass3d_SolidClassifier.hxx>
-#include <BRepGProp_Face.hxx>
-#include <TopoDS.hxx>
-
 #include <QtConcurrentMap>
 #include <QEventLoop>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QThread>
 #endif
 
 #include <App/Application.h>
@@ -51,14 +47,14 @@
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Points/App/PointsFeature.h>
-#include <Mod/Points/App/PointsGrid.h>
+#include <Mod/Points/App/PointsKDTree.h>
 #include <Mod/Part/App/PartFeature.h>
 
 #include "InspectionFeature.h"
+#include "ShapeDistance.h"
 
 
 using namespace Inspection;
-namespace bp = boost::placeholders;
 
 InspectActualMesh::InspectActualMesh(const Mesh::MeshObject& rMesh) : _mesh(rMesh.getKernel())
 {
@@ -402,109 +398,60 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point) const
 
 // ----------------------------------------------------------------
 
-InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float /*offset*/)
-  : _rKernel(Kernel)
+InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float offset)
+  : _rKernel(Kernel), _radius(offset)
 {
-    int uGridPerAxis = 50; // totally 125.000 grid elements 
-    this->_pGrid = new Points::PointsGrid (Kernel, uGridPerAxis);
+    this->_pTree = new Points::PointsKDTree(Kernel);
 }
 
 InspectNominalPoints::~InspectNominalPoints()
 {
-    delete this->_pGrid;
+    delete this->_pTree;
 }
 
 float InspectNominalPoints::getDistance(const Base::Vector3f& point) const
 {
-    //TODO: Make faster
-    std::set<unsigned long> indices;
-    unsigned long x,y,z;
-    Base::Vector3d pointd(point.x,point.y,point.z);
-    _pGrid->Position(pointd, x, y, z);
-    _pGrid->GetElements(x,y,z,indices);
-
-    double fMinDist=DBL_MAX;
-    for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        Base::Vector3d pt = _rKernel.getPoint(*it);
-        double fDist = Base::Distance(pointd, pt);
-        if (fDist < fMinDist) {
-            fMinDist = fDist;
-        }
-    }
-
-    return (float)fMinDist;
+    // points farther away than the search radius are rejected anyway
+    Points::PointsKDTree::size_type index;
+    float fMinDist;
+    if (!_pTree->FindNearest(point, _radius, index, fMinDist))
+        return FLT_MAX;
+    return fMinDist;
 }
 
 // ----------------------------------------------------------------
 
-InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float /*radius*/)
-    : _rShape(shape)
-    , isSolid(false)
-{
-    distss = new BRepExtrema_DistShapeShape();
-    distss->LoadS1(_rShape);
-
-    // When having a solid then use its shell because otherwise the distance
-    // for inner points will always be zero
-    if (!_rShape.IsNull() && _rShape.ShapeType() == TopAbs_SOLID) {
-        TopExp_Explorer xp;
-        xp.Init(_rShape, TopAbs_SHELL);
-        if (xp.More()) {
-           distss->LoadS1(xp.Current());
-           isSolid = true;
-        }
+InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float radius)
+    : distance(nullptr)
+    , radius(radius)
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
 
+    // The tessellation is only used to find the nearest face of a point and to
+    // check if it's inside a solid, the distance is computed on the exact surface
+    double deflection = 0.1;
+    if (!shape.IsNull()) {
+        Base::BoundBox3d bbox = Part::TopoShape(shape).getBoundBox();
+        deflection = (bbox.LengthX() + bbox.LengthY() + bbox.LengthZ())/300.0 * deviation;
     }
-    //distss->SetDeflection(radius);
+
+    distance = new ShapeDistance(shape, deflection);
 }
 
 InspectNominalShape::~InspectNominalShape()
 {
-    delete distss;
+    delete distance;
 }
 
 float InspectNominalShape::getDistance(const Base::Vector3f& point) const
 {
-    gp_Pnt pnt3d(point.x,point.y,point.z);
-    BRepBuilderAPI_MakeVertex mkVert(pnt3d);
-    distss->LoadS2(mkVert.Vertex());
-
-    float fMinDist=FLT_MAX;
-    if (distss->Perform() && distss->NbSolution() > 0) {
-        fMinDist = (float)distss->Value();
-        // the shape is a solid, check if the vertex is inside
-        if (isSolid) {
-            const Standard_Real tol = 0.001;
-            BRepClass3d_SolidClassifier classifier(_rShape);
-            classifier.Perform(pnt3d, tol);
-            if (classifier.State() == TopAbs_IN) {
-                fMinDist = -fMinDist;
-            }
-
-        }
-        else if (fMinDist > 0) {
-            // check if the distance was compued from a face
-            for (Standard_Integer index = 1; index <= distss->NbSolution(); index++) {
-                if (distss->SupportTypeShape1(index) == BRepExtrema_IsInFace) {
-                    TopoDS_Shape face = distss->SupportOnShape1(index);
-                    Standard_Real u, v;
-                    distss->ParOnFaceS1(index, u, v);
-                    //gp_Pnt pnt = distss->PointOnShape1(index);
-                    BRepGProp_Face props(TopoDS::Face(face));
-                    gp_Vec normal;
-                    gp_Pnt center;
-                    props.Normal(u, v, center, normal);
-                    gp_Vec dir(center, pnt3d);
-                    Standard_Real scalar = normal.Dot(dir);
-                    if (scalar < 0) {
-                        fMinDist = -fMinDist;
-                    }
-                    break;
-                }
-            }
-        }
-    }
-    return fMinDist;
+    Base::Vector3d pnt3d(point.x, point.y, point.z);
+    double dist = distance->getDistance(pnt3d, radius);
+    if (dist >= FLT_MAX)
+        return FLT_MAX;
+    return static_cast<float>(dist);
 }
 
 // ----------------------------------------------------------------
@@ -700,6 +647,8 @@ public:
     }
     double getRMS()
     {
+        if (this->m_numv == 0)
+            return 0.0;
         return sqrt(this->m_sumsq / (double)this->m_numv);
     }
     int m_numv;
@@ -737,8 +686,6 @@ short Feature::mustExecute() const
 
 App::DocumentObjectExecReturn* Feature::execute(void)
 {
-    bool useMultithreading = true;
-
     App::DocumentObject* pcActual = Actual.getValue();
     if (!pcActual)
         throw Base::ValueError("No actual geometry to inspect specified");
@@ -753,7 +700,6 @@ App::DocumentObjectExecReturn* Feature::execute(void)
         actual = new InspectActualPoints(pts->Points.getValue());
     }
     else if (pcActual->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
-        useMultithreading = false;
         Part::Feature* part = static_cast<Part::Feature*>(pcActual);
         actual = new InspectActualShape(part->Shape.getShape());
     }
@@ -775,7 +721,6 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             nominal = new InspectNominalPoints(pts->Points.getValue(), this->SearchRadius.getValue());
         }
         else if ((*it)->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
-            useMultithreading = false;
             Part::Feature* part = static_cast<Part::Feature*>(*it);
             nominal = new InspectNominalShape(part->Shape.getValue(), this->SearchRadius.getValue());
         }
@@ -784,101 +729,40 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             inspectNominal.push_back(nominal);
     }
 
-#if 0
-#if 1 // test with some huge data sets
-    std::vector<unsigned long> index(actual->countPoints());
-    std::generate(index.begin(), index.end(), Base::iotaGen<unsigned long>(0));
-    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
-    QFuture<float> future = QtConcurrent::mapped
-        (index, boost::bind(&DistanceInspection::mapped, &check, bp::_1));
-    //future.waitForFinished(); // blocks the GUI
-    Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
-    QFutureWatcher<float> watcher;
-    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
-                     &progress, SLOT(progressValueChanged(int)));
-
-    // keep it responsive during computation
-    QEventLoop loop;
-    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
-    watcher.setFuture(future);
-    loop.exec();
-
-    std::vector<float> vals;
-    vals.insert(vals.end(), future.begin(), future.end());
-#else
-    DistanceInspection insp(this->SearchRadius.getValue(), actual, inspectNominal);
     unsigned long count = actual->countPoints();
-    std::stringstream str;
-    str << "Inspecting " << this->Label.getValue() << "...";
-    Base::SequencerLauncher seq(str.str().c_str(), count);
-
     std::vector<float> vals(count);
-    for (unsigned long index = 0; index < count; index++) {
-        float fMinDist = insp.mapped(index);
-        vals[index] = fMinDist;
-        seq.next();
-    }
-#endif
-
-    Distances.setValues(vals);
-
-    float fRMS = 0;
-    int countRMS = 0;
-    for (std::vector<float>::iterator it = vals.begin(); it != vals.end(); ++it) {
-        if (fabs(*it) < FLT_MAX) {
-            fRMS += (*it) * (*it);
-            countRMS++;
-        }
-    }
+    DistanceInspection insp(this->SearchRadius.getValue(), actual, inspectNominal);
 
-    if (countRMS > 0) {
-        fRMS = fRMS / countRMS;
-        fRMS = sqrt(fRMS);
-    }
+    // The points are processed in blocks to keep the scheduling overhead low.
+    // Each block writes its own range of the distances.
+    const unsigned long blockSize = 1024;
+    std::vector<std::pair<unsigned long, unsigned long> > blocks;
+    for (unsigned long index = 0; index < count; index += blockSize)
+        blocks.emplace_back(index, std::min<unsigned long>(count, index + blockSize));
 
-    Base::Console().Message("RMS value for '%s' with search radius [%.4f,%.4f] is: %.4f\n",
-        this->Label.getValue(), -this->SearchRadius.getValue(), this->SearchRadius.getValue(), fRMS);
-#else
-    unsigned long count = actual->countPoints();
-    std::vector<float> vals(count);
-    std::function<DistanceInspectionRMS(int)> fMap = [&](unsigned int index)
+    std::function<DistanceInspectionRMS(const std::pair<unsigned long, unsigned long>&)> fMap =
+        [&](const std::pair<unsigned long, unsigned long>& block)
     {
         DistanceInspectionRMS res;
-        Base::Vector3f pnt = actual->getPoint(index);
-
-        float fMinDist = FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
-            float fDist = (*it)->getDistance(pnt);
-            if (fabs(fDist) < fabs(fMinDist))
-                fMinDist = fDist;
-        }
-
-        if (fMinDist > this->SearchRadius.getValue()) {
-            fMinDist = FLT_MAX;
-        }
-        else if (-fMinDist > this->SearchRadius.getValue()) {
-            fMinDist = -FLT_MAX;
-        }
-        else {
-            res.m_sumsq += fMinDist * fMinDist;
-            res.m_numv++;
+        for (unsigned long index = block.first; index < block.second; index++) {
+            float fMinDist = insp.mapped(index);
+            if (fabs(fMinDist) < FLT_MAX) {
+                res.m_sumsq += fMinDist * fMinDist;
+                res.m_numv++;
+            }
+            vals[index] = fMinDist;
         }
-
-        vals[index] = fMinDist;
         return res;
     };
 
     DistanceInspectionRMS res;
 
-    if (useMultithreading) {
-        // Build vector of increasing indices
-        std::vector<unsigned long> index(count);
-        std::iota(index.begin(), index.end(), 0);
+    if (QThread::idealThreadCount() > 1 && blocks.size() > 1) {
         // Perform map-reduce operation : compute distances and update sum of squares for RMS computation
         QFuture<DistanceInspectionRMS> future = QtConcurrent::mappedReduced(
-            index, fMap, &DistanceInspectionRMS::operator+=);
+            blocks, fMap, &DistanceInspectionRMS::operator+=);
         // Setup progress bar
-        Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
+        Base::FutureWatcherProgress progress("Inspecting...", static_cast<unsigned int>(blocks.size()));
         QFutureWatcher<DistanceInspectionRMS> watcher;
         QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
             &progress, SLOT(progressValueChanged(int)));
@@ -893,16 +777,17 @@ App::DocumentObjectExecReturn* Feature::execute(void)
         // Single-threaded operation
         std::stringstream str;
         str << "Inspecting " << this->Label.getValue() << "...";
-        Base::SequencerLauncher seq(str.str().c_str(), count);
+        Base::SequencerLauncher seq(str.str().c_str(), blocks.size());
 
-        for (unsigned int i = 0; i < count; i++)
-            res += fMap(i);
+        for (const auto& it : blocks) {
+            res += fMap(it);
+            seq.next();
+        }
     }
 
     Base::Console().Message("RMS value for '%s' with search radius [%.4f,%.4f] is: %.4f\n",
         this->Label.getValue(), -this->SearchRadius.getValue(), this->SearchRadius.getValue(), res.getRMS());
     Distances.setValues(vals);
-#endif
 
     delete actual;
     for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it)
@@ -31,7 +31,6 @@
 
 
 class TopoDS_Shape;
-class BRepExtrema_DistShapeShape;
 
 namespace MeshCore {
 class MeshKernel;
@@ -39,13 +38,18 @@ class MeshGrid;
 }
 
 namespace Mesh   { class MeshObject; }
-namespace Points { class PointsGrid; }
+namespace Points { class PointsKDTree; }
 namespace Part   { class TopoShape;  }
 
 namespace Inspection
 {
 
-/** Delivers the number of points to be checked and returns the appropriate point to an index. */
+class ShapeDistance;
+
+/** Delivers the number of points to be checked and returns the appropriate point to an index.
+ * The points are requested from several threads at the same time, so getPoint() must not
+ * modify any state.
+ */
 class InspectionExport InspectActualGeometry
 {
 public:
@@ -93,7 +97,11 @@ private:
     std::vector<Base::Vector3d> points;
 };
 
-/** Calculates the shortest distance of the underlying geometry to a given point. */
+/** Calculates the shortest distance of the underlying geometry to a given point.
+ * getDistance() is called from several threads at the same time and must be reentrant.
+ * Search structures like grids are therefore built in the constructor and only read
+ * afterwards.
+ */
 class InspectionExport InspectNominalGeometry
 {
 public:
@@ -142,7 +150,8 @@ public:
 
 private:
     const Points::PointKernel& _rKernel;
-    Points::PointsGrid* _pGrid;
+    Points::PointsKDTree* _pTree;
+    float _radius;
 };
 
 class InspectionExport InspectNominalShape : public InspectNominalGeometry
@@ -153,9 +162,8 @@ public:
     virtual float getDistance(const Base::Vector3f&) const;
 
 private:
-    BRepExtrema_DistShapeShape* distss;
-    const TopoDS_Shape& _rShape;
-    bool isSolid;
+    ShapeDistance* distance;
+    float radius;
 };
 
 class InspectionExport PropertyDistanceList: public App::PropertyLists
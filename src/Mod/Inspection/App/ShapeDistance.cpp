@@ -0,0 +1,660 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#include <BRep_Tool.hxx>
+#include <BRepClass3d_SolidClassifier.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTopAdaptor_FClass2d.hxx>
+#include <Geom_Surface.hxx>
+#include <gp_Pnt2d.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Precision.hxx>
+#include <ShapeAnalysis_Surface.hxx>
+#include <Standard_Failure.hxx>
+#include <Standard_Version.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#endif
+
+#include <Base/BoundBox.h>
+#include <Mod/Part/App/Tools.h>
+
+#include "ShapeDistance.h"
+
+
+using namespace Inspection;
+
+namespace {
+
+struct Triangle
+{
+    Base::Vector3d p[3];
+    gp_Pnt2d uv[3];
+    int face;
+};
+
+struct Node
+{
+    Base::BoundBox3d box;
+    std::size_t first = 0;
+    std::size_t count = 0;  // number of triangles of a leaf, 0 for inner nodes
+    std::size_t right = 0;  // the left child directly follows its parent
+};
+
+struct FaceData
+{
+    TopoDS_Face face;
+    Handle(Geom_Surface) surface;
+    bool hasUV;
+};
+
+struct Candidate
+{
+    int face;
+    double dist2;
+    gp_Pnt2d uv;
+};
+
+const std::size_t LeafSize = 4;
+
+double distance2(const Base::BoundBox3d& box, const Base::Vector3d& p)
+{
+    double dx = std::max(std::max(box.MinX - p.x, p.x - box.MaxX), 0.0);
+    double dy = std::max(std::max(box.MinY - p.y, p.y - box.MaxY), 0.0);
+    double dz = std::max(std::max(box.MinZ - p.z, p.z - box.MaxZ), 0.0);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+/* Returns the nearest point of the triangle abc to p and its barycentric coordinates.
+ * See Christer Ericson, Real-Time Collision Detection, 5.1.5 */
+Base::Vector3d nearestPoint(const Base::Vector3d& p, const Triangle& tria, double bc[3])
+{
+    const Base::Vector3d& a = tria.p[0];
+    const Base::Vector3d& b = tria.p[1];
+    const Base::Vector3d& c = tria.p[2];
+    Base::Vector3d ab = b - a;
+    Base::Vector3d ac = c - a;
+
+    Base::Vector3d ap = p - a;
+    double d1 = ab * ap;
+    double d2 = ac * ap;
+    if (d1 <= 0.0 && d2 <= 0.0) {
+        bc[0] = 1.0; bc[1] = 0.0; bc[2] = 0.0;
+        return a;
+    }
+
+    Base::Vector3d bp = p - b;
+    double d3 = ab * bp;
+    double d4 = ac * bp;
+    if (d3 >= 0.0 && d4 <= d3) {
+        bc[0] = 0.0; bc[1] = 1.0; bc[2] = 0.0;
+        return b;
+    }
+
+    double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        double t = d1 / (d1 - d3);
+        bc[0] = 1.0 - t; bc[1] = t; bc[2] = 0.0;
+        return a + ab * t;
+    }
+
+    Base::Vector3d cp = p - c;
+    double d5 = ab * cp;
+    double d6 = ac * cp;
+    if (d6 >= 0.0 && d5 <= d6) {
+        bc[0] = 0.0; bc[1] = 0.0; bc[2] = 1.0;
+        return c;
+    }
+
+    double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        double t = d2 / (d2 - d6);
+        bc[0] = 1.0 - t; bc[1] = 0.0; bc[2] = t;
+        return a + ac * t;
+    }
+
+    double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+        double t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        bc[0] = 0.0; bc[1] = 1.0 - t; bc[2] = t;
+        return b + (c - b) * t;
+    }
+
+    double denom = 1.0 / (va + vb + vc);
+    double v = vb * denom;
+    double w = vc * denom;
+    bc[0] = 1.0 - v - w; bc[1] = v; bc[2] = w;
+    return a + ab * v + ac * w;
+}
+
+enum class RayHit {
+    None,
+    Crossing,
+    Ambiguous
+};
+
+/* Moeller-Trumbore ray-triangle intersection. A hit close to an edge or a vertex
+ * is reported as ambiguous because it may be counted for two triangles. */
+RayHit intersect(const Base::Vector3d& p, const Base::Vector3d& dir, const Triangle& tria)
+{
+    const double eps = 1e-9;
+    Base::Vector3d e1 = tria.p[1] - tria.p[0];
+    Base::Vector3d e2 = tria.p[2] - tria.p[0];
+    Base::Vector3d h = dir % e2;
+    double det = e1 * h;
+    if (std::fabs(det) <= eps * e1.Length() * e2.Length())
+        return RayHit::None; // parallel or degenerated
+
+    double inv = 1.0 / det;
+    Base::Vector3d s = p - tria.p[0];
+    double u = inv * (s * h);
+    if (u < -eps || u > 1.0 + eps)
+        return RayHit::None;
+
+    Base::Vector3d q = s % e1;
+    double v = inv * (dir * q);
+    if (v < -eps || u + v > 1.0 + eps)
+        return RayHit::None;
+
+    double t = inv * (e2 * q);
+    if (t <= 0.0)
+        return RayHit::None;
+
+    if (u < eps || v < eps || u + v > 1.0 - eps)
+        return RayHit::Ambiguous;
+    return RayHit::Crossing;
+}
+
+bool intersect(const Base::Vector3d& p, const Base::Vector3d& invdir, const Base::BoundBox3d& box)
+{
+    double t1 = (box.MinX - p.x) * invdir.x;
+    double t2 = (box.MaxX - p.x) * invdir.x;
+    double tmin = std::min(t1, t2);
+    double tmax = std::max(t1, t2);
+
+    t1 = (box.MinY - p.y) * invdir.y;
+    t2 = (box.MaxY - p.y) * invdir.y;
+    tmin = std::max(tmin, std::min(t1, t2));
+    tmax = std::min(tmax, std::max(t1, t2));
+
+    t1 = (box.MinZ - p.z) * invdir.z;
+    t2 = (box.MaxZ - p.z) * invdir.z;
+    tmin = std::max(tmin, std::min(t1, t2));
+    tmax = std::min(tmax, std::max(t1, t2));
+
+    return tmax >= std::max(tmin, 0.0);
+}
+
+}
+
+// ----------------------------------------------------------------
+
+class ShapeDistance::Private
+{
+public:
+    /* The OCC classes to project a point onto a surface and to classify a uv point
+     * keep internal state. So, each query uses its own instances. */
+    struct Context
+    {
+        std::vector<Handle(ShapeAnalysis_Surface)> surfaces;
+        std::vector<std::unique_ptr<BRepTopAdaptor_FClass2d> > classifiers;
+        std::vector<std::size_t> stack;
+        std::vector<Candidate> candidates;
+        std::unique_ptr<BRepClass3d_SolidClassifier> solidClassifier;
+    };
+
+    struct Hit
+    {
+        double dist2 = DBL_MAX;
+        std::size_t triangle = 0;
+        Base::Vector3d point;
+        double bc[3];
+    };
+
+    Private(const TopoDS_Shape& shape, double defl)
+        : deflection(defl)
+        , solid(false)
+        , exactShape(shape)
+    {
+        if (shape.IsNull())
+            return;
+        solid = shape.ShapeType() == TopAbs_SOLID;
+        tessellate(shape);
+        if (!triangles.empty()) {
+            std::vector<std::size_t> order(triangles.size());
+            for (std::size_t i = 0; i < order.size(); i++)
+                order[i] = i;
+            std::vector<Base::Vector3d> centers(triangles.size());
+            for (std::size_t i = 0; i < triangles.size(); i++)
+                centers[i] = (triangles[i].p[0] + triangles[i].p[1] + triangles[i].p[2]) / 3.0;
+            nodes.reserve(2 * triangles.size() / LeafSize + 1);
+            build(order, centers, 0, order.size());
+
+            // store the triangles in the order of the leaves
+            std::vector<Triangle> sorted;
+            sorted.reserve(triangles.size());
+            for (std::size_t i : order)
+                sorted.push_back(triangles[i]);
+            triangles.swap(sorted);
+        }
+    }
+
+    void tessellate(const TopoDS_Shape& shape)
+    {
+        BRepMesh_IncrementalMesh mesh(shape, deflection);
+
+        int index = 0;
+        for (TopExp_Explorer xp(shape, TopAbs_FACE); xp.More(); xp.Next()) {
+            const TopoDS_Face& face = TopoDS::Face(xp.Current());
+            TopLoc_Location loc;
+            Handle(Poly_Triangulation) hTria = BRep_Tool::Triangulation(face, loc);
+            if (hTria.IsNull())
+                continue;
+
+            FaceData data;
+            data.face = face;
+            data.surface = BRep_Tool::Surface(face);
+            data.hasUV = hTria->HasUVNodes() ? true : false;
+            if (data.surface.IsNull())
+                continue;
+
+            gp_Trsf transf;
+            bool identity = loc.IsIdentity();
+            if (!identity)
+                transf = loc.Transformation();
+            bool reversed = face.Orientation() == TopAbs_REVERSED;
+
+#if OCC_VERSION_HEX < 0x070600
+            const TColgp_Array1OfPnt& points = hTria->Nodes();
+            const Poly_Array1OfTriangle& tria = hTria->Triangles();
+#endif
+            for (int i = 1; i <= hTria->NbTriangles(); i++) {
+                Standard_Integer n[3];
+#if OCC_VERSION_HEX < 0x070600
+                tria(i).Get(n[0], n[1], n[2]);
+#else
+                hTria->Triangle(i).Get(n[0], n[1], n[2]);
+#endif
+                // keep the triangles oriented like the face
+                if (reversed)
+                    std::swap(n[0], n[1]);
+
+                Triangle t;
+                t.face = index;
+                for (int j = 0; j < 3; j++) {
+#if OCC_VERSION_HEX < 0x070600
+                    gp_Pnt p = points(n[j]);
+                    if (data.hasUV)
+                        t.uv[j] = hTria->UVNodes()(n[j]);
+#else
+                    gp_Pnt p = hTria->Node(n[j]);
+                    if (data.hasUV)
+                        t.uv[j] = hTria->UVNode(n[j]);
+#endif
+                    if (!identity)
+                        p.Transform(transf);
+                    t.p[j].Set(p.X(), p.Y(), p.Z());
+                }
+                triangles.push_back(t);
+            }
+
+            faces.push_back(data);
+            index++;
+        }
+    }
+
+    std::size_t build(std::vector<std::size_t>& order, const std::vector<Base::Vector3d>& centers,
+                      std::size_t first, std::size_t last)
+    {
+        std::size_t index = nodes.size();
+        nodes.emplace_back();
+
+        Base::BoundBox3d box, cbox;
+        for (std::size_t i = first; i < last; i++) {
+            const Triangle& t = triangles[order[i]];
+            box.Add(t.p[0]);
+            box.Add(t.p[1]);
+            box.Add(t.p[2]);
+            cbox.Add(centers[order[i]]);
+        }
+        nodes[index].box = box;
+
+        if (last - first <= LeafSize) {
+            nodes[index].first = first;
+            nodes[index].count = last - first;
+            return index;
+        }
+
+        // split at the median of the triangle centers along the longest axis
+        int axis = 0;
+        if (cbox.LengthY() > cbox.LengthX())
+            axis = 1;
+        if (cbox.LengthZ() > std::max(cbox.LengthX(), cbox.LengthY()))
+            axis = 2;
+
+        std::size_t mid = (first + last) / 2;
+        std::nth_element(order.begin() + first, order.begin() + mid, order.begin() + last,
+                         [&centers, axis](std::size_t a, std::size_t b) {
+            return centers[a][static_cast<unsigned short>(axis)] < centers[b][static_cast<unsigned short>(axis)];
+        });
+
+        build(order, centers, first, mid);
+        std::size_t right = build(order, centers, mid, last);
+        nodes[index].right = right;
+        return index;
+    }
+
+    void nearest(const Base::Vector3d& p, Context& ctx, Hit& hit) const
+    {
+        std::vector<std::size_t>& stack = ctx.stack;
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty()) {
+            std::size_t index = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[index];
+            if (distance2(node.box, p) >= hit.dist2)
+                continue;
+
+            if (node.count > 0) {
+                for (std::size_t i = node.first; i < node.first + node.count; i++) {
+                    double bc[3];
+                    Base::Vector3d pnt = nearestPoint(p, triangles[i], bc);
+                    double dist2 = Base::DistanceP2(p, pnt);
+                    if (dist2 < hit.dist2) {
+                        hit.dist2 = dist2;
+                        hit.triangle = i;
+                        hit.point = pnt;
+                        std::copy(bc, bc + 3, hit.bc);
+                    }
+                }
+            }
+            else {
+                // visit the nearer child first
+                std::size_t left = index + 1;
+                if (distance2(nodes[left].box, p) < distance2(nodes[node.right].box, p)) {
+                    stack.push_back(node.right);
+                    stack.push_back(left);
+                }
+                else {
+                    stack.push_back(left);
+                    stack.push_back(node.right);
+                }
+            }
+        }
+    }
+
+    /* Collects the faces with triangles nearer than radius and the nearest point
+     * on their tessellation as start value for the projection. */
+    void collect(const Base::Vector3d& p, double radius, Context& ctx) const
+    {
+        double radius2 = radius * radius;
+        std::vector<std::size_t>& stack = ctx.stack;
+        std::vector<Candidate>& candidates = ctx.candidates;
+        candidates.clear();
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty()) {
+            std::size_t index = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[index];
+            if (distance2(node.box, p) > radius2)
+                continue;
+
+            if (node.count == 0) {
+                stack.push_back(index + 1);
+                stack.push_back(node.right);
+                continue;
+            }
+
+            for (std::size_t i = node.first; i < node.first + node.count; i++) {
+                const Triangle& t = triangles[i];
+                double bc[3];
+                double dist2 = Base::DistanceP2(p, nearestPoint(p, t, bc));
+                if (dist2 > radius2)
+                    continue;
+
+                auto it = std::find_if(candidates.begin(), candidates.end(), [&t](const Candidate& c) {
+                    return c.face == t.face;
+                });
+                if (it == candidates.end()) {
+                    candidates.push_back(Candidate{t.face, DBL_MAX, gp_Pnt2d()});
+                    it = candidates.end() - 1;
+                }
+                if (dist2 < it->dist2) {
+                    it->dist2 = dist2;
+                    it->uv.SetX(bc[0] * t.uv[0].X() + bc[1] * t.uv[1].X() + bc[2] * t.uv[2].X());
+                    it->uv.SetY(bc[0] * t.uv[0].Y() + bc[1] * t.uv[1].Y() + bc[2] * t.uv[2].Y());
+                }
+            }
+        }
+    }
+
+    /* Projects the point onto the surface of the face. Returns false if the
+     * projection lies outside the face boundaries. */
+    bool project(const Base::Vector3d& p, const Candidate& cand, Context& ctx,
+                 Base::Vector3d& foot, Base::Vector3d& normal) const
+    {
+        const FaceData& data = faces[cand.face];
+        Handle(ShapeAnalysis_Surface)& surf = ctx.surfaces[cand.face];
+        if (surf.IsNull())
+            surf = new ShapeAnalysis_Surface(data.surface);
+        std::unique_ptr<BRepTopAdaptor_FClass2d>& classifier = ctx.classifiers[cand.face];
+        if (!classifier)
+            classifier.reset(new BRepTopAdaptor_FClass2d(data.face, Precision::Confusion()));
+
+        // The distance may be computed in a worker thread, so no OCC exception
+        // must leave this function.
+        try {
+            gp_Pnt pnt(p.x, p.y, p.z);
+            gp_Pnt2d uv = data.hasUV
+                ? surf->NextValueOfUV(cand.uv, pnt, Precision::Confusion())
+                : surf->ValueOfUV(pnt, Precision::Confusion());
+
+            TopAbs_State state = classifier->Perform(uv);
+            if (state != TopAbs_IN && state != TopAbs_ON)
+                return false;
+
+            gp_Pnt value = data.surface->Value(uv.X(), uv.Y());
+            foot.Set(value.X(), value.Y(), value.Z());
+
+            gp_Dir dir;
+            Standard_Boolean done;
+            Part::Tools::getNormal(data.surface, uv.X(), uv.Y(), Precision::Confusion(), dir, done);
+            if (done) {
+                if (data.face.Orientation() == TopAbs_REVERSED)
+                    dir.Reverse();
+                normal.Set(dir.X(), dir.Y(), dir.Z());
+            }
+        }
+        catch (const Standard_Failure&) {
+            return false;
+        }
+        return true;
+    }
+
+    /* Counts the crossings of a ray with the tessellation. Returns false if the ray
+     * hits an edge or vertex of the tessellation. */
+    bool crossings(const Base::Vector3d& p, const Base::Vector3d& dir, Context& ctx, int& count) const
+    {
+        Base::Vector3d invdir(1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z);
+        std::vector<std::size_t>& stack = ctx.stack;
+        stack.clear();
+        stack.push_back(0);
+        count = 0;
+        while (!stack.empty()) {
+            std::size_t index = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[index];
+            if (!intersect(p, invdir, node.box))
+                continue;
+
+            if (node.count == 0) {
+                stack.push_back(index + 1);
+                stack.push_back(node.right);
+                continue;
+            }
+
+            for (std::size_t i = node.first; i < node.first + node.count; i++) {
+                RayHit hit = intersect(p, dir, triangles[i]);
+                if (hit == RayHit::Ambiguous)
+                    return false;
+                if (hit == RayHit::Crossing)
+                    count++;
+            }
+        }
+
+        return true;
+    }
+
+    bool isInside(const Base::Vector3d& p, Context& ctx) const
+    {
+        // directions that are unlikely to be parallel to the faces of a CAD part
+        static const Base::Vector3d dirs[] = {
+            Base::Vector3d(0.5773, 0.5774, 0.5775),
+            Base::Vector3d(-0.2673, 0.5346, 0.8018),
+            Base::Vector3d(0.7071, -0.1234, -0.6963)
+        };
+
+        int count = 0;
+        for (const auto& dir : dirs) {
+            if (crossings(p, dir, ctx, count))
+                return count % 2 == 1;
+        }
+
+        // every ray hit an edge or vertex of the tessellation, so use the exact shape
+        try {
+            if (!ctx.solidClassifier)
+                ctx.solidClassifier.reset(new BRepClass3d_SolidClassifier(exactShape));
+            ctx.solidClassifier->Perform(gp_Pnt(p.x, p.y, p.z), Precision::Confusion());
+            return ctx.solidClassifier->State() == TopAbs_IN;
+        }
+        catch (const Standard_Failure&) {
+            return false;
+        }
+    }
+
+    std::unique_ptr<Context> acquire() const
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!pool.empty()) {
+                std::unique_ptr<Context> ctx = std::move(pool.back());
+                pool.pop_back();
+                return ctx;
+            }
+        }
+
+        std::unique_ptr<Context> ctx(new Context);
+        ctx->surfaces.resize(faces.size());
+        ctx->classifiers.resize(faces.size());
+        return ctx;
+    }
+
+    void release(std::unique_ptr<Context> ctx) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pool.push_back(std::move(ctx));
+    }
+
+    double deflection;
+    bool solid;
+    TopoDS_Shape exactShape;
+    std::vector<FaceData> faces;
+    std::vector<Triangle> triangles;
+    std::vector<Node> nodes;
+
+    mutable std::mutex mutex;
+    mutable std::vector<std::unique_ptr<Context> > pool;
+};
+
+// ----------------------------------------------------------------
+
+ShapeDistance::ShapeDistance(const TopoDS_Shape& shape, double deflection)
+    : d(new Private(shape, deflection))
+{
+}
+
+ShapeDistance::~ShapeDistance()
+{
+}
+
+bool ShapeDistance::isSolid() const
+{
+    return d->solid;
+}
+
+double ShapeDistance::getDistance(const Base::Vector3d& point, double radius) const
+{
+    if (d->nodes.empty())
+        return FLT_MAX;
+
+    std::unique_ptr<Private::Context> ctx = d->acquire();
+
+    Private::Hit hit;
+    d->nearest(point, *ctx, hit);
+    double dist = std::sqrt(hit.dist2);
+    Base::Vector3d foot = hit.point;
+    const Triangle& tria = d->triangles[hit.triangle];
+    Base::Vector3d normal = (tria.p[1] - tria.p[0]) % (tria.p[2] - tria.p[0]);
+
+    if (dist - d->deflection <= radius) {
+        // The surface deviates at most by the deflection from the tessellation. So, the
+        // nearest surface point is near a triangle not farther than dist + 2 * deflection.
+        d->collect(point, dist + 2.0 * d->deflection, *ctx);
+        double best = DBL_MAX;
+        for (const auto& cand : ctx->candidates) {
+            Base::Vector3d pnt, nor = normal;
+            if (d->project(point, cand, *ctx, pnt, nor)) {
+                double len = Base::Distance(point, pnt);
+                if (len < best && len <= dist + 2.0 * d->deflection) {
+                    best = len;
+                    foot = pnt;
+                    normal = nor;
+                }
+            }
+        }
+
+        if (best < DBL_MAX)
+            dist = best;
+    }
+
+    bool negative = false;
+    if (d->solid)
+        negative = d->isInside(point, *ctx);
+    else
+        negative = normal * (point - foot) < 0.0;
+
+    d->release(std::move(ctx));
+    return negative ? -dist : dist;
+}
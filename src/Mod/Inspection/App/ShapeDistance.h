@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef INSPECTION_SHAPEDISTANCE_H
+#define INSPECTION_SHAPEDISTANCE_H
+
+#include <memory>
+
+#include <Base/Vector3D.h>
+#include <Mod/Inspection/InspectionGlobal.h>
+
+class TopoDS_Shape;
+
+namespace Inspection
+{
+
+/**
+ * The ShapeDistance class computes the signed distance of points to a shape.
+ *
+ * The shape is tessellated once and the triangles are kept in a bounding volume
+ * hierarchy to find the nearest triangle of a point. The distance is then refined
+ * on the exact surfaces of the faces near this triangle. For solids the sign is
+ * determined by a ray test against the tessellation, otherwise by the surface
+ * normal at the nearest point.
+ *
+ * getDistance() can be called from several threads at the same time. The OCC
+ * objects that cache data are kept in query contexts and each running query
+ * uses its own context.
+ */
+class InspectionExport ShapeDistance
+{
+public:
+    /** Tessellates \a shape with the given \a deflection. */
+    ShapeDistance(const TopoDS_Shape& shape, double deflection);
+    ~ShapeDistance();
+
+    /** Returns the signed distance of \a point to the shape. Points inside a solid
+     * or behind a face get a negative distance. If the approximate distance is
+     * larger than \a radius the refinement on the exact surfaces is skipped.
+     * Returns FLT_MAX if the shape has no faces.
+     */
+    double getDistance(const Base::Vector3d& point, double radius) const;
+    /** Returns true if the shape is a solid. */
+    bool isSolid() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+} // namespace Inspection
+
+
+#endif // INSPECTION_SHAPEDISTANCE_H
@@ -0,0 +1,435 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+#endif
+
+#include "Analysis.h"
+#include "Degeneration.h"
+#include "Evaluation.h"
+#include "Functional.h"
+#include "Grid.h"
+#include "MeshKernel.h"
+
+
+using namespace MeshCore;
+
+namespace MeshCore {
+namespace Analysis {
+
+struct EdgeItem
+{
+    PointIndex p0, p1;
+    FacetIndex f;
+    unsigned short side;
+    bool forward;
+
+    bool operator < (const EdgeItem& e) const
+    {
+        if (p0 != e.p0)
+            return p0 < e.p0;
+        if (p1 != e.p1)
+            return p1 < e.p1;
+        return f < e.f;
+    }
+};
+
+inline void sortFacet(const MeshFacet& face, PointIndex (&p)[3])
+{
+    p[0] = face._aulPoints[0];
+    p[1] = face._aulPoints[1];
+    p[2] = face._aulPoints[2];
+    if (p[0] > p[1])
+        std::swap(p[0], p[1]);
+    if (p[1] > p[2])
+        std::swap(p[1], p[2]);
+    if (p[0] > p[1])
+        std::swap(p[0], p[1]);
+}
+
+}
+}
+
+bool MeshReport::IsValid() const
+{
+    return facetsOutOfRange.empty() && corruptedFacets.empty() && !invalidNeighbourhood &&
+           invalidPoints.empty() && duplicatedPoints.empty() && duplicatedFacets.empty() &&
+           degeneratedFacets.empty() && nonManifoldEdges.empty() &&
+           nonUniformOrientedFacets.empty() && selfIntersections.empty();
+}
+
+// ----------------------------------------------------------------------
+
+MeshAnalysis::MeshAnalysis (const MeshKernel &rclM)
+  : _rclMesh(rclM)
+  , _checks(All)
+  , _epsilon(MeshDefinitions::_fMinPointDistanceP2)
+  , _threads(0)
+{
+}
+
+MeshAnalysis::~MeshAnalysis ()
+{
+}
+
+MeshReport MeshAnalysis::Evaluate() const
+{
+    MeshReport report;
+    if (!CheckIndices(report))
+        return report;
+
+    // The checks only read the mesh and write to different parts of the report.
+    // The facet flags are not used because they would be shared between the threads.
+    QFuture<void> points = QtConcurrent::run([this, &report]() { CheckPoints(report); });
+    QFuture<void> facets = QtConcurrent::run([this, &report]() { CheckFacets(report); });
+    QFuture<void> edges = QtConcurrent::run([this, &report]() { CheckEdges(report); });
+    CheckSelfIntersections(report);
+
+    points.waitForFinished();
+    facets.waitForFinished();
+    edges.waitForFinished();
+    return report;
+}
+
+bool MeshAnalysis::CheckIndices(MeshReport& report) const
+{
+    // an index out of range makes all further checks impossible
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    const PointIndex numPoints = _rclMesh.CountPoints();
+    const FacetIndex numFacets = _rclMesh.CountFacets();
+    for (FacetIndex index = 0; index < numFacets; index++) {
+        const MeshFacet& face = rFacets[index];
+        for (int i = 0; i < 3; i++) {
+            FacetIndex n = face._aulNeighbours[i];
+            if (face._aulPoints[i] >= numPoints || (n != FACET_INDEX_MAX && n >= numFacets)) {
+                report.facetsOutOfRange.push_back(index);
+                break;
+            }
+        }
+
+        if ((_checks & Indices) && face.IsDegenerated())
+            report.corruptedFacets.push_back(index);
+    }
+
+    return report.facetsOutOfRange.empty();
+}
+
+void MeshAnalysis::CheckPoints(MeshReport& report) const
+{
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    if (_checks & InvalidPoints) {
+        for (PointIndex index = 0; index < rPoints.size(); index++) {
+            const MeshPoint& p = rPoints[index];
+            if (std::isnan(p.x) || std::isnan(p.y) || std::isnan(p.z))
+                report.invalidPoints.push_back(index);
+        }
+    }
+
+    if (_checks & DuplicatedPoints) {
+        // use the same order as MeshEvalDuplicatePoints
+        std::vector<PointIndex> order(rPoints.size());
+        for (PointIndex index = 0; index < order.size(); index++)
+            order[index] = index;
+        std::sort(order.begin(), order.end(), [&rPoints](PointIndex a, PointIndex b) {
+            return rPoints[a] < rPoints[b];
+        });
+
+        for (std::size_t i = 1; i < order.size(); i++) {
+            const MeshPoint& p = rPoints[order[i-1]];
+            const MeshPoint& q = rPoints[order[i]];
+            if (!(p < q) && !(q < p))
+                report.duplicatedPoints.push_back(order[i]);
+        }
+        std::sort(report.duplicatedPoints.begin(), report.duplicatedPoints.end());
+    }
+}
+
+void MeshAnalysis::CheckFacets(MeshReport& report) const
+{
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+
+    if (_checks & DegeneratedFacets) {
+        for (FacetIndex index = 0; index < rFacets.size(); index++) {
+            if (_rclMesh.GetFacet(rFacets[index]).IsDegenerated(_epsilon))
+                report.degeneratedFacets.push_back(index);
+        }
+    }
+
+    if (_checks & DuplicatedFacets) {
+        std::vector<FacetIndex> order(rFacets.size());
+        for (FacetIndex index = 0; index < order.size(); index++)
+            order[index] = index;
+        std::sort(order.begin(), order.end(), [&rFacets](FacetIndex a, FacetIndex b) {
+            PointIndex pa[3], pb[3];
+            Analysis::sortFacet(rFacets[a], pa);
+            Analysis::sortFacet(rFacets[b], pb);
+            return std::lexicographical_compare(pa, pa + 3, pb, pb + 3) ||
+                  (std::equal(pa, pa + 3, pb) && a < b);
+        });
+
+        for (std::size_t i = 1; i < order.size(); i++) {
+            PointIndex pa[3], pb[3];
+            Analysis::sortFacet(rFacets[order[i-1]], pa);
+            Analysis::sortFacet(rFacets[order[i]], pb);
+            if (std::equal(pa, pa + 3, pb))
+                report.duplicatedFacets.push_back(order[i]);
+        }
+        std::sort(report.duplicatedFacets.begin(), report.duplicatedFacets.end());
+    }
+}
+
+void MeshAnalysis::CheckEdges(MeshReport& report) const
+{
+    if ((_checks & (Indices | Topology | Orientation)) == 0)
+        return;
+
+    // one sorted edge array is used for the neighbourhood, topology and orientation
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    std::vector<Analysis::EdgeItem> edges;
+    edges.reserve(3 * rFacets.size());
+    for (FacetIndex index = 0; index < rFacets.size(); index++) {
+        const MeshFacet& face = rFacets[index];
+        for (unsigned short i = 0; i < 3; i++) {
+            Analysis::EdgeItem item;
+            PointIndex p0 = face._aulPoints[i];
+            PointIndex p1 = face._aulPoints[(i+1)%3];
+            item.p0 = std::min<PointIndex>(p0, p1);
+            item.p1 = std::max<PointIndex>(p0, p1);
+            item.f = index;
+            item.side = i;
+            item.forward = p0 < p1;
+            edges.push_back(item);
+        }
+    }
+
+    parallel_sort(edges.begin(), edges.end(), std::less<Analysis::EdgeItem>(),
+                  std::max(1, _threads < 1 ? QThread::idealThreadCount() : _threads));
+
+    std::vector<FacetIndex> orientation;
+    std::size_t first = 0;
+    while (first < edges.size()) {
+        std::size_t last = first + 1;
+        while (last < edges.size() && edges[last].p0 == edges[first].p0 && edges[last].p1 == edges[first].p1)
+            last++;
+
+        const Analysis::EdgeItem& e0 = edges[first];
+        std::size_t count = last - first;
+        if (count == 1) {
+            report.openEdges++;
+            if (rFacets[e0.f]._aulNeighbours[e0.side] != FACET_INDEX_MAX)
+                report.invalidNeighbourhood = true;
+        }
+        else if (count == 2) {
+            const Analysis::EdgeItem& e1 = edges[first + 1];
+            if (rFacets[e0.f]._aulNeighbours[e0.side] != e1.f ||
+                rFacets[e1.f]._aulNeighbours[e1.side] != e0.f)
+                report.invalidNeighbourhood = true;
+            // two correctly oriented facets pass the edge in opposite directions
+            if (e0.forward == e1.forward) {
+                orientation.push_back(e0.f);
+                orientation.push_back(e1.f);
+            }
+        }
+        else {
+            report.nonManifoldEdges.emplace_back(e0.p0, e0.p1);
+            std::vector<FacetIndex> facets;
+            for (std::size_t i = first; i < last; i++)
+                facets.push_back(edges[i].f);
+            report.nonManifoldFacets.push_back(facets);
+        }
+
+        first = last;
+    }
+
+    if (!(_checks & Indices))
+        report.invalidNeighbourhood = false;
+    if (!(_checks & Topology)) {
+        report.nonManifoldEdges.clear();
+        report.nonManifoldFacets.clear();
+    }
+    if (_checks & Orientation) {
+        std::sort(orientation.begin(), orientation.end());
+        orientation.erase(std::unique(orientation.begin(), orientation.end()), orientation.end());
+        report.nonUniformOrientedFacets.swap(orientation);
+    }
+}
+
+void MeshAnalysis::CheckSelfIntersections(MeshReport& report) const
+{
+    if (!(_checks & SelfIntersections))
+        return;
+
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    const FacetIndex numFacets = rFacets.size();
+    MeshFacetGrid grid(_rclMesh);
+
+    // each thread only writes the intersections of its own facets
+    std::vector<std::vector<FacetIndex> > intersections(numFacets);
+    parallel_for<FacetIndex>(0, numFacets, [&](FacetIndex begin, FacetIndex end) {
+        std::vector<FacetIndex> candidates;
+        Base::Vector3f pt1, pt2;
+        for (FacetIndex i = begin; i < end; i++) {
+            const MeshFacet& rface1 = rFacets[i];
+            MeshGeomFacet facet1 = _rclMesh.GetFacet(rface1);
+            Base::BoundBox3f box1 = facet1.GetBoundBox();
+            grid.Inside(box1, candidates);
+            for (FacetIndex j : candidates) {
+                if (j <= i)
+                    continue;
+                // facets sharing a common point are ignored, see MeshEvalSelfIntersection
+                const MeshFacet& rface2 = rFacets[j];
+                bool common = false;
+                for (int k = 0; k < 3 && !common; k++) {
+                    common = rface1._aulPoints[k] == rface2._aulPoints[0] ||
+                             rface1._aulPoints[k] == rface2._aulPoints[1] ||
+                             rface1._aulPoints[k] == rface2._aulPoints[2];
+                }
+                if (common)
+                    continue;
+
+                MeshGeomFacet facet2 = _rclMesh.GetFacet(rface2);
+                if (!(box1 && facet2.GetBoundBox()))
+                    continue;
+                if (facet1.IntersectWithFacet(facet2, pt1, pt2) == 2)
+                    intersections[i].push_back(j);
+            }
+        }
+    }, _threads);
+
+    for (FacetIndex i = 0; i < numFacets; i++) {
+        for (FacetIndex j : intersections[i])
+            report.selfIntersections.emplace_back(i, j);
+    }
+}
+
+// ----------------------------------------------------------------------
+
+MeshRepair::MeshRepair (MeshKernel &rclM)
+  : _rclMesh(rclM)
+  , _checks(MeshAnalysis::All)
+  , _epsilon(MeshDefinitions::_fMinPointDistanceP2)
+{
+}
+
+MeshRepair::~MeshRepair ()
+{
+}
+
+MeshReport MeshRepair::Fixup()
+{
+    MeshAnalysis analysis(_rclMesh);
+    analysis.SetChecks(_checks);
+    analysis.SetEpsilon(_epsilon);
+    MeshReport report = analysis.Evaluate();
+
+    // The indices of a previous analysis become invalid once the mesh is modified
+    // so that the defects must be searched for again
+    bool modified = false;
+
+    if (!report.facetsOutOfRange.empty() || !report.corruptedFacets.empty() || report.invalidNeighbourhood) {
+        MeshFixNeighbourhood fixNeighbours(_rclMesh);
+        fixNeighbours.Fixup();
+        MeshFixRangeFacet fixFacets(_rclMesh);
+        fixFacets.Fixup();
+        MeshFixRangePoint fixPoints(_rclMesh);
+        fixPoints.Fixup();
+        MeshFixCorruptedFacets fixCorrupted(_rclMesh);
+        fixCorrupted.Fixup();
+        modified = true;
+
+        // with valid indices the remaining checks can be done now
+        if (!report.facetsOutOfRange.empty()) {
+            MeshReport indexReport = report;
+            report = analysis.Evaluate();
+            report.facetsOutOfRange = indexReport.facetsOutOfRange;
+            report.corruptedFacets = indexReport.corruptedFacets;
+            report.invalidNeighbourhood = indexReport.invalidNeighbourhood;
+        }
+    }
+
+    if (!report.invalidPoints.empty()) {
+        MeshFixNaNPoints fix(_rclMesh);
+        fix.Fixup();
+        modified = true;
+    }
+
+    if (!report.duplicatedPoints.empty()) {
+        MeshFixDuplicatePoints fix(_rclMesh);
+        fix.Fixup();
+        modified = true;
+    }
+
+    if (!report.duplicatedFacets.empty()) {
+        MeshFixDuplicateFacets fix(_rclMesh);
+        fix.Fixup();
+        modified = true;
+    }
+
+    if (!report.degeneratedFacets.empty()) {
+        MeshFixDegeneratedFacets fix(_rclMesh, _epsilon);
+        fix.Fixup();
+        modified = true;
+    }
+
+    if (!report.nonManifoldEdges.empty()) {
+        if (modified) {
+            MeshEvalTopology eval(_rclMesh);
+            if (!eval.Evaluate()) {
+                MeshFixTopology fix(_rclMesh, eval.GetFacets());
+                fix.Fixup();
+            }
+        }
+        else {
+            MeshFixTopology fix(_rclMesh, report.nonManifoldFacets);
+            fix.Fixup();
+        }
+        modified = true;
+    }
+
+    if (!report.nonUniformOrientedFacets.empty()) {
+        MeshFixOrientation fix(_rclMesh);
+        fix.Fixup();
+    }
+
+    if (!report.selfIntersections.empty()) {
+        std::vector<std::pair<FacetIndex, FacetIndex> > selfIntersections;
+        if (modified) {
+            MeshEvalSelfIntersection eval(_rclMesh);
+            eval.GetIntersections(selfIntersections);
+        }
+        else {
+            selfIntersections = report.selfIntersections;
+        }
+
+        if (!selfIntersections.empty()) {
+            MeshFixSelfIntersection fix(_rclMesh, selfIntersections);
+            fix.Fixup();
+        }
+    }
+
+    return report;
+}
@@ -0,0 +1,150 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_ANALYSIS_H
+#define MESH_ANALYSIS_H
+
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "Definitions.h"
+
+namespace MeshCore {
+
+class MeshKernel;
+
+/**
+ * The MeshReport structure keeps the defects found by MeshAnalysis.
+ */
+struct MeshExport MeshReport
+{
+    /// facets with point or neighbour indices out of range
+    std::vector<FacetIndex> facetsOutOfRange;
+    /// facets that reference a point more than once
+    std::vector<FacetIndex> corruptedFacets;
+    /// true if the neighbour indices don't match the topology
+    bool invalidNeighbourhood = false;
+    /// points with a NaN coordinate
+    std::vector<PointIndex> invalidPoints;
+    /// points with the same coordinates as another point, the first one is not listed
+    std::vector<PointIndex> duplicatedPoints;
+    /// facets with the same points as another facet, the first one is not listed
+    std::vector<FacetIndex> duplicatedFacets;
+    /// facets with (almost) zero area
+    std::vector<FacetIndex> degeneratedFacets;
+    /// edges shared by more than two facets
+    std::vector<std::pair<PointIndex, PointIndex> > nonManifoldEdges;
+    /// the facets of each non-manifold edge
+    std::list<std::vector<FacetIndex> > nonManifoldFacets;
+    /// facets with a neighbour of opposite orientation
+    std::vector<FacetIndex> nonUniformOrientedFacets;
+    /// pairs of intersecting facets
+    std::vector<std::pair<FacetIndex, FacetIndex> > selfIntersections;
+    /// number of edges with only one facet
+    std::size_t openEdges = 0;
+
+    /// Returns true if no defect was found.
+    bool IsValid() const;
+};
+
+/**
+ * The MeshAnalysis class runs several evaluations of a mesh in one pass.
+ * In contrast to the single MeshEvaluation classes the point order, the sorted edge
+ * array and the facet grid are only built once and the independent checks run
+ * concurrently.
+ * If a facet references a point or neighbour out of range only the index checks
+ * are done.
+ */
+class MeshExport MeshAnalysis
+{
+public:
+    enum Check {
+        Indices           = 0x01,
+        InvalidPoints     = 0x02,
+        DuplicatedPoints  = 0x04,
+        DuplicatedFacets  = 0x08,
+        DegeneratedFacets = 0x10,
+        Topology          = 0x20,
+        Orientation       = 0x40,
+        SelfIntersections = 0x80,
+        All               = 0xff
+    };
+
+    MeshAnalysis (const MeshKernel &rclM);
+    ~MeshAnalysis ();
+
+    /// Sets the checks as combination of Check values, the default is All.
+    void SetChecks(int checks)
+    { _checks = checks; }
+    /// Sets the epsilon used to detect degenerated facets.
+    void SetEpsilon(float eps)
+    { _epsilon = eps; }
+    /// Sets the number of threads, a value < 1 uses all available cores.
+    void SetThreads(int threads)
+    { _threads = threads; }
+    /// Runs the checks and returns the found defects.
+    MeshReport Evaluate() const;
+
+private:
+    bool CheckIndices(MeshReport&) const;
+    void CheckPoints(MeshReport&) const;
+    void CheckFacets(MeshReport&) const;
+    void CheckEdges(MeshReport&) const;
+    void CheckSelfIntersections(MeshReport&) const;
+
+private:
+    const MeshKernel& _rclMesh;
+    int _checks;
+    float _epsilon;
+    int _threads;
+};
+
+/**
+ * The MeshRepair class runs a MeshAnalysis and fixes the found defects in a
+ * sensible order. Only the fixes of failed checks are applied.
+ */
+class MeshExport MeshRepair
+{
+public:
+    MeshRepair (MeshKernel &rclM);
+    ~MeshRepair ();
+
+    /// Sets the checks as combination of MeshAnalysis::Check values.
+    void SetChecks(int checks)
+    { _checks = checks; }
+    /// Sets the epsilon used to detect degenerated facets.
+    void SetEpsilon(float eps)
+    { _epsilon = eps; }
+    /// Repairs the mesh and returns the defects found before.
+    MeshReport Fixup();
+
+private:
+    MeshKernel& _rclMesh;
+    int _checks;
+    float _epsilon;
+};
+
+} // namespace MeshCore
+
+#endif // MESH_ANALYSIS_H
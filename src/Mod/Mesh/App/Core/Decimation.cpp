@@ -23,13 +23,24 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <cmath>
+# include <cstdint>
+# include <queue>
+# include <vector>
 #endif
 
 #include "Decimation.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
+#include "Functional.h"
+#include "HalfEdge.h"
 #include "Iterator.h"
 #include "TopoAlgorithm.h"
+#include <Base/Converter.h>
+#include <Base/Exception.h>
+#include <Base/Sequencer.h>
 #include <Base/Tools.h>
 #include "Simplify.h"
 
@@ -158,3 +169,490 @@ void MeshSimplify::simplify(int targetSize)
 
     myKernel.Adopt(new_points, new_facets, true);
 }
+
+// ----------------------------------------------------------------------------
+
+namespace MeshCore {
+namespace Decimation {
+
+// Penalty weight of the planes that keep boundary and feature edges in place
+const double ConstraintWeight = 1000.0;
+
+enum VertexClass : unsigned char {
+    Free = 0,       // can be moved and removed
+    Constrained = 1,// lies on a boundary or feature line
+    Fixed = 2       // can neither be moved nor removed
+};
+
+struct Collapse
+{
+    float cost;
+    HalfEdgeIndex edge;
+    std::uint32_t stamp0;
+    std::uint32_t stamp1;
+
+    bool operator > (const Collapse& c) const
+    {
+        return cost > c.cost;
+    }
+};
+
+inline double quadricError(const SymmetricMatrix& q, const Base::Vector3d& p)
+{
+    return   q[0]*p.x*p.x + 2*q[1]*p.x*p.y + 2*q[2]*p.x*p.z + 2*q[3]*p.x + q[4]*p.y*p.y
+         + 2*q[5]*p.y*p.z + 2*q[6]*p.y + q[7]*p.z*p.z + 2*q[8]*p.z + q[9];
+}
+
+inline SymmetricMatrix planeQuadric(const Base::Vector3d& n, const Base::Vector3d& p, double weight)
+{
+    SymmetricMatrix q(n.x, n.y, n.z, -(n * p));
+    for (double& it : q.m)
+        it *= weight;
+    return q;
+}
+
+class QuadricDecimation
+{
+public:
+    QuadricDecimation(int threads, double maxError, float featureAngle, bool preserveBoundary)
+      : threads(threads)
+      , maxError(maxError)
+      , featureAngle(featureAngle)
+      , preserveBoundary(preserveBoundary)
+    {
+    }
+
+    void setup(const MeshKernel& kernel);
+    void decimate(std::size_t targetSize);
+    void flush(MeshKernel& kernel) const;
+
+private:
+    void classifyVertices(const std::vector<std::uint32_t>& offsets,
+                          const std::vector<FacetIndex>& vertexFacets);
+    void computeQuadrics(const std::vector<std::uint32_t>& offsets,
+                         const std::vector<FacetIndex>& vertexFacets);
+    bool isConstraint(HalfEdgeIndex h) const
+    {
+        return mesh.IsBoundary(h) || feature[h] != 0;
+    }
+    bool evaluate(HalfEdgeIndex h, float& cost, Base::Vector3f& pos, bool& keepOrigin) const;
+    bool canCollapse(HalfEdgeIndex h, bool keepOrigin, const Base::Vector3f& pos);
+    bool isFlipped(PointIndex v, PointIndex other, const Base::Vector3f& pos,
+                   const std::vector<FacetIndex>& facets) const;
+    PointIndex collapse(HalfEdgeIndex h, bool keepOrigin, const Base::Vector3f& pos);
+    void mergeFeature(HalfEdgeIndex a, HalfEdgeIndex b);
+    void pushEdges(PointIndex v);
+
+private:
+    int threads;
+    double maxError;
+    float featureAngle;
+    bool preserveBoundary;
+
+    MeshHalfEdgeKernel mesh;
+    std::vector<unsigned char> feature;
+    std::vector<SymmetricMatrix> quadrics;
+    std::vector<std::uint32_t> stamps;
+    std::vector<unsigned char> classes;
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse> > queue;
+
+    // buffers to avoid re-allocations for each collapse
+    std::vector<FacetIndex> facets0, facets1;
+    std::vector<PointIndex> ring0, ring1;
+};
+
+void QuadricDecimation::setup(const MeshKernel& kernel)
+{
+    mesh.Build(kernel, threads);
+
+    const MeshFacetArray& facets = kernel.GetFacets();
+    const std::size_t numPoints = mesh.CountPoints();
+
+    // vertex to facet references in compressed row storage
+    std::vector<std::uint32_t> offsets(numPoints + 1, 0);
+    for (const auto& it : facets) {
+        for (PointIndex v : it._aulPoints)
+            offsets[v + 1]++;
+    }
+    for (std::size_t i = 0; i < numPoints; i++)
+        offsets[i + 1] += offsets[i];
+    std::vector<FacetIndex> vertexFacets(3 * facets.size());
+    {
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < facets.size(); i++) {
+            for (PointIndex v : facets[i]._aulPoints)
+                vertexFacets[fill[v]++] = i;
+        }
+    }
+
+    classifyVertices(offsets, vertexFacets);
+    computeQuadrics(offsets, vertexFacets);
+}
+
+void QuadricDecimation::classifyVertices(const std::vector<std::uint32_t>& offsets,
+                                         const std::vector<FacetIndex>& vertexFacets)
+{
+    const std::size_t numPoints = mesh.CountPoints();
+    const std::size_t numHalfEdges = mesh.CountHalfEdges();
+
+    // mark feature edges
+    feature.assign(numHalfEdges, 0);
+    if (featureAngle > 0.0f) {
+        const float cosAngle = std::cos(featureAngle);
+        parallel_for<std::size_t>(0, numHalfEdges, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t h = begin; h < end; h++) {
+                HalfEdgeIndex opp = mesh.Opposite(static_cast<HalfEdgeIndex>(h));
+                if (opp == HALFEDGE_INDEX_MAX)
+                    continue;
+                Base::Vector3f n0 = mesh.GetNormal(h / 3);
+                Base::Vector3f n1 = mesh.GetNormal(opp / 3);
+                float len = n0.Length() * n1.Length();
+                if (len > 0.0f && (n0 * n1) < cosAngle * len)
+                    feature[h] = 1;
+            }
+        }, threads);
+    }
+
+    classes.assign(numPoints, Free);
+    stamps.assign(numPoints, 0);
+    parallel_for<std::size_t>(0, numPoints, [&](std::size_t begin, std::size_t end) {
+        std::vector<FacetIndex> facets;
+        std::vector<PointIndex> neighbours;
+        for (std::size_t v = begin; v < end; v++) {
+            if (offsets[v + 1] == offsets[v] || !mesh.IsManifoldPoint(v)) {
+                classes[v] = Fixed;
+                continue;
+            }
+
+            int constraints = 0;
+            for (std::uint32_t i = offsets[v]; i < offsets[v + 1]; i++) {
+                HalfEdgeIndex f = static_cast<HalfEdgeIndex>(vertexFacets[i]);
+                for (HalfEdgeIndex k = 3*f; k < 3*f+3; k++) {
+                    if (mesh.Origin(k) != v)
+                        continue;
+                    if (isConstraint(k))
+                        constraints++;
+                    if (mesh.IsBoundary(MeshHalfEdgeKernel::Prev(k)))
+                        constraints++;
+                }
+            }
+
+            bool border = mesh.GetRing(v, facets, neighbours);
+            if (border && preserveBoundary)
+                classes[v] = Fixed;
+            else if (constraints == 0)
+                classes[v] = Free;
+            else if (constraints == 2)
+                classes[v] = Constrained;
+            else
+                classes[v] = Fixed;
+        }
+    }, threads);
+}
+
+void QuadricDecimation::computeQuadrics(const std::vector<std::uint32_t>& offsets,
+                                        const std::vector<FacetIndex>& vertexFacets)
+{
+    const std::size_t numPoints = mesh.CountPoints();
+    quadrics.assign(numPoints, SymmetricMatrix(0.0));
+
+    // each thread only writes the quadrics of its own vertices
+    parallel_for<std::size_t>(0, numPoints, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t v = begin; v < end; v++) {
+            SymmetricMatrix& q = quadrics[v];
+            for (std::uint32_t i = offsets[v]; i < offsets[v + 1]; i++) {
+                HalfEdgeIndex f = static_cast<HalfEdgeIndex>(vertexFacets[i]);
+                Base::Vector3d p0 = Base::convertTo<Base::Vector3d>(mesh.GetPoint(mesh.Origin(3*f)));
+                Base::Vector3d p1 = Base::convertTo<Base::Vector3d>(mesh.GetPoint(mesh.Origin(3*f+1)));
+                Base::Vector3d p2 = Base::convertTo<Base::Vector3d>(mesh.GetPoint(mesh.Origin(3*f+2)));
+                Base::Vector3d n = (p1 - p0) % (p2 - p0);
+                if (n.Sqr() == 0.0)
+                    continue;
+                n.Normalize();
+                q += planeQuadric(n, p0, 1.0);
+
+                // planes perpendicular to the facet through its constrained edges
+                for (HalfEdgeIndex k = 3*f; k < 3*f+3; k++) {
+                    if (mesh.Origin(k) != v && mesh.Target(k) != v)
+                        continue;
+                    if (!isConstraint(k))
+                        continue;
+                    Base::Vector3d e0 = Base::convertTo<Base::Vector3d>(mesh.GetPoint(mesh.Origin(k)));
+                    Base::Vector3d e1 = Base::convertTo<Base::Vector3d>(mesh.GetPoint(mesh.Target(k)));
+                    Base::Vector3d m = (e1 - e0) % n;
+                    if (m.Sqr() == 0.0)
+                        continue;
+                    m.Normalize();
+                    q += planeQuadric(m, e0, ConstraintWeight);
+                }
+            }
+        }
+    }, threads);
+
+    // initial collapse costs, only one half-edge per edge is taken
+    const std::size_t numHalfEdges = mesh.CountHalfEdges();
+    std::vector<Collapse> candidates(numHalfEdges);
+    parallel_for<std::size_t>(0, numHalfEdges, [&](std::size_t begin, std::size_t end) {
+        Base::Vector3f pos;
+        bool keepOrigin;
+        for (std::size_t h = begin; h < end; h++) {
+            Collapse& c = candidates[h];
+            c.edge = static_cast<HalfEdgeIndex>(h);
+            c.stamp0 = c.stamp1 = 0;
+            HalfEdgeIndex opp = mesh.Opposite(c.edge);
+            if ((opp != HALFEDGE_INDEX_MAX && opp < h) || !evaluate(c.edge, c.cost, pos, keepOrigin))
+                c.edge = HALFEDGE_INDEX_MAX;
+        }
+    }, threads);
+
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](const Collapse& c) {
+        return c.edge == HALFEDGE_INDEX_MAX;
+    }), candidates.end());
+    queue = std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse> >
+        (std::greater<Collapse>(), std::move(candidates));
+}
+
+bool QuadricDecimation::evaluate(HalfEdgeIndex h, float& cost, Base::Vector3f& pos, bool& keepOrigin) const
+{
+    PointIndex v0 = mesh.Origin(h);
+    PointIndex v1 = mesh.Target(h);
+    unsigned char c0 = classes[v0];
+    unsigned char c1 = classes[v1];
+    if (c0 == Fixed && c1 == Fixed)
+        return false;
+    // two vertices on a boundary or feature line may only be merged along this line
+    if (c0 == Constrained && c1 == Constrained && !isConstraint(h))
+        return false;
+
+    SymmetricMatrix q = quadrics[v0] + quadrics[v1];
+    Base::Vector3d p;
+    if (c0 != c1) {
+        keepOrigin = c0 > c1;
+        pos = keepOrigin ? mesh.GetPoint(v0) : mesh.GetPoint(v1);
+        p = Base::convertTo<Base::Vector3d>(pos);
+    }
+    else {
+        keepOrigin = false;
+        double det = q.det(0, 1, 2, 1, 4, 5, 2, 5, 7);
+        Base::Vector3d p0 = Base::convertTo<Base::Vector3d>(mesh.GetPoint(v0));
+        Base::Vector3d p1 = Base::convertTo<Base::Vector3d>(mesh.GetPoint(v1));
+        double scale = q[0] * q[4] * q[7];
+        if (std::fabs(det) > 1e-12 * std::fabs(scale) && det != 0.0) {
+            p.x = -1/det*(q.det(1, 2, 3, 4, 5, 6, 5, 7, 8));
+            p.y =  1/det*(q.det(0, 2, 3, 1, 5, 6, 2, 7, 8));
+            p.z = -1/det*(q.det(0, 1, 3, 1, 4, 6, 2, 5, 8));
+            // reject solutions far away from the edge
+            double len = Base::Distance(p0, p1);
+            if (Base::Distance(p, (p0 + p1) / 2) > 2 * len)
+                det = 0;
+        }
+        if (det == 0.0 || std::fabs(det) <= 1e-12 * std::fabs(scale)) {
+            Base::Vector3d pm = (p0 + p1) / 2;
+            double e0 = quadricError(q, p0);
+            double e1 = quadricError(q, p1);
+            double em = quadricError(q, pm);
+            p = pm;
+            if (e0 < em && e0 <= e1)
+                p = p0;
+            else if (e1 < em)
+                p = p1;
+        }
+        pos = Base::convertTo<Base::Vector3f>(p);
+    }
+
+    cost = static_cast<float>(std::max(0.0, quadricError(q, p)));
+    return true;
+}
+
+bool QuadricDecimation::isFlipped(PointIndex v, PointIndex other, const Base::Vector3f& pos,
+                                  const std::vector<FacetIndex>& facets) const
+{
+    for (FacetIndex f : facets) {
+        Base::Vector3f p[3];
+        bool shared = false;
+        for (int k = 0; k < 3; k++) {
+            PointIndex c = mesh.Origin(static_cast<HalfEdgeIndex>(3*f+k));
+            if (c == other)
+                shared = true;
+            p[k] = (c == v) ? pos : mesh.GetPoint(c);
+        }
+        // facets at the collapsed edge are removed
+        if (shared)
+            continue;
+
+        Base::Vector3f n0 = mesh.GetNormal(f);
+        Base::Vector3f n1 = (p[1] - p[0]) % (p[2] - p[0]);
+        float l0 = n0.Length();
+        float l1 = n1.Length();
+        if (l1 <= FLT_EPSILON * l0)
+            return true;
+        if (n0 * n1 < 0.2f * l0 * l1)
+            return true;
+    }
+
+    return false;
+}
+
+bool QuadricDecimation::canCollapse(HalfEdgeIndex h, bool keepOrigin, const Base::Vector3f& pos)
+{
+    if (!mesh.IsCollapseEdgeLegal(h))
+        return false;
+
+    // none of the remaining facets may flip or degenerate
+    PointIndex v0 = mesh.Origin(h);
+    PointIndex v1 = mesh.Target(h);
+    mesh.GetRing(v0, facets0, ring0);
+    mesh.GetRing(v1, facets1, ring1);
+    if (keepOrigin)
+        return !isFlipped(v0, v1, pos, facets0) && !isFlipped(v1, v0, pos, facets1);
+    else
+        return !isFlipped(v1, v0, pos, facets1) && !isFlipped(v0, v1, pos, facets0);
+}
+
+void QuadricDecimation::mergeFeature(HalfEdgeIndex a, HalfEdgeIndex b)
+{
+    unsigned char flag = 0;
+    if (a != HALFEDGE_INDEX_MAX)
+        flag |= feature[a];
+    if (b != HALFEDGE_INDEX_MAX)
+        flag |= feature[b];
+    if (a != HALFEDGE_INDEX_MAX)
+        feature[a] = flag;
+    if (b != HALFEDGE_INDEX_MAX)
+        feature[b] = flag;
+}
+
+PointIndex QuadricDecimation::collapse(HalfEdgeIndex h, bool keepOrigin, const Base::Vector3f& pos)
+{
+    // the outer edges of the removed facets are glued together and keep their feature flag
+    mergeFeature(mesh.Opposite(MeshHalfEdgeKernel::Next(h)), mesh.Opposite(MeshHalfEdgeKernel::Prev(h)));
+    HalfEdgeIndex opp = mesh.Opposite(h);
+    if (opp != HALFEDGE_INDEX_MAX)
+        mergeFeature(mesh.Opposite(MeshHalfEdgeKernel::Next(opp)), mesh.Opposite(MeshHalfEdgeKernel::Prev(opp)));
+
+    PointIndex v0 = mesh.Origin(h);
+    PointIndex v1 = mesh.Target(h);
+    PointIndex keep = mesh.CollapseEdge(h, keepOrigin);
+    PointIndex remove = keep == v0 ? v1 : v0;
+
+    mesh.SetPoint(keep, pos);
+    quadrics[keep] += quadrics[remove];
+    classes[keep] = std::max(classes[keep], classes[remove]);
+    stamps[keep]++;
+    stamps[remove]++;
+    return keep;
+}
+
+void QuadricDecimation::pushEdges(PointIndex v)
+{
+    mesh.GetRing(v, facets0, ring0);
+    Collapse c;
+    Base::Vector3f pos;
+    bool keepOrigin;
+    for (FacetIndex f : facets0) {
+        for (HalfEdgeIndex k = static_cast<HalfEdgeIndex>(3*f); k < 3*f+3; k++) {
+            if (mesh.Origin(k) != v && mesh.Target(k) != v)
+                continue;
+            HalfEdgeIndex opp = mesh.Opposite(k);
+            if (opp != HALFEDGE_INDEX_MAX && opp < k)
+                continue;
+            if (!evaluate(k, c.cost, pos, keepOrigin))
+                continue;
+            c.edge = k;
+            c.stamp0 = stamps[mesh.Origin(k)];
+            c.stamp1 = stamps[mesh.Target(k)];
+            queue.push(c);
+        }
+    }
+}
+
+void QuadricDecimation::decimate(std::size_t targetSize)
+{
+    if (mesh.CountFacets() <= targetSize)
+        return;
+
+    Base::SequencerLauncher seq("Decimate mesh...", (mesh.CountFacets() - targetSize) / 2);
+    Base::Vector3f pos;
+    bool keepOrigin;
+    float cost;
+    while (mesh.CountFacets() > targetSize && !queue.empty()) {
+        Collapse c = queue.top();
+        queue.pop();
+        if (c.cost > maxError)
+            break;
+
+        // skip outdated candidates
+        HalfEdgeIndex h = c.edge;
+        if (!mesh.IsValid(h))
+            continue;
+        if (stamps[mesh.Origin(h)] != c.stamp0 || stamps[mesh.Target(h)] != c.stamp1)
+            continue;
+
+        if (!evaluate(h, cost, pos, keepOrigin))
+            continue;
+        if (!canCollapse(h, keepOrigin, pos))
+            continue;
+
+        PointIndex keep = collapse(h, keepOrigin, pos);
+        pushEdges(keep);
+        seq.next(true);
+    }
+}
+
+void QuadricDecimation::flush(MeshKernel& kernel) const
+{
+    mesh.Flush(kernel);
+}
+
+} // namespace Decimation
+} // namespace MeshCore
+
+MeshDecimation::MeshDecimation(MeshKernel& mesh)
+  : myKernel(mesh)
+  , threads(0)
+  , maxError(DBL_MAX)
+  , featureAngle(0.0f)
+  , preserveBoundary(false)
+  , memoryBudget(0)
+{
+}
+
+MeshDecimation::~MeshDecimation()
+{
+}
+
+std::size_t MeshDecimation::EstimateMemory(std::size_t numPoints, std::size_t numFacets)
+{
+    // point, quadric, outgoing half-edge, stamp, point flag, class and vertex-facet offset
+    std::size_t perPoint = sizeof(Base::Vector3f) + sizeof(SymmetricMatrix) +
+                           3 * sizeof(std::uint32_t) + 2;
+    // corners, opposite half-edges, feature flags, vertex-facet references and candidates
+    std::size_t perFacet = 3 * (2 * sizeof(std::uint32_t) + 1) + 3 * sizeof(FacetIndex) +
+                           3 * sizeof(Decimation::Collapse);
+    // the resulting arrays
+    perPoint += sizeof(MeshPoint);
+    perFacet += sizeof(MeshFacet);
+    return numPoints * perPoint + numFacets * perFacet;
+}
+
+void MeshDecimation::Decimate(std::size_t targetSize)
+{
+    if (memoryBudget > 0) {
+        std::size_t bytes = EstimateMemory(myKernel.CountPoints(), myKernel.CountFacets());
+        if (bytes > memoryBudget)
+            throw Base::MemoryException();
+    }
+
+    Decimation::QuadricDecimation alg(threads, maxError, featureAngle, preserveBoundary);
+    alg.setup(myKernel);
+    alg.decimate(targetSize);
+
+    alg.flush(myKernel);
+}
+
+void MeshDecimation::Reduce(float reduction)
+{
+    reduction = std::max(0.0f, std::min(1.0f, reduction));
+    std::size_t targetSize = static_cast<std::size_t>(static_cast<float>(myKernel.CountFacets()) * (1.0f - reduction));
+    Decimate(targetSize);
+}
@@ -24,6 +24,7 @@
 #ifndef MESH_DECIMATION_H
 #define MESH_DECIMATION_H
 
+#include <cstddef>
 #include <Mod/Mesh/MeshGlobal.h>
 
 namespace MeshCore
@@ -42,6 +43,61 @@ private:
     MeshKernel& myKernel;
 };
 
+/**
+ * The MeshDecimation class reduces the number of facets of a mesh by collapsing edges
+ * in the order of their quadric error (Garland/Heckbert).
+ * In contrast to MeshSimplify all collapse candidates are kept in a priority queue and
+ * after a collapse only the edges around the remaining vertex are re-evaluated. The
+ * topology is held in a compact half-edge structure and the set-up of the quadrics and
+ * initial edge costs is done in parallel.
+ *
+ * Boundary edges and feature edges, i.e. edges whose dihedral angle exceeds the feature
+ * angle, are kept in place by penalty quadrics. Vertices where more than two such edges
+ * meet and non-manifold vertices are never moved.
+ */
+class MeshExport MeshDecimation
+{
+public:
+    MeshDecimation(MeshKernel&);
+    ~MeshDecimation();
+
+    /// Number of threads used for the set-up. A value < 1 uses all available cores.
+    void SetThreads(int num) { threads = num; }
+    /// Edges whose collapse would cause a higher quadric error are not collapsed.
+    void SetMaxError(double error) { maxError = error; }
+    /// If true boundary vertices are neither moved nor removed.
+    void SetPreserveBoundary(bool on) { preserveBoundary = on; }
+    /// Dihedral angle in radians above which an edge is a feature edge. 0 disables it.
+    void SetFeatureAngle(float angle) { featureAngle = angle; }
+    /// Maximum number of bytes the algorithm may allocate. 0 means no limit.
+    void SetMemoryBudget(std::size_t bytes) { memoryBudget = bytes; }
+
+    /**
+     * Returns the estimated number of bytes that are needed to decimate a mesh
+     * with \a numPoints points and \a numFacets facets.
+     */
+    static std::size_t EstimateMemory(std::size_t numPoints, std::size_t numFacets);
+    /**
+     * Collapses edges until the mesh has at most \a targetSize facets or until no edge
+     * is left whose error is below the maximum error.
+     * If the estimated memory exceeds the memory budget a Base::MemoryException is thrown
+     * before anything is allocated and the mesh is left unchanged.
+     */
+    void Decimate(std::size_t targetSize);
+    /**
+     * Reduces the number of facets by the fraction \a reduction in the range [0.0, 1.0].
+     */
+    void Reduce(float reduction);
+
+private:
+    MeshKernel& myKernel;
+    int threads;
+    double maxError;
+    float featureAngle;
+    bool preserveBoundary;
+    std::size_t memoryBudget;
+};
+
 } // namespace MeshCore
 
 
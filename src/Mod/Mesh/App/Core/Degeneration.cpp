@@ -32,6 +32,7 @@
 #include "Degeneration.h"
 #include "Definitions.h"
 #include "Iterator.h"
+#include "HalfEdge.h"
 #include "Helpers.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
@@ -488,22 +489,103 @@ std::vector<FacetIndex> MeshEvalDegeneratedFacets::GetIndices() const
     return aInds;
 }
 
-bool MeshFixDegeneratedFacets::Fixup()
+namespace MeshCore {
+
+/*
+ * Removes the degenerated facet \a f by collapsing its shortest edge if two corners
+ * coincide or by swapping its longest edge otherwise. If this is not possible the facet
+ * is removed. Returns true if the mesh was modified.
+ */
+static bool RemoveDegeneratedFacet(MeshHalfEdgeKernel& mesh, FacetIndex f)
 {
-    MeshTopoAlgorithm cTopAlg(_rclMesh);
+    HalfEdgeIndex base = static_cast<HalfEdgeIndex>(3 * f);
+
+    // coincident corners (either topological or geometrical)
+    for (HalfEdgeIndex h = base; h < base + 3; h++) {
+        PointIndex p0 = mesh.Origin(h);
+        PointIndex p1 = mesh.Target(h);
+        if (Base::DistanceP2(mesh.GetPoint(p0), mesh.GetPoint(p1)) < MeshDefinitions::_fMinPointDistanceP2) {
+            if (p0 != p1 && mesh.IsManifoldPoint(p0) && mesh.IsManifoldPoint(p1) &&
+                mesh.IsCollapseEdgeLegal(h))
+                mesh.CollapseEdge(h);
+            else
+                mesh.RemoveFacet(f);
+            return true;
+        }
+    }
+
+    // We have a facet of the form
+    // P0 +----+------+P2
+    //         P1
+    for (HalfEdgeIndex h = base; h < base + 3; h++) {
+        HalfEdgeIndex n = MeshHalfEdgeKernel::Next(h);
+        HalfEdgeIndex p = MeshHalfEdgeKernel::Prev(h);
+        const Base::Vector3f& rP = mesh.GetPoint(mesh.Origin(h));
+        Base::Vector3f cVec1 = mesh.GetPoint(mesh.Origin(n)) - rP;
+        Base::Vector3f cVec2 = mesh.GetPoint(mesh.Origin(p)) - rP;
+
+        // swap the edge opposite to the obtuse corner
+        if (cVec1 * cVec2 < 0.0f) {
+            if (mesh.IsBoundary(n)) {
+                mesh.RemoveFacet(f);
+                return true;
+            }
+            if (mesh.IsSwapEdgeLegal(n)) {
+                mesh.SwapEdge(n);
+                return true;
+            }
+            return false;
+        }
+    }
 
+    return false;
+}
+
+}
+
+bool MeshFixDegeneratedFacets::Fixup()
+{
+    std::vector<FacetIndex> indices;
     MeshFacetIterator it(_rclMesh);
     for (it.Init(); it.More(); it.Next()) {
-        if (it->IsDegenerated(fEpsilon)) {
-            FacetIndex uId = it.Position();
-            bool removed = cTopAlg.RemoveDegeneratedFacet(uId);
-            if (removed) {
-                // due to a modification of the array the iterator became invalid
-                it.Set(uId-1);
+        if (it->IsDegenerated(fEpsilon))
+            indices.push_back(it.Position());
+    }
+
+    if (indices.empty())
+        return true;
+
+    MeshHalfEdgeKernel mesh;
+    mesh.Build(_rclMesh);
+
+    // swapping an edge can lead to further degenerated facets, so repeat this a few times
+    for (int pass = 0; pass < 3 && !indices.empty(); pass++) {
+        std::vector<FacetIndex> modified;
+        for (FacetIndex index : indices) {
+            if (!mesh.IsValidFacet(index))
+                continue;
+            HalfEdgeIndex h = static_cast<HalfEdgeIndex>(3 * index);
+            MeshGeomFacet face(mesh.GetPoint(mesh.Origin(h)),
+                               mesh.GetPoint(mesh.Origin(h + 1)),
+                               mesh.GetPoint(mesh.Origin(h + 2)));
+            if (!face.IsDegenerated(fEpsilon))
+                continue;
+            if (RemoveDegeneratedFacet(mesh, index) && mesh.IsValidFacet(index)) {
+                // a swapped edge also changes the neighbour facet
+                modified.push_back(index);
+                for (HalfEdgeIndex k = h; k < h + 3; k++) {
+                    HalfEdgeIndex opp = mesh.Opposite(k);
+                    if (opp != HALFEDGE_INDEX_MAX)
+                        modified.push_back(MeshHalfEdgeKernel::Facet(opp));
+                }
             }
         }
+        std::sort(modified.begin(), modified.end());
+        modified.erase(std::unique(modified.begin(), modified.end()), modified.end());
+        indices.swap(modified);
     }
 
+    mesh.Flush(_rclMesh);
     return true;
 }
 
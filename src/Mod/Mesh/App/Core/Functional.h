@@ -25,6 +25,7 @@
 #define MESH_FUNCTIONAL_H
 
 #include <algorithm>
+#include <vector>
 #include <QtConcurrentRun>
 #include <QFuture>
 #include <QThread>
@@ -58,6 +59,39 @@ namespace MeshCore
         }
     }
 
+    /**
+     * Splits the index range [begin, end) into \a threads blocks of about the same
+     * size and calls \a func(first, last) for each block in its own thread.
+     * If \a threads is less than 1 the ideal thread count of the system is used.
+     * The function returns after all blocks have been processed.
+     */
+    template <class Index, class Func>
+    static void parallel_for(Index begin, Index end, Func func, int threads = 0)
+    {
+        if (threads < 1)
+            threads = QThread::idealThreadCount();
+        Index count = end > begin ? end - begin : 0;
+        if (threads < 2 || count < static_cast<Index>(2 * threads))
+        {
+            if (count > 0)
+                func(begin, end);
+            return;
+        }
+
+        Index block = count / static_cast<Index>(threads);
+        std::vector< QFuture<void> > futures;
+        futures.reserve(threads);
+        Index first = begin;
+        for (int i = 0; i < threads; i++)
+        {
+            Index last = (i == threads - 1) ? end : first + block;
+            futures.push_back(QtConcurrent::run([func, first, last]() { func(first, last); }));
+            first = last;
+        }
+        for (auto& it : futures)
+            it.waitForFinished();
+    }
+
 } // namespace MeshCore
 
 
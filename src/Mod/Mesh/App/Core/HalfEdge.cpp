@@ -0,0 +1,605 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <atomic>
+#endif
+
+#include "HalfEdge.h"
+#include "Functional.h"
+#include "MeshKernel.h"
+#include <Base/Exception.h>
+
+
+using namespace MeshCore;
+
+MeshHalfEdgeKernel::MeshHalfEdgeKernel()
+  : numFacets(0)
+  , numNonManifolds(0)
+{
+}
+
+MeshHalfEdgeKernel::~MeshHalfEdgeKernel()
+{
+}
+
+void MeshHalfEdgeKernel::Clear()
+{
+    points.clear();
+    corners.clear();
+    opposite.clear();
+    outgoing.clear();
+    pointFlags.clear();
+    numFacets = 0;
+    numNonManifolds = 0;
+}
+
+void MeshHalfEdgeKernel::Build(const MeshKernel& kernel, int threads)
+{
+    const MeshPointArray& rPoints = kernel.GetPoints();
+    const MeshFacetArray& rFacets = kernel.GetFacets();
+    if (3 * rFacets.size() >= static_cast<std::size_t>(HALFEDGE_INDEX_MAX) ||
+        rPoints.size() >= static_cast<std::size_t>(HALFEDGE_INDEX_MAX))
+        throw Base::ValueError("Mesh is too large for the half-edge structure");
+
+    Clear();
+    points.assign(rPoints.begin(), rPoints.end());
+    corners.resize(3 * rFacets.size());
+    for (std::size_t i = 0; i < rFacets.size(); i++) {
+        for (int j = 0; j < 3; j++)
+            corners[3*i+j] = static_cast<std::uint32_t>(rFacets[i]._aulPoints[j]);
+    }
+    numFacets = rFacets.size();
+
+    const std::size_t numPoints = points.size();
+    const std::size_t numHalfEdges = corners.size();
+
+    // point to facet references in compressed row storage
+    std::vector<std::uint32_t> offsets(numPoints + 1, 0);
+    for (std::uint32_t p : corners)
+        offsets[p + 1]++;
+    for (std::size_t i = 0; i < numPoints; i++)
+        offsets[i + 1] += offsets[i];
+    std::vector<std::uint32_t> pointFacets(numHalfEdges);
+    {
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (HalfEdgeIndex h = 0; h < numHalfEdges; h++)
+            pointFacets[fill[corners[h]]++] = h / 3;
+    }
+
+    // pair the half-edges, each thread only writes the opposites of its own half-edges
+    opposite.assign(numHalfEdges, HALFEDGE_INDEX_MAX);
+    pointFlags.assign(numPoints, 0);
+    std::vector<unsigned char> nonManifoldEdge(numHalfEdges, 0);
+    std::atomic<std::size_t> countNonManifolds(0);
+    parallel_for<std::size_t>(0, numHalfEdges, [&](std::size_t begin, std::size_t end) {
+        std::size_t count = 0;
+        for (std::size_t i = begin; i < end; i++) {
+            HalfEdgeIndex h = static_cast<HalfEdgeIndex>(i);
+            PointIndex p0 = Origin(h);
+            PointIndex p1 = Target(h);
+            int sameDir = 0, oppDir = 0;
+            HalfEdgeIndex opp = HALFEDGE_INDEX_MAX;
+            for (std::uint32_t j = offsets[p1]; j < offsets[p1 + 1]; j++) {
+                HalfEdgeIndex f = pointFacets[j];
+                for (HalfEdgeIndex k = 3*f; k < 3*f+3; k++) {
+                    if (Origin(k) == p1 && Target(k) == p0) {
+                        oppDir++;
+                        opp = k;
+                    }
+                    else if (Origin(k) == p0 && Target(k) == p1) {
+                        sameDir++;
+                    }
+                }
+            }
+            if (sameDir == 1 && oppDir == 1)
+                opposite[h] = opp;
+            else if (sameDir + oppDir > 1) {
+                nonManifoldEdge[h] = 1;
+                count++;
+            }
+        }
+        countNonManifolds += count;
+    }, threads);
+    numNonManifolds = countNonManifolds;
+
+    // Set the outgoing half-edges and check whether all facets of a point can be
+    // reached by rotating around it
+    outgoing.assign(numPoints, HALFEDGE_INDEX_MAX);
+    parallel_for<std::size_t>(0, numPoints, [&](std::size_t begin, std::size_t end) {
+        std::vector<FacetIndex> ringFacets;
+        std::vector<PointIndex> ringPoints;
+        for (std::size_t p = begin; p < end; p++) {
+            std::uint32_t count = offsets[p + 1] - offsets[p];
+            if (count == 0) {
+                pointFlags[p] = Isolated;
+                continue;
+            }
+
+            bool manifold = true;
+            for (std::uint32_t j = offsets[p]; j < offsets[p + 1]; j++) {
+                HalfEdgeIndex f = pointFacets[j];
+                for (HalfEdgeIndex k = 3*f; k < 3*f+3; k++) {
+                    if (Origin(k) != p)
+                        continue;
+                    if (outgoing[p] == HALFEDGE_INDEX_MAX)
+                        outgoing[p] = k;
+                    // degenerated facet
+                    if (Target(k) == p || Origin(Prev(k)) == p)
+                        manifold = false;
+                    // non-manifold edge
+                    if (nonManifoldEdge[k] || nonManifoldEdge[Prev(k)])
+                        manifold = false;
+                }
+            }
+
+            GetRing(static_cast<PointIndex>(p), ringFacets, ringPoints);
+            if (!manifold || ringFacets.size() != count)
+                pointFlags[p] = NonManifold;
+        }
+    }, threads);
+}
+
+void MeshHalfEdgeKernel::Flush(MeshKernel& kernel) const
+{
+    std::vector<PointIndex> pointIndex(points.size(), POINT_INDEX_MAX);
+    for (std::size_t i = 0; i < corners.size(); i += 3) {
+        if (corners[i] == HALFEDGE_INDEX_MAX)
+            continue;
+        for (std::size_t k = i; k < i + 3; k++)
+            pointIndex[corners[k]] = 0;
+    }
+
+    MeshPointArray newPoints;
+    newPoints.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); i++) {
+        bool isolatedPoint = i < pointFlags.size() && (pointFlags[i] & Isolated);
+        if (pointIndex[i] != POINT_INDEX_MAX || isolatedPoint) {
+            pointIndex[i] = newPoints.size();
+            newPoints.push_back(points[i]);
+        }
+    }
+
+    std::vector<FacetIndex> facetIndex(corners.size() / 3, FACET_INDEX_MAX);
+    FacetIndex count = 0;
+    for (std::size_t f = 0; f < facetIndex.size(); f++) {
+        if (corners[3*f] != HALFEDGE_INDEX_MAX)
+            facetIndex[f] = count++;
+    }
+
+    MeshFacetArray newFacets;
+    newFacets.reserve(count);
+    for (std::size_t f = 0; f < facetIndex.size(); f++) {
+        if (facetIndex[f] == FACET_INDEX_MAX)
+            continue;
+        MeshFacet face;
+        for (int k = 0; k < 3; k++) {
+            HalfEdgeIndex h = static_cast<HalfEdgeIndex>(3*f+k);
+            face._aulPoints[k] = pointIndex[corners[h]];
+            HalfEdgeIndex o = opposite[h];
+            face._aulNeighbours[k] = o != HALFEDGE_INDEX_MAX ? facetIndex[o / 3] : FACET_INDEX_MAX;
+        }
+        newFacets.push_back(face);
+    }
+
+    // open edges of non-manifolds must be resolved by the kernel
+    kernel.Adopt(newPoints, newFacets, numNonManifolds > 0);
+}
+
+Base::Vector3f MeshHalfEdgeKernel::GetNormal(FacetIndex f) const
+{
+    const Base::Vector3f& p0 = points[corners[3*f]];
+    const Base::Vector3f& p1 = points[corners[3*f+1]];
+    const Base::Vector3f& p2 = points[corners[3*f+2]];
+    return (p1 - p0) % (p2 - p0);
+}
+
+bool MeshHalfEdgeKernel::GetRing(PointIndex p, std::vector<FacetIndex>& facets,
+                                 std::vector<PointIndex>& neighbours) const
+{
+    facets.clear();
+    neighbours.clear();
+    HalfEdgeIndex start = outgoing[p];
+    if (start == HALFEDGE_INDEX_MAX)
+        return false;
+
+    // rotate in one direction until the start or a border is reached
+    std::size_t guard = corners.size();
+    bool border = false;
+    HalfEdgeIndex h = start;
+    do {
+        facets.push_back(Facet(h));
+        neighbours.push_back(Target(h));
+        HalfEdgeIndex o = opposite[Prev(h)];
+        if (o == HALFEDGE_INDEX_MAX) {
+            neighbours.push_back(Origin(Prev(h)));
+            border = true;
+            break;
+        }
+        h = o;
+    }
+    while (h != start && --guard > 0);
+
+    if (!border)
+        return false;
+
+    // then rotate in the other direction
+    h = start;
+    while (opposite[h] != HALFEDGE_INDEX_MAX && --guard > 0) {
+        h = Next(opposite[h]);
+        facets.push_back(Facet(h));
+        neighbours.push_back(Target(h));
+    }
+
+    return true;
+}
+
+HalfEdgeIndex MeshHalfEdgeKernel::FindHalfEdge(PointIndex p0, PointIndex p1) const
+{
+    HalfEdgeIndex start = outgoing[p0];
+    if (start == HALFEDGE_INDEX_MAX)
+        return HALFEDGE_INDEX_MAX;
+
+    std::size_t guard = corners.size();
+    HalfEdgeIndex h = start;
+    do {
+        if (Target(h) == p1)
+            return h;
+        HalfEdgeIndex o = opposite[Prev(h)];
+        if (o == HALFEDGE_INDEX_MAX)
+            break;
+        h = o;
+    }
+    while (h != start && --guard > 0);
+
+    h = start;
+    while (opposite[h] != HALFEDGE_INDEX_MAX && --guard > 0) {
+        h = Next(opposite[h]);
+        if (h == start)
+            break;
+        if (Target(h) == p1)
+            return h;
+    }
+
+    return HALFEDGE_INDEX_MAX;
+}
+
+void MeshHalfEdgeKernel::GetBoundaries(std::list<std::vector<PointIndex> >& boundaries) const
+{
+    std::vector<bool> visited(corners.size(), false);
+    for (HalfEdgeIndex h = 0; h < corners.size(); h++) {
+        if (visited[h] || !IsBoundary(h) || !IsValid(h))
+            continue;
+
+        std::vector<PointIndex> boundary;
+        boundary.push_back(Origin(h));
+        HalfEdgeIndex cur = h;
+        std::size_t guard = corners.size();
+        do {
+            visited[cur] = true;
+            boundary.push_back(Target(cur));
+
+            // rotate around the target point to the next open edge
+            HalfEdgeIndex next = Next(cur);
+            while (opposite[next] != HALFEDGE_INDEX_MAX && --guard > 0)
+                next = Next(opposite[next]);
+            cur = next;
+        }
+        while (cur != h && !visited[cur] && --guard > 0);
+
+        boundaries.push_back(boundary);
+    }
+}
+
+void MeshHalfEdgeKernel::Link(HalfEdgeIndex a, HalfEdgeIndex b)
+{
+    if (a != HALFEDGE_INDEX_MAX)
+        opposite[a] = b;
+    if (b != HALFEDGE_INDEX_MAX)
+        opposite[b] = a;
+}
+
+bool MeshHalfEdgeKernel::IsCollapseEdgeLegal(HalfEdgeIndex h) const
+{
+    PointIndex p0 = Origin(h);
+    PointIndex p1 = Target(h);
+    HalfEdgeIndex opp = opposite[h];
+
+    // an edge whose facets have no other neighbours would leave dangling points
+    HalfEdgeIndex a = opposite[Next(h)];
+    HalfEdgeIndex b = opposite[Prev(h)];
+    if (a == HALFEDGE_INDEX_MAX && b == HALFEDGE_INDEX_MAX)
+        return false;
+    PointIndex p2 = Target(Next(h));
+    PointIndex p3 = POINT_INDEX_MAX;
+    if (opp != HALFEDGE_INDEX_MAX) {
+        HalfEdgeIndex c = opposite[Next(opp)];
+        HalfEdgeIndex d = opposite[Prev(opp)];
+        if (c == HALFEDGE_INDEX_MAX && d == HALFEDGE_INDEX_MAX)
+            return false;
+        p3 = Target(Next(opp));
+        if (p2 == p3)
+            return false;
+    }
+
+    std::vector<FacetIndex> facets;
+    std::vector<PointIndex> ring0, ring1;
+    bool border0 = GetRing(p0, facets, ring0);
+    bool border1 = GetRing(p1, facets, ring1);
+
+    // an inner edge connecting two boundary points would pinch the surface
+    if (opp != HALFEDGE_INDEX_MAX && border0 && border1)
+        return false;
+
+    // link condition: the common neighbours must be the opposite points of the edge
+    for (PointIndex n : ring0) {
+        if (n == p1 || n == p2 || n == p3)
+            continue;
+        if (std::find(ring1.begin(), ring1.end(), n) != ring1.end())
+            return false;
+    }
+
+    // the opposite points must keep a valid valence
+    for (PointIndex p : {p2, p3}) {
+        if (p == POINT_INDEX_MAX)
+            continue;
+        bool border = GetRing(p, facets, ring0);
+        if (ring0.size() < (border ? 3u : 4u))
+            return false;
+    }
+
+    return true;
+}
+
+PointIndex MeshHalfEdgeKernel::CollapseEdge(HalfEdgeIndex h, bool keepOrigin)
+{
+    PointIndex p0 = Origin(h);
+    PointIndex p1 = Target(h);
+    PointIndex keep = keepOrigin ? p0 : p1;
+    PointIndex remove = keepOrigin ? p1 : p0;
+
+    std::vector<FacetIndex> facets;
+    std::vector<PointIndex> neighbours;
+    GetRing(remove, facets, neighbours);
+
+    HalfEdgeIndex opp = opposite[h];
+    HalfEdgeIndex a = opposite[Next(h)];
+    HalfEdgeIndex b = opposite[Prev(h)];
+    PointIndex p2 = Target(Next(h));
+    HalfEdgeIndex c = HALFEDGE_INDEX_MAX, d = HALFEDGE_INDEX_MAX;
+    PointIndex p3 = POINT_INDEX_MAX;
+    if (opp != HALFEDGE_INDEX_MAX) {
+        c = opposite[Next(opp)];
+        d = opposite[Prev(opp)];
+        p3 = Target(Next(opp));
+    }
+
+    // remove the facets at the edge and glue their outer edges together
+    Link(a, b);
+    corners[h - h % 3] = HALFEDGE_INDEX_MAX;
+    numFacets--;
+    if (opp != HALFEDGE_INDEX_MAX) {
+        Link(c, d);
+        corners[opp - opp % 3] = HALFEDGE_INDEX_MAX;
+        numFacets--;
+    }
+
+    for (FacetIndex f : facets) {
+        if (corners[3*f] == HALFEDGE_INDEX_MAX)
+            continue;
+        for (std::size_t k = 3*f; k < 3*f+3; k++) {
+            if (corners[k] == remove)
+                corners[k] = static_cast<std::uint32_t>(keep);
+        }
+    }
+
+    // update the outgoing half-edges of the affected points
+    outgoing[remove] = HALFEDGE_INDEX_MAX;
+    outgoing[keep] = HALFEDGE_INDEX_MAX;
+    for (HalfEdgeIndex x : {a, b, c, d}) {
+        if (x != HALFEDGE_INDEX_MAX) {
+            outgoing[keep] = OutgoingFrom(x, keep);
+            break;
+        }
+    }
+    if (a != HALFEDGE_INDEX_MAX || b != HALFEDGE_INDEX_MAX)
+        outgoing[p2] = OutgoingFrom(a != HALFEDGE_INDEX_MAX ? a : b, p2);
+    if (c != HALFEDGE_INDEX_MAX || d != HALFEDGE_INDEX_MAX)
+        outgoing[p3] = OutgoingFrom(c != HALFEDGE_INDEX_MAX ? c : d, p3);
+
+    return keep;
+}
+
+bool MeshHalfEdgeKernel::IsSwapEdgeLegal(HalfEdgeIndex h) const
+{
+    HalfEdgeIndex opp = opposite[h];
+    if (opp == HALFEDGE_INDEX_MAX)
+        return false;
+
+    PointIndex p0 = Origin(h);
+    PointIndex p1 = Target(h);
+    PointIndex p2 = Target(Next(h));
+    PointIndex p3 = Target(Next(opp));
+    if (p2 == p3 || p0 == p1)
+        return false;
+
+    // the new edge must not exist yet
+    if (FindHalfEdge(p2, p3) != HALFEDGE_INDEX_MAX || FindHalfEdge(p3, p2) != HALFEDGE_INDEX_MAX)
+        return false;
+
+    return true;
+}
+
+void MeshHalfEdgeKernel::SwapEdge(HalfEdgeIndex h)
+{
+    // The facets F = (p0, p1, p2) and G = (p1, p0, p3) are replaced by
+    // F = (p2, p0, p3) and G = (p3, p1, p2) so that the new edge is p2-p3.
+    HalfEdgeIndex opp = opposite[h];
+    HalfEdgeIndex hn = Next(h), hp = Prev(h);
+    HalfEdgeIndex on = Next(opp), op = Prev(opp);
+    std::uint32_t p0 = corners[h];
+    std::uint32_t p1 = corners[hn];
+    std::uint32_t p2 = corners[hp];
+    std::uint32_t p3 = corners[op];
+
+    HalfEdgeIndex oppHn = opposite[hn];
+    HalfEdgeIndex oppHp = opposite[hp];
+    HalfEdgeIndex oppOn = opposite[on];
+    HalfEdgeIndex oppOp = opposite[op];
+
+    HalfEdgeIndex f = h - h % 3;
+    HalfEdgeIndex g = opp - opp % 3;
+    corners[f] = p2; corners[f+1] = p0; corners[f+2] = p3;
+    corners[g] = p3; corners[g+1] = p1; corners[g+2] = p2;
+
+    Link(f, oppHp);
+    Link(f+1, oppOn);
+    Link(g, oppOp);
+    Link(g+1, oppHn);
+    Link(f+2, g+2);
+
+    outgoing[p0] = f+1;
+    outgoing[p1] = g+1;
+    outgoing[p2] = f;
+    outgoing[p3] = g;
+}
+
+PointIndex MeshHalfEdgeKernel::AddPoint(const Base::Vector3f& p)
+{
+    PointIndex index = points.size();
+    points.push_back(p);
+    outgoing.push_back(HALFEDGE_INDEX_MAX);
+    pointFlags.push_back(Isolated);
+    return index;
+}
+
+PointIndex MeshHalfEdgeKernel::SplitEdge(HalfEdgeIndex h, const Base::Vector3f& p)
+{
+    // The new point w is inserted between p0 and p1 and connected with the
+    // opposite points p2 and p3 of the facets F = (p0, p1, p2) and G = (p1, p0, p3).
+    PointIndex w = AddPoint(p);
+    pointFlags[w] = 0;
+
+    HalfEdgeIndex opp = opposite[h];
+    HalfEdgeIndex hn = Next(h);
+    std::uint32_t p1 = corners[hn];
+    std::uint32_t p2 = corners[Prev(h)];
+    HalfEdgeIndex oppHn = opposite[hn];
+
+    // F becomes (p0, w, p2) and the new facet (w, p1, p2)
+    corners[hn] = static_cast<std::uint32_t>(w);
+    HalfEdgeIndex n = static_cast<HalfEdgeIndex>(corners.size());
+    corners.push_back(static_cast<std::uint32_t>(w));
+    corners.push_back(p1);
+    corners.push_back(p2);
+    opposite.resize(corners.size(), HALFEDGE_INDEX_MAX);
+    numFacets++;
+    Link(n+1, oppHn);
+    Link(n+2, hn);
+
+    outgoing[w] = n;
+    outgoing[p1] = n+1;
+
+    if (opp != HALFEDGE_INDEX_MAX) {
+        // G becomes (w, p0, p3) and the new facet (p1, w, p3)
+        HalfEdgeIndex op = Prev(opp);
+        std::uint32_t p3 = corners[op];
+        HalfEdgeIndex oppOp = opposite[op];
+        corners[opp] = static_cast<std::uint32_t>(w);
+        HalfEdgeIndex m = static_cast<HalfEdgeIndex>(corners.size());
+        corners.push_back(p1);
+        corners.push_back(static_cast<std::uint32_t>(w));
+        corners.push_back(p3);
+        opposite.resize(corners.size(), HALFEDGE_INDEX_MAX);
+        numFacets++;
+        Link(m, n);
+        Link(m+1, op);
+        Link(m+2, oppOp);
+    }
+
+    return w;
+}
+
+FacetIndex MeshHalfEdgeKernel::AddFacet(PointIndex p0, PointIndex p1, PointIndex p2)
+{
+    if (p0 == p1 || p1 == p2 || p2 == p0)
+        return FACET_INDEX_MAX;
+
+    PointIndex pts[3] = {p0, p1, p2};
+    HalfEdgeIndex opps[3];
+    for (int i = 0; i < 3; i++) {
+        PointIndex a = pts[i];
+        PointIndex b = pts[(i+1)%3];
+        // an edge with the same orientation already exists
+        if (FindHalfEdge(a, b) != HALFEDGE_INDEX_MAX)
+            return FACET_INDEX_MAX;
+        opps[i] = FindHalfEdge(b, a);
+        // the edge is already shared by two facets
+        if (opps[i] != HALFEDGE_INDEX_MAX && !IsBoundary(opps[i]))
+            return FACET_INDEX_MAX;
+    }
+
+    HalfEdgeIndex f = static_cast<HalfEdgeIndex>(corners.size());
+    for (int i = 0; i < 3; i++)
+        corners.push_back(static_cast<std::uint32_t>(pts[i]));
+    opposite.resize(corners.size(), HALFEDGE_INDEX_MAX);
+    numFacets++;
+    for (int i = 0; i < 3; i++) {
+        Link(f+i, opps[i]);
+        if (outgoing[pts[i]] == HALFEDGE_INDEX_MAX)
+            outgoing[pts[i]] = f+i;
+        pointFlags[pts[i]] &= ~Isolated;
+    }
+
+    return Facet(f);
+}
+
+void MeshHalfEdgeKernel::RemoveFacet(FacetIndex f)
+{
+    HalfEdgeIndex base = static_cast<HalfEdgeIndex>(3*f);
+    if (corners[base] == HALFEDGE_INDEX_MAX)
+        return;
+
+    // find other outgoing half-edges for the corner points before opening the edges
+    for (HalfEdgeIndex h = base; h < base + 3; h++) {
+        PointIndex p = corners[h];
+        if (outgoing[p] < base || outgoing[p] >= base + 3)
+            continue;
+        HalfEdgeIndex o = opposite[Prev(h)];
+        if (o == HALFEDGE_INDEX_MAX && opposite[h] != HALFEDGE_INDEX_MAX)
+            o = Next(opposite[h]);
+        outgoing[p] = o;
+    }
+
+    for (HalfEdgeIndex h = base; h < base + 3; h++) {
+        HalfEdgeIndex o = opposite[h];
+        if (o != HALFEDGE_INDEX_MAX)
+            opposite[o] = HALFEDGE_INDEX_MAX;
+        opposite[h] = HALFEDGE_INDEX_MAX;
+    }
+
+    corners[base] = HALFEDGE_INDEX_MAX;
+    numFacets--;
+}
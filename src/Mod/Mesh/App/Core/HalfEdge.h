@@ -0,0 +1,197 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_HALFEDGE_H
+#define MESH_HALFEDGE_H
+
+#include <cstdint>
+#include <list>
+#include <vector>
+
+#include <Base/Vector3D.h>
+#include "Definitions.h"
+
+namespace MeshCore
+{
+class MeshKernel;
+
+using HalfEdgeIndex = std::uint32_t;
+const HalfEdgeIndex HALFEDGE_INDEX_MAX = UINT32_MAX;
+
+/**
+ * The MeshHalfEdgeKernel class is an alternative representation of a triangle mesh
+ * for algorithms that do many local modifications of the topology.
+ *
+ * The half-edges are stored implicitly with the facets: the half-edge 3*f+k starts at
+ * corner k of facet f and ends at corner (k+1)%3. Only the opposite half-edge and one
+ * outgoing half-edge per point are stored explicitly. This way operations like swapping,
+ * splitting or collapsing an edge run in constant time (or in the valence of the involved
+ * points) while in a MeshKernel the arrays must be re-organized.
+ *
+ * Removed facets are only marked as invalid, so all indices stay valid until the
+ * structure is written back with Flush().
+ *
+ * Edges shared by more than two facets or by two facets with inconsistent orientation
+ * are treated as open edges. Rotating around a non-manifold point doesn't reach all
+ * of its facets, so the topological operations must not be applied there.
+ */
+class MeshExport MeshHalfEdgeKernel
+{
+public:
+    MeshHalfEdgeKernel();
+    ~MeshHalfEdgeKernel();
+
+    /** @name Conversion */
+    //@{
+    /** Builds the half-edge structure of \a kernel. The pairing of the half-edges
+     * is done with \a threads threads, a value < 1 uses all available cores.
+     */
+    void Build(const MeshKernel& kernel, int threads = 0);
+    /** Writes the valid facets and all referenced or isolated points back to \a kernel.
+     * The order of the remaining elements is kept and new elements are appended.
+     */
+    void Flush(MeshKernel& kernel) const;
+    void Clear();
+    //@}
+
+    /** @name Access */
+    //@{
+    /// Returns the number of points including the removed ones.
+    std::size_t CountPoints() const
+    { return points.size(); }
+    /// Returns the number of valid facets.
+    std::size_t CountFacets() const
+    { return numFacets; }
+    /// Returns the number of half-edges including the ones of removed facets.
+    std::size_t CountHalfEdges() const
+    { return corners.size(); }
+    /// Returns the number of half-edges that are part of a non-manifold edge.
+    std::size_t CountNonManifoldEdges() const
+    { return numNonManifolds; }
+    static HalfEdgeIndex Next(HalfEdgeIndex h)
+    { return (h % 3 == 2) ? h - 2 : h + 1; }
+    static HalfEdgeIndex Prev(HalfEdgeIndex h)
+    { return (h % 3 == 0) ? h + 2 : h - 1; }
+    static FacetIndex Facet(HalfEdgeIndex h)
+    { return h / 3; }
+    PointIndex Origin(HalfEdgeIndex h) const
+    { return corners[h]; }
+    PointIndex Target(HalfEdgeIndex h) const
+    { return corners[Next(h)]; }
+    HalfEdgeIndex Opposite(HalfEdgeIndex h) const
+    { return opposite[h]; }
+    /// Returns an outgoing half-edge of the point or HALFEDGE_INDEX_MAX if it has no facets.
+    HalfEdgeIndex Outgoing(PointIndex p) const
+    { return outgoing[p]; }
+    bool IsBoundary(HalfEdgeIndex h) const
+    { return opposite[h] == HALFEDGE_INDEX_MAX; }
+    bool IsValid(HalfEdgeIndex h) const
+    { return corners[h - h % 3] != HALFEDGE_INDEX_MAX; }
+    bool IsValidFacet(FacetIndex f) const
+    { return corners[3 * f] != HALFEDGE_INDEX_MAX; }
+    /** Returns false if the point is referenced by a non-manifold edge, a degenerated facet
+     * or if not all of its facets can be reached by rotating around it.
+     * This information is set up by Build() and not updated by the topological operations.
+     */
+    bool IsManifoldPoint(PointIndex p) const
+    { return (pointFlags[p] & NonManifold) == 0; }
+    const Base::Vector3f& GetPoint(PointIndex p) const
+    { return points[p]; }
+    void SetPoint(PointIndex p, const Base::Vector3f& v)
+    { points[p] = v; }
+    /// Returns the (not normalized) normal of the facet.
+    Base::Vector3f GetNormal(FacetIndex f) const;
+    /** Collects the facets and neighbour points around point \a p. Returns true if \a p
+     * is a boundary point, false otherwise.
+     */
+    bool GetRing(PointIndex p, std::vector<FacetIndex>& facets,
+                 std::vector<PointIndex>& neighbours) const;
+    /** Returns the half-edge from \a p0 to \a p1 or HALFEDGE_INDEX_MAX if it doesn't exist. */
+    HalfEdgeIndex FindHalfEdge(PointIndex p0, PointIndex p1) const;
+    /** Returns the closed boundary polygons. The first and last point of a polygon are equal. */
+    void GetBoundaries(std::list<std::vector<PointIndex> >& boundaries) const;
+    //@}
+
+    /** @name Topological Operations */
+    //@{
+    /**
+     * Checks whether the edge of \a h can be collapsed without changing the topological
+     * type of the surface, i.e. without creating non-manifolds or degenerated facets.
+     * Geometric criteria like flipping normals are not checked.
+     */
+    bool IsCollapseEdgeLegal(HalfEdgeIndex h) const;
+    /**
+     * Collapses the edge of \a h. The facets at the edge are removed and the target point
+     * of \a h replaces its origin point, or the other way round if \a keepOrigin is true.
+     * Returns the remaining point.
+     */
+    PointIndex CollapseEdge(HalfEdgeIndex h, bool keepOrigin = false);
+    /**
+     * Checks whether the inner edge of \a h can be swapped without creating an already
+     * existing edge.
+     */
+    bool IsSwapEdgeLegal(HalfEdgeIndex h) const;
+    /**
+     * Swaps the inner edge of \a h. The two facets keep their indices.
+     */
+    void SwapEdge(HalfEdgeIndex h);
+    /**
+     * Splits the edge of \a h at the point \a p. The adjacent facets are split into two
+     * facets each. Returns the index of the new point.
+     */
+    PointIndex SplitEdge(HalfEdgeIndex h, const Base::Vector3f& p);
+    /// Appends a new isolated point.
+    PointIndex AddPoint(const Base::Vector3f& p);
+    /**
+     * Adds a new facet and connects it to the adjacent facets. If one of its edges is
+     * already shared by two facets or has the wrong orientation the facet is not added
+     * and FACET_INDEX_MAX is returned.
+     */
+    FacetIndex AddFacet(PointIndex p0, PointIndex p1, PointIndex p2);
+    /// Removes the facet and opens its edges.
+    void RemoveFacet(FacetIndex f);
+    //@}
+
+private:
+    enum PointFlag : unsigned char {
+        Isolated = 1,
+        NonManifold = 2
+    };
+    HalfEdgeIndex OutgoingFrom(HalfEdgeIndex h, PointIndex p) const
+    { return Origin(h) == p ? h : Next(h); }
+    void Link(HalfEdgeIndex a, HalfEdgeIndex b);
+
+private:
+    std::vector<Base::Vector3f> points;
+    std::vector<std::uint32_t> corners;
+    std::vector<HalfEdgeIndex> opposite;
+    std::vector<HalfEdgeIndex> outgoing;
+    std::vector<unsigned char> pointFlags;
+    std::size_t numFacets;
+    std::size_t numNonManifolds;
+};
+
+} // namespace MeshCore
+
+
+#endif  // MESH_HALFEDGE_H
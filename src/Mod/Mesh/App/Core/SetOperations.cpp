@@ -41,9 +41,11 @@
 #include "Evaluation.h"
 #include "Definitions.h"
 #include "Triangulation.h"
+#include "Functional.h"
 
 #include <Base/Sequencer.h>
 #include <Base/Builder3D.h>
+#include <Base/Converter.h>
 #include <Base/Tools2D.h>
 
 using namespace Base;
@@ -170,246 +172,171 @@ void SetOperations::Do ()
   MeshDefinitions::SetMinPointDistance(saveMinMeshDistance);
 }
 
+namespace MeshCore {
+namespace SetOps {
+
+struct FacetCut
+{
+  FacetIndex facet1;
+  MeshPoint pt0, pt1;
+  bool single;
+};
+
+/*
+ * Checks in double precision whether all corners of \a f2 lie clearly on one side of the
+ * plane of \a f1. This rejects most of the candidate pairs before the intersection test.
+ */
+static bool SeparatedByPlane (const MeshGeomFacet& f1, const MeshGeomFacet& f2)
+{
+  Base::Vector3d a = Base::convertTo<Base::Vector3d>(f1._aclPoints[0]);
+  Base::Vector3d b = Base::convertTo<Base::Vector3d>(f1._aclPoints[1]);
+  Base::Vector3d c = Base::convertTo<Base::Vector3d>(f1._aclPoints[2]);
+  Base::Vector3d n = (b - a) % (c - a);
+  double len = n.Length();
+  if (len == 0.0)
+    return false;
+
+  double size = std::max(Base::Distance(a, b), Base::Distance(a, c));
+  double tol = 1e-6 * len * size;
+  int above = 0, below = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    double d = n * (Base::convertTo<Base::Vector3d>(f2._aclPoints[i]) - a);
+    if (d > tol)
+      above++;
+    else if (d < -tol)
+      below++;
+  }
+
+  return above == 3 || below == 3;
+}
+
+}
+}
+
 void SetOperations::Cut (std::set<FacetIndex>& facetsCuttingEdge0, std::set<FacetIndex>& facetsCuttingEdge1)
 {
-  MeshFacetGrid grid1(_cutMesh0, 20);
   MeshFacetGrid grid2(_cutMesh1, 20);
 
-  unsigned long ctGx1, ctGy1, ctGz1;
-  grid1.GetCtGrids(ctGx1, ctGy1, ctGz1);
-
-  unsigned long gx1;
-  for (gx1 = 0; gx1 < ctGx1; gx1++)  
+  // Intersect each facet of the first mesh with the candidates of the second mesh.
+  // Each thread only writes the results of its own facets.
+  std::vector<std::vector<SetOps::FacetCut> > cuts(_cutMesh0.CountFacets());
+  parallel_for<FacetIndex>(0, _cutMesh0.CountFacets(), [&](FacetIndex begin, FacetIndex end)
   {
-    unsigned long gy1;
-    for (gy1 = 0; gy1 < ctGy1; gy1++)
+    std::vector<FacetIndex> vecFacets2;
+    for (FacetIndex fidx1 = begin; fidx1 < end; fidx1++)
     {
-      unsigned long gz1;
-      for (gz1 = 0; gz1 < ctGz1; gz1++)
+      MeshGeomFacet f1 = _cutMesh0.GetFacet(fidx1);
+      Base::BoundBox3f box1 = f1.GetBoundBox();
+      box1.Enlarge(_minDistanceToPoint);
+      grid2.Inside(box1, vecFacets2);
+
+      for (std::vector<FacetIndex>::iterator it2 = vecFacets2.begin(); it2 != vecFacets2.end(); ++it2)
       {
-        if (grid1.GetCtElements(gx1, gy1, gz1) > 0)
+        FacetIndex fidx2 = *it2;
+        MeshGeomFacet f2 = _cutMesh1.GetFacet(fidx2);
+        if (!(box1 && f2.GetBoundBox()))
+          continue;
+        if (SetOps::SeparatedByPlane(f1, f2) || SetOps::SeparatedByPlane(f2, f1))
+          continue;
+
+        Base::Vector3f p0, p1;
+        int isect = f1.IntersectWithFacet(f2, p0, p1);
+        if (isect > 0)
         {
-          std::vector<FacetIndex> vecFacets2;
-          grid2.Inside(grid1.GetBoundBox(gx1, gy1, gz1), vecFacets2);
-      
-          if (vecFacets2.size() > 0)
+          // optimize cut line if distance to nearest point is too small
+          float minDist1 = _minDistanceToPoint, minDist2 = _minDistanceToPoint;
+          MeshPoint np0 = p0, np1 = p1;
+          for (int i = 0; i < 3; i++)
           {
-            std::set<FacetIndex> vecFacets1;
-            grid1.GetElements(gx1, gy1, gz1, vecFacets1);
-            
-            std::set<FacetIndex>::iterator it1;
-            for (it1 = vecFacets1.begin(); it1 != vecFacets1.end(); ++it1)
+            float d1 = (f1._aclPoints[i] - p0).Length();
+            float d2 = (f1._aclPoints[i] - p1).Length();
+            if (d1 < minDist1)
             {
-              FacetIndex fidx1 = *it1;
-              MeshGeomFacet f1 = _cutMesh0.GetFacet(*it1);
-              
-              std::vector<FacetIndex>::iterator it2;
-              for (it2 = vecFacets2.begin(); it2 != vecFacets2.end(); ++it2)
-              {
-                FacetIndex fidx2 = *it2;
-                MeshGeomFacet f2 = _cutMesh1.GetFacet(fidx2);
-
-                MeshPoint p0, p1;
-
-                int isect = f1.IntersectWithFacet(f2, p0, p1);
-                if (isect > 0)
-                { 
-                   // optimize cut line if distance to nearest point is too small
-                  float minDist1 = _minDistanceToPoint, minDist2 = _minDistanceToPoint;
-                  MeshPoint np0 = p0, np1 = p1;
-                  int i;
-                  for (i = 0; i < 3; i++)
-                  {
-                    float d1 = (f1._aclPoints[i] - p0).Length();
-                    float d2 = (f1._aclPoints[i] - p1).Length();
-                    if (d1 < minDist1)
-                    {
-                      minDist1 = d1;
-                      np0 = f1._aclPoints[i];
-                    }
-                    if (d2 < minDist2)
-                    {
-                      minDist2 = d2;
-                      p1 = f1._aclPoints[i];
-                    }
-                  } // for (int i = 0; i < 3; i++)
-
-                  // optimize cut line if distance to nearest point is too small
-                  for (i = 0; i < 3; i++)
-                  {
-                    float d1 = (f2._aclPoints[i] - p0).Length();
-                    float d2 = (f2._aclPoints[i] - p1).Length();
-                    if (d1 < minDist1)
-                    {
-                      minDist1 = d1;
-                      np0 = f2._aclPoints[i];
-                    }
-                    if (d2 < minDist2)
-                    {
-                      minDist2 = d2;
-                      np1 = f2._aclPoints[i];
-                    }
-                  } // for (int i = 0; i < 3; i++)
-
-                  MeshPoint mp0 = np0;
-                  MeshPoint mp1 = np1;
-
-                  if (mp0 != mp1)
-                  {
-                    facetsCuttingEdge0.insert(fidx1);
-                    facetsCuttingEdge1.insert(fidx2);
-
-                    _cutPoints.insert(mp0);
-                    _cutPoints.insert(mp1);
-
-                    std::pair<std::set<MeshPoint>::iterator, bool> pit0 = _cutPoints.insert(mp0);
-                    std::pair<std::set<MeshPoint>::iterator, bool> pit1 = _cutPoints.insert(mp1);
-
-                    _edges[Edge(mp0, mp1)] = EdgeInfo();
-
-                    _facet2points[0][fidx1].push_back(pit0.first);
-                    _facet2points[0][fidx1].push_back(pit1.first);
-                    _facet2points[1][fidx2].push_back(pit0.first);
-                    _facet2points[1][fidx2].push_back(pit1.first);
-
-                  }
-                  else
-                  {
-                    std::pair<std::set<MeshPoint>::iterator, bool> pit = _cutPoints.insert(mp0);
-
-                    // do not insert a facet when only one corner point cuts the edge
-                    // if (!((mp0 == f1._aclPoints[0]) || (mp0 == f1._aclPoints[1]) || (mp0 == f1._aclPoints[2])))
-                    {
-                      facetsCuttingEdge0.insert(fidx1);
-                      _facet2points[0][fidx1].push_back(pit.first);
-                    }
-
-                    // if (!((mp0 == f2._aclPoints[0]) || (mp0 == f2._aclPoints[1]) || (mp0 == f2._aclPoints[2])))
-                    {
-                      facetsCuttingEdge1.insert(fidx2);
-                      _facet2points[1][fidx2].push_back(pit.first);
-                    }
-                  }
-
-                 } // if (f1.IntersectWithFacet(f2, p0, p1))
-              } // for (it2 = vecFacets2.begin(); it2 != vecFacets2.end(); ++it2)
-            } // for (it1 = vecFacets1.begin(); it1 != vecFacets1.end(); ++it1)
-          } // if (vecFacets2.size() > 0)
-        } // if (grid1.GetCtElements(gx1, gy1, gz1) > 0)
-      } // for (gz1 = 0; gz1 < ctGz1; gz1++)
-    } // for (gy1 = 0; gy1 < ctGy1; gy1++)
-  } // for (gx1 = 0; gx1 < ctGx1; gx1++)  
-}
-
-void SetOperations::TriangulateMesh (const MeshKernel &cutMesh, int side)
-{
-  // Triangulate Mesh 
-  std::map<FacetIndex, std::list<std::set<MeshPoint>::iterator> >::iterator it1;
-  for (it1 = _facet2points[side].begin(); it1 != _facet2points[side].end(); ++it1)
-  {
-    std::vector<Vector3f> points;
-    std::set<MeshPoint>   pointsSet;
-
-    FacetIndex fidx = it1->first;
-    MeshGeomFacet f = cutMesh.GetFacet(fidx);
+              minDist1 = d1;
+              np0 = f1._aclPoints[i];
+            }
+            if (d2 < minDist2)
+            {
+              minDist2 = d2;
+              np1 = f1._aclPoints[i];
+            }
+          }
 
-    //if (side == 1)
-    //    _builder.addSingleTriangle(f._aclPoints[0], f._aclPoints[1], f._aclPoints[2], 3, 0, 1, 1);
+          for (int i = 0; i < 3; i++)
+          {
+            float d1 = (f2._aclPoints[i] - p0).Length();
+            float d2 = (f2._aclPoints[i] - p1).Length();
+            if (d1 < minDist1)
+            {
+              minDist1 = d1;
+              np0 = f2._aclPoints[i];
+            }
+            if (d2 < minDist2)
+            {
+              minDist2 = d2;
+              np1 = f2._aclPoints[i];
+            }
+          }
 
-     // facet corner points
-    //const MeshFacet& mf = cutMesh._aclFacetArray[fidx];
-    int i;
-    for (i = 0; i < 3; i++)
-    {
-      pointsSet.insert(f._aclPoints[i]);
-      points.push_back(f._aclPoints[i]);
-    }
-    
-    // triangulated facets
-    std::list<std::set<MeshPoint>::iterator>::iterator it2;
-    for (it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
-    {
-      if (pointsSet.find(*(*it2)) == pointsSet.end())
-      {
-        pointsSet.insert(*(*it2));
-        points.push_back(*(*it2));
+          SetOps::FacetCut cut;
+          cut.facet1 = fidx2;
+          cut.pt0 = np0;
+          cut.pt1 = np1;
+          cut.single = (np0 == np1);
+          cuts[fidx1].push_back(cut);
+        }
       }
-
     }
+  });
 
-    Vector3f normal = f.GetNormal();
-    Vector3f base = points[0];
-    Vector3f dirX = points[1] - points[0];
-    dirX.Normalize();
-    Vector3f dirY = dirX % normal;
-
-    // project points to 2D plane
-    std::vector<Vector3f>::iterator it;
-    std::vector<Vector3f> vertices;
-    for (it = points.begin(); it != points.end(); ++it)
+  // Merging the cut points must be done sequentially because the points are
+  // compared with a tolerance
+  for (FacetIndex fidx1 = 0; fidx1 < cuts.size(); fidx1++)
+  {
+    for (std::vector<SetOps::FacetCut>::const_iterator it = cuts[fidx1].begin(); it != cuts[fidx1].end(); ++it)
     {
-      Vector3f pv = *it;
-      pv.TransformToCoordinateSystem(base, dirX, dirY);
-      vertices.push_back(pv);
-    }
+      FacetIndex fidx2 = it->facet1;
+      facetsCuttingEdge0.insert(fidx1);
+      facetsCuttingEdge1.insert(fidx2);
 
-    DelaunayTriangulator tria;
-    tria.SetPolygon(vertices);
-    tria.TriangulatePolygon();
+      std::pair<std::set<MeshPoint>::iterator, bool> pit0 = _cutPoints.insert(it->pt0);
+      _facet2points[0][fidx1].push_back(pit0.first);
+      _facet2points[1][fidx2].push_back(pit0.first);
 
-    std::vector<MeshFacet> facets = tria.GetFacets();
-    for (std::vector<MeshFacet>::iterator it = facets.begin(); it != facets.end(); ++it)
-    {
-      if ((it->_aulPoints[0] == it->_aulPoints[1]) ||
-          (it->_aulPoints[1] == it->_aulPoints[2]) ||
-          (it->_aulPoints[2] == it->_aulPoints[0]))
-      { // two same triangle corner points
-        continue;
-      }
-  
-      MeshGeomFacet facet(points[it->_aulPoints[0]],
-                          points[it->_aulPoints[1]],
-                          points[it->_aulPoints[2]]);
-
-      //if (side == 1)
-      // _builder.addSingleTriangle(facet._aclPoints[0], facet._aclPoints[1], facet._aclPoints[2], true, 3, 0, 1, 1);
-
-      //if (facet.Area() < 0.0001f)
-      //{ // too small facet
-      //  continue;
-      //}
-
-      float dist0 = facet._aclPoints[0].DistanceToLine
-          (facet._aclPoints[1],facet._aclPoints[1] - facet._aclPoints[2]);
-      float dist1 = facet._aclPoints[1].DistanceToLine
-          (facet._aclPoints[0],facet._aclPoints[0] - facet._aclPoints[2]);
-      float dist2 = facet._aclPoints[2].DistanceToLine
-          (facet._aclPoints[0],facet._aclPoints[0] - facet._aclPoints[1]);
-
-      if ((dist0 < _minDistanceToPoint) ||
-          (dist1 < _minDistanceToPoint) ||
-          (dist2 < _minDistanceToPoint))
+      if (!it->single)
       {
-        continue;
-      }
-
-      //dist0 = (facet._aclPoints[0] - facet._aclPoints[1]).Length();
-      //dist1 = (facet._aclPoints[1] - facet._aclPoints[2]).Length();
-      //dist2 = (facet._aclPoints[2] - facet._aclPoints[3]).Length();
-
-      //if ((dist0 < _minDistanceToPoint) || (dist1 < _minDistanceToPoint) || (dist2 < _minDistanceToPoint))
-      //{
-      //  continue;
-      //}
-
-      facet.CalcNormal();
-      if ((facet.GetNormal() * f.GetNormal()) < 0.0f)
-      { // adjust normal
-         std::swap(facet._aclPoints[0], facet._aclPoints[1]);
-         facet.CalcNormal();
+        std::pair<std::set<MeshPoint>::iterator, bool> pit1 = _cutPoints.insert(it->pt1);
+        _edges[Edge(it->pt0, it->pt1)] = EdgeInfo();
+        _facet2points[0][fidx1].push_back(pit1.first);
+        _facet2points[1][fidx2].push_back(pit1.first);
       }
+    }
+  }
+}
 
+void SetOperations::TriangulateMesh (const MeshKernel &cutMesh, int side)
+{
+  typedef std::map<FacetIndex, std::list<std::set<MeshPoint>::iterator> >::const_iterator FacetPointsIterator;
+  std::vector<FacetPointsIterator> cutFacets;
+  cutFacets.reserve(_facet2points[side].size());
+  for (FacetPointsIterator it1 = _facet2points[side].begin(); it1 != _facet2points[side].end(); ++it1)
+    cutFacets.push_back(it1);
+
+  // Triangulate the cut facets, each facet is independent of the others
+  std::vector<std::vector<MeshGeomFacet> > triangles(cutFacets.size());
+  parallel_for<std::size_t>(0, cutFacets.size(), [&](std::size_t begin, std::size_t end)
+  {
+    for (std::size_t index = begin; index < end; index++)
+      TriangulateFacet(cutMesh, cutFacets[index]->first, cutFacets[index]->second, triangles[index]);
+  });
 
+  for (std::size_t index = 0; index < cutFacets.size(); index++)
+  {
+    FacetIndex fidx = cutFacets[index]->first;
+    for (std::vector<MeshGeomFacet>::iterator it = triangles[index].begin(); it != triangles[index].end(); ++it)
+    {
+      MeshGeomFacet& facet = *it;
       int j;
       for (j = 0; j < 3; j++)
       {
@@ -417,25 +344,106 @@ void SetOperations::TriangulateMesh (const MeshKernel &cutMesh, int side)
 
         if (eit != _edges.end())
         {
-
           if (eit->second.fcounter[side] < 2)
           {
-            //if (side == 0)
-            //   _builder.addSingleTriangle(facet._aclPoints[0], facet._aclPoints[1], facet._aclPoints[2], true, 3, 0, 1, 1);
-
             eit->second.facet[side] = fidx;
             eit->second.facets[side][eit->second.fcounter[side]] = facet;
             eit->second.fcounter[side]++;
             facet.SetFlag(MeshFacet::MARKED); // set all facets connected to an edge: MARKED
-
           }
         }
       }
 
       _newMeshFacets[side].push_back(facet);
+    }
+  }
+}
+
+void SetOperations::TriangulateFacet (const MeshKernel &cutMesh, FacetIndex fidx,
+                                      const std::list<std::set<MeshPoint>::iterator>& cutPoints,
+                                      std::vector<MeshGeomFacet>& triangles) const
+{
+  std::vector<Vector3f> points;
+  std::set<MeshPoint>   pointsSet;
+
+  MeshGeomFacet f = cutMesh.GetFacet(fidx);
+
+  // facet corner points
+  int i;
+  for (i = 0; i < 3; i++)
+  {
+    pointsSet.insert(f._aclPoints[i]);
+    points.push_back(f._aclPoints[i]);
+  }
+
+  // cut points
+  std::list<std::set<MeshPoint>::iterator>::const_iterator it2;
+  for (it2 = cutPoints.begin(); it2 != cutPoints.end(); ++it2)
+  {
+    if (pointsSet.find(*(*it2)) == pointsSet.end())
+    {
+      pointsSet.insert(*(*it2));
+      points.push_back(*(*it2));
+    }
+  }
+
+  Vector3f normal = f.GetNormal();
+  Vector3f base = points[0];
+  Vector3f dirX = points[1] - points[0];
+  dirX.Normalize();
+  Vector3f dirY = dirX % normal;
+
+  // project points to 2D plane
+  std::vector<Vector3f>::iterator it;
+  std::vector<Vector3f> vertices;
+  for (it = points.begin(); it != points.end(); ++it)
+  {
+    Vector3f pv = *it;
+    pv.TransformToCoordinateSystem(base, dirX, dirY);
+    vertices.push_back(pv);
+  }
+
+  DelaunayTriangulator tria;
+  tria.SetPolygon(vertices);
+  tria.TriangulatePolygon();
 
-    } // for (i = 0; i < (out->numberoftriangles * 3); i += 3)
-  } // for (it1 = _facet2points[side].begin(); it1 != _facet2points[side].end(); ++it1)
+  std::vector<MeshFacet> facets = tria.GetFacets();
+  for (std::vector<MeshFacet>::iterator it = facets.begin(); it != facets.end(); ++it)
+  {
+    if ((it->_aulPoints[0] == it->_aulPoints[1]) ||
+        (it->_aulPoints[1] == it->_aulPoints[2]) ||
+        (it->_aulPoints[2] == it->_aulPoints[0]))
+    { // two same triangle corner points
+      continue;
+    }
+
+    MeshGeomFacet facet(points[it->_aulPoints[0]],
+                        points[it->_aulPoints[1]],
+                        points[it->_aulPoints[2]]);
+
+    float dist0 = facet._aclPoints[0].DistanceToLine
+        (facet._aclPoints[1],facet._aclPoints[1] - facet._aclPoints[2]);
+    float dist1 = facet._aclPoints[1].DistanceToLine
+        (facet._aclPoints[0],facet._aclPoints[0] - facet._aclPoints[2]);
+    float dist2 = facet._aclPoints[2].DistanceToLine
+        (facet._aclPoints[0],facet._aclPoints[0] - facet._aclPoints[1]);
+
+    if ((dist0 < _minDistanceToPoint) ||
+        (dist1 < _minDistanceToPoint) ||
+        (dist2 < _minDistanceToPoint))
+    {
+      continue;
+    }
+
+    facet.CalcNormal();
+    if ((facet.GetNormal() * f.GetNormal()) < 0.0f)
+    { // adjust normal
+       std::swap(facet._aclPoints[0], facet._aclPoints[1]);
+       facet.CalcNormal();
+    }
+
+    triangles.push_back(facet);
+  }
 }
 
 void SetOperations::CollectFacets (int side, float mult)
@@ -174,6 +174,10 @@ private:
   void Cut (std::set<FacetIndex>& facetsNotCuttingEdge0, std::set<FacetIndex>& facetsCuttingEdge1);
   /** Trianglute each facets cut with its cutting points */
   void TriangulateMesh (const MeshKernel &cutMesh, int side);
+  /** Trianglute a single facet with its cutting points */
+  void TriangulateFacet (const MeshKernel &cutMesh, FacetIndex fidx,
+                         const std::list<std::set<MeshPoint>::iterator>& cutPoints,
+                         std::vector<MeshGeomFacet>& triangles) const;
   /** search facets for adding (with region growing) */
   void CollectFacets (int side, float mult);
   /** close gap in the mesh */
@@ -23,14 +23,15 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
 #endif
 
 #include "Smoothing.h"
 #include "MeshKernel.h"
-#include "Algorithm.h"
 #include "Elements.h"
-#include "Iterator.h"
 #include "Approximation.h"
+#include "Functional.h"
 
 
 using namespace MeshCore;
@@ -41,6 +42,7 @@ AbstractSmoothing::AbstractSmoothing(MeshKernel& m)
   , tolerance(0)
   , component(Normal)
   , continuity(C0)
+  , threads(0)
 {
 }
 
@@ -54,6 +56,73 @@ void AbstractSmoothing::initialize(Component comp, Continuity cont)
     this->continuity = cont;
 }
 
+void AbstractSmoothing::Neighbourhood::Build(const MeshKernel& kernel, int threads)
+{
+    const MeshFacetArray& facets = kernel.GetFacets();
+    const std::size_t numPoints = kernel.CountPoints();
+
+    // each facet adds two neighbours to each of its points
+    std::vector<std::size_t> valence(numPoints, 0);
+    for (const auto& face : facets) {
+        for (int i = 0; i < 3; i++)
+            valence[face._aulPoints[i]]++;
+    }
+
+    std::vector<std::size_t> slots(numPoints + 1, 0);
+    for (std::size_t i = 0; i < numPoints; i++)
+        slots[i+1] = slots[i] + 2 * valence[i];
+
+    std::vector<PointIndex> ring(slots[numPoints]);
+    std::vector<std::size_t> fill(slots.begin(), slots.end() - 1);
+    for (const auto& face : facets) {
+        for (int i = 0; i < 3; i++) {
+            PointIndex p = face._aulPoints[i];
+            ring[fill[p]++] = face._aulPoints[(i+1)%3];
+            ring[fill[p]++] = face._aulPoints[(i+2)%3];
+        }
+    }
+
+    // sort the neighbours and remove the duplicates of each point
+    std::vector<std::size_t> count(numPoints);
+    parallel_for<std::size_t>(0, numPoints, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            auto beg = ring.begin() + slots[i];
+            auto end = ring.begin() + slots[i+1];
+            std::sort(beg, end);
+            count[i] = std::unique(beg, end) - beg;
+        }
+    }, threads);
+
+    // an inner point of a manifold has as many neighbours as facets
+    offsets.resize(numPoints + 1);
+    border.resize(numPoints);
+    offsets[0] = 0;
+    for (std::size_t i = 0; i < numPoints; i++) {
+        offsets[i+1] = offsets[i] + count[i];
+        border[i] = count[i] != valence[i] ? 1 : 0;
+    }
+
+    // the compacted range of a point never lies behind its original range
+    for (std::size_t i = 0; i < numPoints; i++) {
+        if (offsets[i] != slots[i])
+            std::copy(ring.begin() + slots[i], ring.begin() + slots[i] + count[i], ring.begin() + offsets[i]);
+    }
+
+    ring.resize(offsets[numPoints]);
+    ring.shrink_to_fit();
+    points.swap(ring);
+}
+
+void AbstractSmoothing::CopyPoints(std::vector<Base::Vector3f>& buffer) const
+{
+    const MeshPointArray& points = kernel.GetPoints();
+    buffer.resize(points.size());
+    parallel_for<std::size_t>(0, points.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++)
+            buffer[i] = points[i];
+    }, threads);
+}
+
 PlaneFitSmoothing::PlaneFitSmoothing(MeshKernel& m)
   : AbstractSmoothing(m)
 {
@@ -63,110 +132,79 @@ PlaneFitSmoothing::~PlaneFitSmoothing()
 {
 }
 
-void PlaneFitSmoothing::Smooth(unsigned int iterations)
+Base::Vector3f PlaneFitSmoothing::Fit(const Neighbourhood& nb, const std::vector<Base::Vector3f>& points,
+                                      PointIndex pos) const
 {
-    MeshCore::MeshPoint center;
-    MeshCore::MeshPointArray PointArray = kernel.GetPoints();
+    const Base::Vector3f& v = points[pos];
+    std::size_t n_count = nb.Count(pos);
+    if (n_count < 3)
+        return v;
+
+    MeshCore::PlaneFit pf;
+    pf.AddPoint(v);
+    Base::Vector3f center = v;
+    for (std::size_t i = nb.offsets[pos]; i < nb.offsets[pos+1]; i++) {
+        const Base::Vector3f& p = points[nb.points[i]];
+        pf.AddPoint(p);
+        center += p;
+    }
 
-    MeshCore::MeshPointIterator v_it(kernel);
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshPointArray::_TConstIterator v_beg = kernel.GetPoints().begin();
+    float scale = 1.0f/(static_cast<float>(n_count)+1.0f);
+    center.Scale(scale,scale,scale);
 
-    for (unsigned int i=0; i<iterations; i++) {
-        Base::Vector3f N, L;
-        for (v_it.Begin(); v_it.More(); v_it.Next()) {
-            MeshCore::PlaneFit pf;
-            pf.AddPoint(*v_it);
-            center = *v_it;
-            const std::set<PointIndex>& cv = vv_it[v_it.Position()];
-            if (cv.size() < 3)
-                continue;
-
-            std::set<PointIndex>::const_iterator cv_it;
-            for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
-                pf.AddPoint(v_beg[*cv_it]);
-                center += v_beg[*cv_it];
-            }
+    // get the mean plane of the current vertex with the surrounding vertices
+    pf.Fit();
+    Base::Vector3f N = pf.GetNormal();
+    N.Normalize();
 
-            float scale = 1.0f/(static_cast<float>(cv.size())+1.0f);
-            center.Scale(scale,scale,scale);
+    // look in which direction we should move the vertex
+    Base::Vector3f L(v.x - center.x, v.y - center.y, v.z - center.z);
+    if (N*L < 0.0f)
+        N.Scale(-1.0, -1.0, -1.0);
 
-            // get the mean plane of the current vertex with the surrounding vertices
-            pf.Fit();
-            N = pf.GetNormal();
-            N.Normalize();
+    // maximum value to move is distance to mean plane
+    float d = std::min<float>(fabs(this->tolerance),fabs(N*L));
+    N.Scale(d,d,d);
 
-            // look in which direction we should move the vertex
-            L.Set(v_it->x - center.x, v_it->y - center.y, v_it->z - center.z);
-            if (N*L < 0.0f)
-                N.Scale(-1.0, -1.0, -1.0);
-
-            // maximum value to move is distance to mean plane
-            float d = std::min<float>(fabs(this->tolerance),fabs(N*L));
-            N.Scale(d,d,d);
+    return Base::Vector3f(v.x - N.x, v.y - N.y, v.z - N.z);
+}
 
-            PointArray[v_it.Position()].Set(v_it->x - N.x, v_it->y - N.y, v_it->z - N.z);
-        }
+void PlaneFitSmoothing::Smooth(unsigned int iterations)
+{
+    Neighbourhood nb;
+    nb.Build(kernel, threads);
 
-        // assign values without affecting iterators
-        PointIndex count = kernel.CountPoints();
-        for (PointIndex idx = 0; idx < count; idx++) {
-            kernel.SetPoint(idx, PointArray[idx]);
-        }
+    // the new positions are computed from the points of the previous iteration
+    std::vector<Base::Vector3f> buffer;
+    for (unsigned int i=0; i<iterations; i++) {
+        CopyPoints(buffer);
+        parallel_for<PointIndex>(0, buffer.size(), [&](PointIndex first, PointIndex last) {
+            for (PointIndex pos = first; pos < last; pos++) {
+                Base::Vector3f v = Fit(nb, buffer, pos);
+                kernel.SetPoint(pos, v.x, v.y, v.z);
+            }
+        }, threads);
     }
 }
 
 void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<PointIndex>& point_indices)
 {
-    MeshCore::MeshPoint center;
-    MeshCore::MeshPointArray PointArray = kernel.GetPoints();
+    Neighbourhood nb;
+    nb.Build(kernel, threads);
 
-    MeshCore::MeshPointIterator v_it(kernel);
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshPointArray::_TConstIterator v_beg = kernel.GetPoints().begin();
+    std::vector<PointIndex> indices(point_indices);
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
 
+    std::vector<Base::Vector3f> buffer;
     for (unsigned int i=0; i<iterations; i++) {
-        Base::Vector3f N, L;
-        for (std::vector<PointIndex>::const_iterator it = point_indices.begin(); it != point_indices.end(); ++it) {
-            v_it.Set(*it);
-            MeshCore::PlaneFit pf;
-            pf.AddPoint(*v_it);
-            center = *v_it;
-            const std::set<PointIndex>& cv = vv_it[v_it.Position()];
-            if (cv.size() < 3)
-                continue;
-
-            std::set<PointIndex>::const_iterator cv_it;
-            for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
-                pf.AddPoint(v_beg[*cv_it]);
-                center += v_beg[*cv_it];
+        CopyPoints(buffer);
+        parallel_for<std::size_t>(0, indices.size(), [&](std::size_t first, std::size_t last) {
+            for (std::size_t j = first; j < last; j++) {
+                Base::Vector3f v = Fit(nb, buffer, indices[j]);
+                kernel.SetPoint(indices[j], v.x, v.y, v.z);
             }
-
-            float scale = 1.0f/(static_cast<float>(cv.size())+1.0f);
-            center.Scale(scale,scale,scale);
-
-            // get the mean plane of the current vertex with the surrounding vertices
-            pf.Fit();
-            N = pf.GetNormal();
-            N.Normalize();
-
-            // look in which direction we should move the vertex
-            L.Set(v_it->x - center.x, v_it->y - center.y, v_it->z - center.z);
-            if (N*L < 0.0f)
-                N.Scale(-1.0, -1.0, -1.0);
-
-            // maximum value to move is distance to mean plane
-            float d = std::min<float>(fabs(this->tolerance),fabs(N*L));
-            N.Scale(d,d,d);
-
-            PointArray[v_it.Position()].Set(v_it->x - N.x, v_it->y - N.y, v_it->z - N.z);
-        }
-
-        // assign values without affecting iterators
-        PointIndex count = kernel.CountPoints();
-        for (PointIndex idx = 0; idx < count; idx++) {
-            kernel.SetPoint(idx, PointArray[idx]);
-        }
+        }, threads);
     }
 }
 
@@ -179,94 +217,88 @@ LaplaceSmoothing::~LaplaceSmoothing()
 {
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize)
+Base::Vector3f LaplaceSmoothing::Umbrella(const Neighbourhood& nb, double stepsize,
+                                          const std::vector<Base::Vector3f>& buffer,
+                                          PointIndex pos) const
 {
-    const MeshCore::MeshPointArray& points = kernel.GetPoints();
-    MeshCore::MeshPointArray::_TConstIterator v_it,
-    v_beg = points.begin(), v_end = points.end();
-
-    PointIndex pos = 0;
-    for (v_it = points.begin(); v_it != v_end; ++v_it,++pos) {
-        const std::set<PointIndex>& cv = vv_it[pos];
-        if (cv.size() < 3)
-            continue;
-        if (cv.size() != vf_it[pos].size()) {
-            // do nothing for border points
-            continue;
-        }
-
-        size_t n_count = cv.size();
-        double w;
-        w=1.0/double(n_count);
-
-        double delx=0.0,dely=0.0,delz=0.0;
-        std::set<PointIndex>::const_iterator cv_it;
-        for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
-            delx += w*static_cast<double>((v_beg[*cv_it]).x-v_it->x);
-            dely += w*static_cast<double>((v_beg[*cv_it]).y-v_it->y);
-            delz += w*static_cast<double>((v_beg[*cv_it]).z-v_it->z);
-        }
+    const Base::Vector3f& v = buffer[pos];
+    std::size_t n_count = nb.Count(pos);
+    if (n_count < 3)
+        return v;
+    if (nb.border[pos]) {
+        // do nothing for border points
+        return v;
+    }
 
-        float x = static_cast<float>(static_cast<double>(v_it->x)+stepsize*delx);
-        float y = static_cast<float>(static_cast<double>(v_it->y)+stepsize*dely);
-        float z = static_cast<float>(static_cast<double>(v_it->z)+stepsize*delz);
-        kernel.SetPoint(pos,x,y,z);
+    double w;
+    w=1.0/double(n_count);
+
+    double delx=0.0,dely=0.0,delz=0.0;
+    const PointIndex* cv_it = nb.points.data() + nb.offsets[pos];
+    const PointIndex* cv_end = nb.points.data() + nb.offsets[pos+1];
+    for (; cv_it != cv_end; ++cv_it) {
+        const Base::Vector3f& p = buffer[*cv_it];
+        delx += w*static_cast<double>(p.x-v.x);
+        dely += w*static_cast<double>(p.y-v.y);
+        delz += w*static_cast<double>(p.z-v.z);
     }
+
+    float x = static_cast<float>(static_cast<double>(v.x)+stepsize*delx);
+    float y = static_cast<float>(static_cast<double>(v.y)+stepsize*dely);
+    float z = static_cast<float>(static_cast<double>(v.z)+stepsize*delz);
+    return Base::Vector3f(x,y,z);
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize,
-                                const std::vector<PointIndex>& point_indices)
+void LaplaceSmoothing::Umbrella(const Neighbourhood& nb, double stepsize,
+                                std::vector<Base::Vector3f>& buffer)
 {
-    const MeshCore::MeshPointArray& points = kernel.GetPoints();
-    MeshCore::MeshPointArray::_TConstIterator v_beg = points.begin();
-
-    for (std::vector<PointIndex>::const_iterator pos = point_indices.begin(); pos != point_indices.end(); ++pos) {
-        const std::set<PointIndex>& cv = vv_it[*pos];
-        if (cv.size() < 3)
-            continue;
-        if (cv.size() != vf_it[*pos].size()) {
-            // do nothing for border points
-            continue;
+    CopyPoints(buffer);
+    parallel_for<PointIndex>(0, buffer.size(), [&](PointIndex first, PointIndex last) {
+        for (PointIndex pos = first; pos < last; pos++) {
+            Base::Vector3f v = Umbrella(nb, stepsize, buffer, pos);
+            kernel.SetPoint(pos, v.x, v.y, v.z);
         }
+    }, threads);
+}
 
-        size_t n_count = cv.size();
-        double w;
-        w=1.0/double(n_count);
-
-        double delx=0.0,dely=0.0,delz=0.0;
-        std::set<PointIndex>::const_iterator cv_it;
-        for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
-            delx += w*static_cast<double>((v_beg[*cv_it]).x-(v_beg[*pos]).x);
-            dely += w*static_cast<double>((v_beg[*cv_it]).y-(v_beg[*pos]).y);
-            delz += w*static_cast<double>((v_beg[*cv_it]).z-(v_beg[*pos]).z);
+void LaplaceSmoothing::Umbrella(const Neighbourhood& nb, double stepsize,
+                                std::vector<Base::Vector3f>& buffer,
+                                const std::vector<PointIndex>& point_indices)
+{
+    CopyPoints(buffer);
+    parallel_for<std::size_t>(0, point_indices.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            PointIndex pos = point_indices[i];
+            Base::Vector3f v = Umbrella(nb, stepsize, buffer, pos);
+            kernel.SetPoint(pos, v.x, v.y, v.z);
         }
-
-        float x = static_cast<float>(static_cast<double>((v_beg[*pos]).x)+stepsize*delx);
-        float y = static_cast<float>(static_cast<double>((v_beg[*pos]).y)+stepsize*dely);
-        float z = static_cast<float>(static_cast<double>((v_beg[*pos]).z)+stepsize*delz);
-        kernel.SetPoint(*pos,x,y,z);
-    }
+    }, threads);
 }
 
 void LaplaceSmoothing::Smooth(unsigned int iterations)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    Neighbourhood nb;
+    nb.Build(kernel, threads);
 
+    std::vector<Base::Vector3f> buffer;
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda);
+        Umbrella(nb, lambda, buffer);
     }
 }
 
 void LaplaceSmoothing::SmoothPoints(unsigned int iterations, const std::vector<PointIndex>& point_indices)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    Neighbourhood nb;
+    nb.Build(kernel, threads);
+
+    // a point must only be written by one thread
+    std::vector<PointIndex> indices(point_indices);
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
 
+    std::vector<Base::Vector3f> buffer;
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda, point_indices);
+        Umbrella(nb, lambda, buffer, indices);
     }
 }
 
@@ -281,26 +313,32 @@ TaubinSmoothing::~TaubinSmoothing()
 
 void TaubinSmoothing::Smooth(unsigned int iterations)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    Neighbourhood nb;
+    nb.Build(kernel, threads);
 
     // Theoretically Taubin does not shrink the surface
+    std::vector<Base::Vector3f> buffer;
     iterations = (iterations+1)/2; // two steps per iteration
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda);
-        Umbrella(vv_it, vf_it, -(lambda+micro));
+        Umbrella(nb, lambda, buffer);
+        Umbrella(nb, -(lambda+micro), buffer);
     }
 }
 
 void TaubinSmoothing::SmoothPoints(unsigned int iterations, const std::vector<PointIndex>& point_indices)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    Neighbourhood nb;
+    nb.Build(kernel, threads);
+
+    std::vector<PointIndex> indices(point_indices);
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
 
     // Theoretically Taubin does not shrink the surface
+    std::vector<Base::Vector3f> buffer;
     iterations = (iterations+1)/2; // two steps per iteration
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda, point_indices);
-        Umbrella(vv_it, vf_it, -(lambda+micro), point_indices);
+        Umbrella(nb, lambda, buffer, indices);
+        Umbrella(nb, -(lambda+micro), buffer, indices);
     }
 }
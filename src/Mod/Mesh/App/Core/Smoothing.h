@@ -25,13 +25,12 @@
 #define MESH_SMOOTHING_H
 
 #include <vector>
+#include <Base/Vector3D.h>
 #include "Definitions.h"
 
 namespace MeshCore
 {
 class MeshKernel;
-class MeshRefPointToPoints;
-class MeshRefPointToFacets;
 
 /** Base class for smoothing algorithms. */
 class MeshExport AbstractSmoothing
@@ -53,16 +52,39 @@ public:
     virtual ~AbstractSmoothing();
     void initialize(Component comp, Continuity cont);
 
+    /** Sets the number of threads, a value < 1 uses all available cores. */
+    void SetThreads(int t) { threads = t; }
+
     /** Smooth the triangle mesh. */
     virtual void Smooth(unsigned int) = 0;
     virtual void SmoothPoints(unsigned int, const std::vector<PointIndex>&) = 0;
 
+protected:
+    /** The neighbour points of all mesh points stored in flat arrays.
+     * The neighbours of point i are points[offsets[i]] ... points[offsets[i+1]-1]
+     * in ascending order.
+     */
+    struct Neighbourhood {
+        std::vector<std::size_t> offsets;
+        std::vector<PointIndex> points;
+        /// 1 for points with an open edge or a non-manifold ring, 0 otherwise
+        std::vector<unsigned char> border;
+
+        void Build(const MeshKernel&, int threads);
+        std::size_t Count(PointIndex p) const
+        { return offsets[p+1] - offsets[p]; }
+    };
+
+    /** Copies the points of the kernel to \a buffer. */
+    void CopyPoints(std::vector<Base::Vector3f>& buffer) const;
+
 protected:
     MeshKernel& kernel;
 
     float tolerance;
     Component   component;
     Continuity  continuity;
+    int threads;
 };
 
 class MeshExport PlaneFitSmoothing : public AbstractSmoothing
@@ -72,6 +94,10 @@ public:
     virtual ~PlaneFitSmoothing();
     void Smooth(unsigned int);
     void SmoothPoints(unsigned int, const std::vector<PointIndex>&);
+
+private:
+    Base::Vector3f Fit(const Neighbourhood&, const std::vector<Base::Vector3f>&,
+                       PointIndex) const;
 };
 
 class MeshExport LaplaceSmoothing : public AbstractSmoothing
@@ -84,11 +110,17 @@ public:
     void SetLambda(double l) { lambda = l;}
 
 protected:
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double);
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double,
+    /** Moves each inner point by \a stepsize towards the centre of its neighbours.
+     * All points are computed from the positions of the previous step which are kept
+     * in \a buffer, so the points can be processed in parallel.
+     */
+    void Umbrella(const Neighbourhood&, double stepsize,
+                  std::vector<Base::Vector3f>& buffer);
+    void Umbrella(const Neighbourhood&, double stepsize,
+                  std::vector<Base::Vector3f>& buffer,
                   const std::vector<PointIndex>&);
+    Base::Vector3f Umbrella(const Neighbourhood&, double stepsize,
+                            const std::vector<Base::Vector3f>& buffer, PointIndex) const;
 
 protected:
     double lambda;
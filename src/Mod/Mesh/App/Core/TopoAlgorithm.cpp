@@ -37,6 +37,7 @@
 #include "MeshKernel.h"
 #include "Algorithm.h"
 #include "Evaluation.h"
+#include "HalfEdge.h"
 #include "Triangulation.h"
 #include "Definitions.h"
 #include <Base/Console.h>
@@ -1507,9 +1508,16 @@ void MeshTopoAlgorithm::FillupHoles(unsigned long length, int level,
                                     std::list<std::vector<PointIndex> >& aFailed)
 {
     // get the mesh boundaries as an array of point indices
+    // The half-edge structure finds all boundaries in linear time. For meshes with
+    // non-manifold edges the boundary edges must be chained together.
     std::list<std::vector<PointIndex> > aBorders, aFillBorders;
     MeshAlgorithm cAlgo(_rclMesh);
-    cAlgo.GetMeshBorders(aBorders);
+    MeshHalfEdgeKernel cHalfEdges;
+    cHalfEdges.Build(_rclMesh);
+    if (cHalfEdges.CountNonManifoldEdges() == 0)
+        cHalfEdges.GetBoundaries(aBorders);
+    else
+        cAlgo.GetMeshBorders(aBorders);
 
     // split boundary loops if needed
     cAlgo.SplitBoundaryLoops(aBorders);
@@ -40,6 +40,7 @@
 #include <Base/Tools.h>
 #include <Base/ViewProj.h>
 
+#include "Core/Analysis.h"
 #include "Core/Builder.h"
 #include "Core/MeshKernel.h"
 #include "Core/Grid.h"
@@ -1016,14 +1017,26 @@ void MeshObject::smooth(int iterations, float d_max)
 
 void MeshObject::decimate(float fTolerance, float fReduction)
 {
-    MeshCore::MeshSimplify dm(this->_kernel);
-    dm.simplify(fTolerance, fReduction);
+    MeshCore::MeshDecimation dm(this->_kernel);
+    dm.SetMaxError(fTolerance);
+    dm.Reduce(fReduction);
 }
 
 void MeshObject::decimate(int targetSize)
 {
-    MeshCore::MeshSimplify dm(this->_kernel);
-    dm.simplify(targetSize);
+    MeshCore::MeshDecimation dm(this->_kernel);
+    dm.Decimate(static_cast<std::size_t>(std::max(targetSize, 0)));
+}
+
+void MeshObject::decimate(int targetSize, float fTolerance, bool preserveBoundary,
+                          float featureAngle, std::size_t memoryBudget)
+{
+    MeshCore::MeshDecimation dm(this->_kernel);
+    dm.SetMaxError(fTolerance);
+    dm.SetPreserveBoundary(preserveBoundary);
+    dm.SetFeatureAngle(featureAngle);
+    dm.SetMemoryBudget(memoryBudget);
+    dm.Decimate(static_cast<std::size_t>(std::max(targetSize, 0)));
 }
 
 Base::Vector3d MeshObject::getPointNormal(PointIndex index) const
@@ -1578,6 +1591,25 @@ void MeshObject::validateIndices()
         this->_segments.clear();
 }
 
+MeshCore::MeshReport MeshObject::evaluate(int checks) const
+{
+    MeshCore::MeshAnalysis eval(_kernel);
+    eval.SetChecks(checks);
+    return eval.Evaluate();
+}
+
+MeshCore::MeshReport MeshObject::repair(int checks, float fEps)
+{
+    unsigned long count = _kernel.CountFacets();
+    MeshCore::MeshRepair fix(_kernel);
+    fix.SetChecks(checks);
+    fix.SetEpsilon(fEps);
+    MeshCore::MeshReport report = fix.Fixup();
+    if (_kernel.CountFacets() < count)
+        this->_segments.clear();
+    return report;
+}
+
 bool MeshObject::hasInvalidNeighbourhood() const
 {
     MeshCore::MeshEvalNeighbourhood eval(_kernel);
@@ -37,6 +37,7 @@
 #include <App/PropertyGeo.h>
 #include <App/ComplexGeoData.h>
 
+#include "Core/Analysis.h"
 #include "Core/MeshKernel.h"
 #include "Core/MeshIO.h"
 #include "Core/Iterator.h"
@@ -234,6 +235,16 @@ public:
     void smooth(int iterations, float d_max);
     void decimate(float fTolerance, float fReduction);
     void decimate(int targetSize);
+    /**
+     * Decimates the mesh with the quadric edge-collapse algorithm until it has at most
+     * \a targetSize facets or no edge with an error below \a fTolerance is left.
+     * If \a preserveBoundary is true boundary vertices are kept. Edges with a dihedral angle
+     * above \a featureAngle (in radians) are kept as feature lines, 0 disables this.
+     * If the decimation would need more than \a memoryBudget bytes a Base::MemoryException
+     * is thrown, 0 means no limit.
+     */
+    void decimate(int targetSize, float fTolerance, bool preserveBoundary,
+                  float featureAngle, std::size_t memoryBudget);
     Base::Vector3d getPointNormal(PointIndex) const;
     std::vector<Base::Vector3d> getPointNormals() const;
     void crossSections(const std::vector<TPlane>&, std::vector<TPolylines> &sections,
@@ -316,6 +327,10 @@ public:
     void mergeFacets();
     bool hasPointsOnEdge() const;
     void removePointsOnEdge(bool fillBoundary);
+    /// Runs the checks given as combination of MeshCore::MeshAnalysis::Check in one pass.
+    MeshCore::MeshReport evaluate(int checks) const;
+    /// Repairs the defects of the given checks and returns the defects found before.
+    MeshCore::MeshReport repair(int checks, float fEps);
     //@}
 
     /** @name Mesh segments */
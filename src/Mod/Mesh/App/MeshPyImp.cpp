@@ -1037,6 +1037,70 @@ PyObject*  MeshPy::hasCorruptedFacets(PyObject *args)
     return Py_BuildValue("O", (ok ? Py_True : Py_False));
 }
 
+namespace {
+Py::Dict reportToDict(const MeshCore::MeshReport& report)
+{
+    auto toList = [](const std::vector<FacetIndex>& indices) {
+        Py::List list;
+        for (auto it : indices)
+            list.append(Py::Long(it));
+        return list;
+    };
+    auto toPairs = [](const std::vector<std::pair<FacetIndex, FacetIndex> >& indices) {
+        Py::List list;
+        for (const auto& it : indices) {
+            Py::Tuple pair(2);
+            pair.setItem(0, Py::Long(it.first));
+            pair.setItem(1, Py::Long(it.second));
+            list.append(pair);
+        }
+        return list;
+    };
+
+    Py::Dict dict;
+    dict.setItem("FacetsOutOfRange", toList(report.facetsOutOfRange));
+    dict.setItem("CorruptedFacets", toList(report.corruptedFacets));
+    dict.setItem("InvalidNeighbourhood", Py::Boolean(report.invalidNeighbourhood));
+    dict.setItem("InvalidPoints", toList(report.invalidPoints));
+    dict.setItem("DuplicatedPoints", toList(report.duplicatedPoints));
+    dict.setItem("DuplicatedFacets", toList(report.duplicatedFacets));
+    dict.setItem("DegeneratedFacets", toList(report.degeneratedFacets));
+    dict.setItem("NonManifoldEdges", toPairs(report.nonManifoldEdges));
+    dict.setItem("NonUniformOrientedFacets", toList(report.nonUniformOrientedFacets));
+    dict.setItem("SelfIntersections", toPairs(report.selfIntersections));
+    dict.setItem("OpenEdges", Py::Long(static_cast<unsigned long>(report.openEdges)));
+    dict.setItem("Valid", Py::Boolean(report.IsValid()));
+    return dict;
+}
+}
+
+PyObject*  MeshPy::evaluate(PyObject *args, PyObject *kwds)
+{
+    int checks = MeshCore::MeshAnalysis::All;
+    static char* keywords_evaluate[] = {"Checks", nullptr};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|i", keywords_evaluate, &checks))
+        return nullptr;
+
+    PY_TRY {
+        MeshCore::MeshReport report = getMeshObjectPtr()->evaluate(checks);
+        return Py::new_reference_to(reportToDict(report));
+    } PY_CATCH;
+}
+
+PyObject*  MeshPy::repair(PyObject *args, PyObject *kwds)
+{
+    int checks = MeshCore::MeshAnalysis::All;
+    float fEpsilon = MeshCore::MeshDefinitions::_fMinPointDistanceP2;
+    static char* keywords_repair[] = {"Checks", "Epsilon", nullptr};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|if", keywords_repair, &checks, &fEpsilon))
+        return nullptr;
+
+    PY_TRY {
+        MeshCore::MeshReport report = getMeshObjectPtr()->repair(checks, fEpsilon);
+        return Py::new_reference_to(reportToDict(report));
+    } PY_CATCH;
+}
+
 PyObject*  MeshPy::removeNonManifolds(PyObject *args)
 {
     if (!PyArg_ParseTuple(args, ""))
@@ -1788,9 +1852,10 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
     int iter=1;
     double lambda = 0;
     double micro = 0;
-    static char* keywords_smooth[] = {"Method","Iteration","Lambda","Micro",nullptr};
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|sidd",keywords_smooth,
-                                     &method, &iter, &lambda, &micro))
+    int threads = 0;
+    static char* keywords_smooth[] = {"Method","Iteration","Lambda","Micro","Threads",nullptr};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|siddi",keywords_smooth,
+                                     &method, &iter, &lambda, &micro, &threads))
         return nullptr;
 
     PY_TRY {
@@ -1798,12 +1863,14 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
         MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
         if (strcmp(method, "Laplace") == 0) {
             MeshCore::LaplaceSmoothing smooth(kernel);
+            smooth.SetThreads(threads);
             if (lambda > 0)
                 smooth.SetLambda(lambda);
             smooth.Smooth(iter);
         }
         else if (strcmp(method, "Taubin") == 0) {
             MeshCore::TaubinSmoothing smooth(kernel);
+            smooth.SetThreads(threads);
             if (lambda > 0)
                 smooth.SetLambda(lambda);
             if (micro > 0)
@@ -1812,6 +1879,7 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
         }
         else if (strcmp(method, "PlaneFit") == 0) {
             MeshCore::PlaneFitSmoothing smooth(kernel);
+            smooth.SetThreads(threads);
             smooth.Smooth(iter);
         }
         else {
@@ -1822,10 +1890,10 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
     Py_Return;
 }
 
-PyObject*  MeshPy::decimate(PyObject *args)
+PyObject*  MeshPy::decimate(PyObject *args, PyObject *kwds)
 {
     float fTol, fRed;
-    if (PyArg_ParseTuple(args, "ff", &fTol,&fRed)) {
+    if (!kwds && PyArg_ParseTuple(args, "ff", &fTol,&fRed)) {
         PY_TRY {
             getMeshObjectPtr()->decimate(fTol, fRed);
         } PY_CATCH;
@@ -1835,7 +1903,7 @@ PyObject*  MeshPy::decimate(PyObject *args)
 
     PyErr_Clear();
     int targetSize;
-    if (PyArg_ParseTuple(args, "i", &targetSize)) {
+    if (!kwds && PyArg_ParseTuple(args, "i", &targetSize)) {
         PY_TRY {
             getMeshObjectPtr()->decimate(targetSize);
         } PY_CATCH;
@@ -1843,7 +1911,39 @@ PyObject*  MeshPy::decimate(PyObject *args)
         Py_Return;
     }
 
-    PyErr_SetString(PyExc_ValueError, "decimate(tolerance=float, reduction=float) or decimate(targetSize=int)");
+    PyErr_Clear();
+    targetSize = 0;
+    float reduction = 0.0f;
+    float maxError = FLT_MAX;
+    PyObject* boundary = Py_False;
+    float featureAngle = 0.0f;
+    unsigned long long memoryBudget = 0;
+    static char* keywords_decimate[] = {"TargetSize","Reduction","MaxError","PreserveBoundary",
+                                        "FeatureAngle","MemoryBudget",nullptr};
+    if (PyArg_ParseTupleAndKeywords(args, kwds, "|iffO!fK", keywords_decimate,
+                                    &targetSize, &reduction, &maxError, &PyBool_Type, &boundary,
+                                    &featureAngle, &memoryBudget)) {
+        if (targetSize <= 0 && reduction <= 0.0f) {
+            PyErr_SetString(PyExc_ValueError, "Either TargetSize or Reduction must be greater than zero");
+            return nullptr;
+        }
+
+        PY_TRY {
+            if (targetSize <= 0 && reduction > 0.0f) {
+                reduction = std::min(1.0f, reduction);
+                targetSize = static_cast<int>(static_cast<float>(getMeshObjectPtr()->countFacets()) * (1.0f - reduction));
+            }
+            getMeshObjectPtr()->decimate(targetSize, maxError, PyObject_IsTrue(boundary) ? true : false,
+                                         Base::toRadians<float>(featureAngle),
+                                         static_cast<std::size_t>(memoryBudget));
+        } PY_CATCH;
+
+        Py_Return;
+    }
+
+    PyErr_SetString(PyExc_ValueError, "decimate(tolerance=float, reduction=float), decimate(targetSize=int) or "
+                                      "decimate([TargetSize=int, Reduction=float, MaxError=float, "
+                                      "PreserveBoundary=bool, FeatureAngle=float, MemoryBudget=int])");
     return nullptr;
 }
 
@@ -596,6 +596,130 @@ class NastranReader(unittest.TestCase):
     def tearDown(self):
         pass
 
+class MeshDecimation(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0, 50)
+
+    def testTargetSize(self):
+        self.mesh.decimate(500)
+        self.assertLessEqual(self.mesh.CountFacets, 500)
+        self.assertTrue(self.mesh.isSolid())
+        self.assertFalse(self.mesh.hasNonManifolds())
+
+    def testReduction(self):
+        count = self.mesh.CountFacets
+        self.mesh.decimate(Reduction=0.5)
+        self.assertLessEqual(self.mesh.CountFacets, count // 2 + 1)
+        self.assertTrue(self.mesh.isSolid())
+
+    def testPreserveBoundary(self):
+        mesh = Mesh.Mesh()
+        for x in range(10):
+            for y in range(10):
+                mesh.addFacet(x, y, 0, x + 1, y, 0, x + 1, y + 1, 0)
+                mesh.addFacet(x, y, 0, x + 1, y + 1, 0, x, y + 1, 0)
+        mesh.decimate(Reduction=1.0, PreserveBoundary=True)
+        self.assertEqual(mesh.CountFacets, 40)
+        self.assertEqual(mesh.CountPoints, 41)
+
+    def testMemoryBudget(self):
+        count = self.mesh.CountFacets
+        with self.assertRaises(MemoryError):
+            self.mesh.decimate(TargetSize=100, MemoryBudget=1000)
+        self.assertEqual(self.mesh.CountFacets, count)
+
+    def testMissingTarget(self):
+        count = self.mesh.CountFacets
+        with self.assertRaises(ValueError):
+            self.mesh.decimate()
+        with self.assertRaises(ValueError):
+            self.mesh.decimate(TargetSize=0, Reduction=0.0, MaxError=0.1)
+        self.assertEqual(self.mesh.CountFacets, count)
+
+    def tearDown(self):
+        pass
+
+class MeshSmoothing(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(1.0, 30)
+
+    def testLaplace(self):
+        volume = self.mesh.Volume
+        self.mesh.smooth("Laplace", 5)
+        self.assertLess(self.mesh.Volume, volume)
+
+    def testThreads(self):
+        # the points are computed from the previous iteration only,
+        # so the result doesn't depend on the number of threads
+        other = self.mesh.copy()
+        self.mesh.smooth("Taubin", 10, Threads=1)
+        other.smooth("Taubin", 10, Threads=4)
+        for p, q in zip(self.mesh.Points, other.Points):
+            self.assertEqual(p.Vector, q.Vector)
+
+class MeshTopoRepair(unittest.TestCase):
+    def testFillupHoles(self):
+        mesh = Mesh.createBox(1.0, 1.0, 1.0)
+        mesh.removeFacets([0, 5])
+        self.assertFalse(mesh.isSolid())
+        mesh.fillupHoles(10)
+        self.assertEqual(mesh.CountFacets, 12)
+        self.assertTrue(mesh.isSolid())
+
+    def testFixCap(self):
+        mesh = Mesh.Mesh()
+        mesh.addFacet(0, 0, 0, 2, 0, 0, 1, 1, 0)
+        mesh.addFacet(2, 0, 0, 0, 0, 0, 1, 0, 0)
+        mesh.fixDegenerations()
+        self.assertEqual(mesh.CountFacets, 2)
+        for f in mesh.Facets:
+            self.assertGreater(f.Area, 0.0)
+            self.assertGreater(f.Normal.z, 0.0)
+
+class MeshAnalysis(unittest.TestCase):
+    def testValidMesh(self):
+        mesh = Mesh.createBox(1.0, 1.0, 1.0)
+        report = mesh.evaluate()
+        self.assertTrue(report["Valid"])
+        self.assertEqual(report["OpenEdges"], 0)
+
+    def testRepair(self):
+        points, facets = Mesh.createBox(1.0, 1.0, 1.0).Topology
+        facets.append(facets[0])
+        mesh = Mesh.Mesh()
+        mesh.addFacets((points, facets), False)
+        report = mesh.evaluate()
+        self.assertFalse(report["Valid"])
+        self.assertEqual(len(report["DuplicatedFacets"]), 1)
+        self.assertEqual(len(report["NonManifoldEdges"]), 3)
+        mesh.repair()
+        self.assertEqual(mesh.CountFacets, 12)
+        self.assertTrue(mesh.evaluate()["Valid"])
+
+class MeshSetOperations(unittest.TestCase):
+    def setUp(self):
+        self.mesh1 = Mesh.createSphere(1.0, 50)
+        self.mesh2 = Mesh.createSphere(1.0, 50)
+        self.mesh2.translate(1.0, 0.0, 0.0)
+        self.volume = self.mesh1.Volume
+
+    def testIntersect(self):
+        # volume of the lens of two unit spheres at distance 1
+        lens = math.pi * 5.0 / 12.0
+        res = self.mesh1.intersect(self.mesh2)
+        self.assertAlmostEqual(res.Volume / lens, 1.0, delta=0.03)
+
+    def testVolumes(self):
+        union = self.mesh1.unite(self.mesh2).Volume
+        inter = self.mesh1.intersect(self.mesh2).Volume
+        self.assertAlmostEqual(union + inter, 2.0 * self.volume, delta=0.01 * self.volume)
+
+    def testDisjoint(self):
+        self.mesh2.translate(2.0, 0.0, 0.0)
+        union = self.mesh1.unite(self.mesh2)
+        self.assertEqual(union.CountFacets, 2 * self.mesh1.CountFacets)
+        self.assertEqual(self.mesh1.intersect(self.mesh2).CountFacets, 0)
+
 class MeshSubElement(unittest.TestCase):
     def setUp(self):
         self.mesh = Mesh.createBox(1.0, 1.0, 1.0)
@@ -28,11 +28,20 @@
 #include <Base/Exception.h>
 #include <Base/Tools.h>
 #include <Mod/Mesh/App/Mesh.h>
+#include <Mod/Part/App/TessellationCache.h>
 #include <Mod/Part/App/TopoShape.h>
+#include <Mod/Part/App/Tools.h>
+
+#include <QtConcurrentMap>
 
 #include <TopoDS_Shape.hxx>
+#include <BRep_Tool.hxx>
 #include <BRepTools.hxx>
-#include <BRepMesh_IncrementalMesh.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <TColStd_Array1OfInteger.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
 #include <Standard_Version.hxx>
 
 #ifdef HAVE_SMESH
@@ -156,6 +165,48 @@ const double Vertex::deflection = gp::Resolution();
 
 // ----------------------------------------------------------------------------
 
+/**
+ * The triangulation of a face in global coordinates.
+ */
+struct FaceTriangulation {
+    std::vector<gp_Pnt> points;
+    std::vector<Poly_Triangle> facets;
+    /// set for the nodes on the edges of the face, only these can be shared with other faces
+    std::vector<bool> boundary;
+    /// set for the nodes that are added to the mesh by this face
+    std::vector<bool> owned;
+    std::vector<MeshCore::PointIndex> pointIndex;
+    MeshCore::MeshFacetArray meshFacets;
+
+    void read(const TopoDS_Face& face)
+    {
+        if (!Part::Tools::getTriangulation(face, points, facets))
+            return;
+
+        // The edges of neighbouring faces are discretized with the same nodes. The
+        // nodes of the polygons of the edges are the only ones that can be shared.
+        boundary.resize(points.size(), false);
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) mesh = BRep_Tool::Triangulation(face, loc);
+        for (TopExp_Explorer xp(face, TopAbs_EDGE); xp.More(); xp.Next()) {
+            Handle(Poly_PolygonOnTriangulation) poly =
+                BRep_Tool::PolygonOnTriangulation(TopoDS::Edge(xp.Current()), mesh, loc);
+            if (poly.IsNull()) {
+                // without the polygon any node may be shared
+                boundary.assign(points.size(), true);
+                return;
+            }
+
+            const TColStd_Array1OfInteger& nodes = poly->Nodes();
+            for (Standard_Integer i = nodes.Lower(); i <= nodes.Upper(); i++) {
+                std::size_t index = static_cast<std::size_t>(nodes(i) - 1);
+                if (index < boundary.size())
+                    boundary[index] = true;
+            }
+        }
+    }
+};
+
 class BrepMesh {
     bool segments;
     std::vector<uint32_t> colors;
@@ -166,108 +217,109 @@ public:
     {
     }
 
-    Mesh::MeshObject* create(const std::vector<Part::TopoShape::Domain>& domains) const
+    Mesh::MeshObject* create(const TopoDS_Shape& shape) const
     {
         std::map<uint32_t, std::vector<std::size_t> > colorMap;
         for (std::size_t i=0; i<colors.size(); i++) {
             colorMap[colors[i]].push_back(i);
         }
 
-        bool createSegm = (colors.size() == domains.size());
-
-        MeshCore::MeshFacetArray faces;
-        std::size_t numTriangles = 0;
-        for (auto it : domains)
-            numTriangles += it.facets.size();
-        faces.reserve(numTriangles);
-
-        std::set<Vertex> vertices;
-        Standard_Real x1, y1, z1;
-        Standard_Real x2, y2, z2;
-        Standard_Real x3, y3, z3;
-
-        std::vector< std::vector<MeshCore::FacetIndex> > meshSegments;
-        std::size_t numMeshFaces = 0;
-
-        for (std::size_t i = 0; i < domains.size(); ++i) {
-            std::size_t numDomainFaces = 0;
-            const Part::TopoShape::Domain& domain = domains[i];
-            for (std::size_t j = 0; j < domain.facets.size(); ++j) {
-                const Part::TopoShape::Facet& tria = domain.facets[j];
-                x1 = domain.points[tria.I1].x;
-                y1 = domain.points[tria.I1].y;
-                z1 = domain.points[tria.I1].z;
-
-                x2 = domain.points[tria.I2].x;
-                y2 = domain.points[tria.I2].y;
-                z2 = domain.points[tria.I2].z;
+        // Gather the triangulations of all faces in parallel. For a face that cannot
+        // be meshed an empty domain is kept so that the faces and colors match.
+        std::vector<TopoDS_Face> shapeFaces;
+        if (!shape.IsNull()) {
+            for (TopExp_Explorer xp(shape, TopAbs_FACE); xp.More(); xp.Next())
+                shapeFaces.push_back(TopoDS::Face(xp.Current()));
+        }
 
-                x3 = domain.points[tria.I3].x;
-                y3 = domain.points[tria.I3].y;
-                z3 = domain.points[tria.I3].z;
+        std::vector<FaceTriangulation> domains(shapeFaces.size());
+        std::vector<std::size_t> indices(shapeFaces.size());
+        std::generate(indices.begin(), indices.end(), Base::iotaGen<std::size_t>(0));
+        QtConcurrent::blockingMap(indices, [&](std::size_t index) {
+            domains[index].read(shapeFaces[index]);
+        });
 
-                std::set<Vertex>::iterator it;
-                MeshCore::MeshFacet face;
+        bool createSegm = (colors.size() == domains.size());
 
-                // 1st vertex
-                Vertex v1(x1,y1,z1);
-                it = vertices.find(v1);
-                if (it == vertices.end()) {
-                    v1.i = vertices.size();
-                    face._aulPoints[0] = v1.i;
-                    vertices.insert(v1);
-                }
-                else {
-                    face._aulPoints[0] = it->i;
+        // The interior nodes of a face are unique, only the nodes on the edges must
+        // be merged with the nodes of the neighbouring faces.
+        std::set<Vertex> vertices;
+        MeshCore::PointIndex numPoints = 0;
+        for (auto& domain : domains) {
+            std::size_t numNodes = domain.points.size();
+            domain.pointIndex.resize(numNodes);
+            domain.owned.resize(numNodes, true);
+            for (std::size_t j = 0; j < numNodes; ++j) {
+                if (!domain.boundary[j]) {
+                    domain.pointIndex[j] = numPoints++;
+                    continue;
                 }
 
-                // 2nd vertex
-                Vertex v2(x2,y2,z2);
-                it = vertices.find(v2);
+                const gp_Pnt& pnt = domain.points[j];
+                Vertex v(pnt.X(), pnt.Y(), pnt.Z());
+                std::set<Vertex>::iterator it = vertices.find(v);
                 if (it == vertices.end()) {
-                    v2.i = vertices.size();
-                    face._aulPoints[1] = v2.i;
-                    vertices.insert(v2);
+                    v.i = numPoints++;
+                    domain.pointIndex[j] = v.i;
+                    vertices.insert(v);
                 }
                 else {
-                    face._aulPoints[1] = it->i;
+                    domain.pointIndex[j] = it->i;
+                    domain.owned[j] = false;
                 }
+            }
+        }
 
-                // 3rd vertex
-                Vertex v3(x3,y3,z3);
-                it = vertices.find(v3);
-                if (it == vertices.end()) {
-                    v3.i = vertices.size();
-                    face._aulPoints[2] = v3.i;
-                    vertices.insert(v3);
-                }
-                else {
-                    face._aulPoints[2] = it->i;
+        MeshCore::MeshPointArray verts;
+        verts.resize(numPoints);
+        QtConcurrent::blockingMap(domains, [&verts](FaceTriangulation& domain) {
+            for (std::size_t j = 0; j < domain.points.size(); ++j) {
+                if (domain.owned[j]) {
+                    const gp_Pnt& pnt = domain.points[j];
+                    verts[domain.pointIndex[j]].Set(static_cast<float>(pnt.X()),
+                                                    static_cast<float>(pnt.Y()),
+                                                    static_cast<float>(pnt.Z()));
                 }
+            }
 
-                // make sure that we don't insert invalid facets
+            // make sure that we don't insert invalid facets
+            domain.meshFacets.reserve(domain.facets.size());
+            for (const auto& tria : domain.facets) {
+                Standard_Integer n1, n2, n3;
+                tria.Get(n1, n2, n3);
+                MeshCore::MeshFacet face;
+                face._aulPoints[0] = domain.pointIndex[n1];
+                face._aulPoints[1] = domain.pointIndex[n2];
+                face._aulPoints[2] = domain.pointIndex[n3];
                 if (face._aulPoints[0] != face._aulPoints[1] &&
                     face._aulPoints[1] != face._aulPoints[2] &&
                     face._aulPoints[2] != face._aulPoints[0]) {
-                    faces.push_back(face);
-                    numDomainFaces++;
+                    domain.meshFacets.push_back(face);
                 }
             }
+        });
+
+        MeshCore::MeshFacetArray faces;
+        std::vector< std::vector<MeshCore::FacetIndex> > meshSegments;
+        std::size_t numMeshFaces = 0;
+        for (const auto& domain : domains)
+            numMeshFaces += domain.meshFacets.size();
+        faces.reserve(numMeshFaces);
+
+        numMeshFaces = 0;
+        for (const auto& domain : domains) {
+            std::size_t numDomainFaces = domain.meshFacets.size();
+            faces.insert(faces.end(), domain.meshFacets.begin(), domain.meshFacets.end());
 
             // add a segment for the face
             if (createSegm || this->segments) {
                 std::vector<MeshCore::FacetIndex> segment(numDomainFaces);
                 std::generate(segment.begin(), segment.end(), Base::iotaGen<MeshCore::FacetIndex>(numMeshFaces));
-                numMeshFaces += numDomainFaces;
                 meshSegments.push_back(segment);
             }
+            numMeshFaces += numDomainFaces;
         }
 
-        MeshCore::MeshPointArray verts;
-        verts.resize(vertices.size());
-        for (auto it : vertices)
-            verts[it.i] = it.toPoint();
-
         MeshCore::MeshKernel kernel;
         kernel.Adopt(verts, faces, true);
 
@@ -334,15 +386,13 @@ Mesher::~Mesher()
 Mesh::MeshObject* Mesher::createStandard() const
 {
     if (!shape.IsNull()) {
+        // the cache gives back the triangulations of faces meshed before with these parameters
         BRepTools::Clean(shape);
-        BRepMesh_IncrementalMesh aMesh(shape, deflection, relative, angularDeflection);
+        Part::TessellationCache::instance().mesh(shape, deflection, angularDeflection, relative);
     }
 
-    std::vector<Part::TopoShape::Domain> domains;
-    Part::TopoShape(shape).getDomains(domains);
-
     BrepMesh brepmesh(this->segments, this->colors);
-    return brepmesh.create(domains);
+    return brepmesh.create(shape);
 }
 
 Mesh::MeshObject* Mesher::createMesh() const
@@ -175,6 +175,7 @@
 #include "OCCError.h"
 #include "PrismExtension.h"
 #include "PropertyGeometryList.h"
+#include "ShapeStore.h"
 
 
 namespace Part {
@@ -390,6 +391,7 @@ PyMOD_INIT_FUNC(Part)
     Part::PropertyGeometryList  ::init();
     Part::PropertyShapeHistory  ::init();
     Part::PropertyFilletEdges   ::init();
+    Part::ShapeStore            ::init();
 
     Part::FaceMaker             ::init();
     Part::FaceMakerPublic       ::init();
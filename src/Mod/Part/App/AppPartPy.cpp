@@ -101,6 +101,9 @@
 #include "OCCError.h"
 #include "PartFeature.h"
 #include "PartPyCXX.h"
+#include "ResultCache.h"
+#include "ShapeCheck.h"
+#include "TessellationCache.h"
 #include "Tools.h"
 #include "TopoShape.h"
 #include "TopoShapeCompoundPy.h"
@@ -616,7 +619,39 @@ public:
             "__fromPythonOCC__(occ) -- Helper method to convert a pythonocc shape to an internal shape"
         );
         add_varargs_method("clearShapeCache",&Module::clearShapeCache,
-            "clearShapeCache() -- Clears internal shape cache"
+            "clearShapeCache([MaxMemory]) -- Clears internal shape cache\n"
+            "and optionally sets its memory limit in bytes"
+        );
+        add_varargs_method("getShapeCacheStatistics",&Module::getShapeCacheStatistics,
+            "getShapeCacheStatistics() -> dict\n"
+            "Returns the number of re-used and built shapes, the number of re-used and\n"
+            "computed transformations, the number of cache entries and their estimated\n"
+            "memory in bytes"
+        );
+        add_varargs_method("getTessellationCacheStatistics",&Module::getTessellationCacheStatistics,
+            "getTessellationCacheStatistics() -> dict\n"
+            "Returns the number of re-used and meshed faces, the number of cached\n"
+            "triangulations and their estimated memory in bytes"
+        );
+        add_varargs_method("clearTessellationCache",&Module::clearTessellationCache,
+            "clearTessellationCache([MaxMemory]) -- Clears the cache of face triangulations\n"
+            "and optionally sets its memory limit in bytes"
+        );
+        add_varargs_method("getResultCacheStatistics",&Module::getResultCacheStatistics,
+            "getResultCacheStatistics() -> dict\n"
+            "Returns the number of re-used and computed results of booleans, fillets and\n"
+            "chamfers, the number of cached results and their estimated memory in bytes"
+        );
+        add_varargs_method("clearResultCache",&Module::clearResultCache,
+            "clearResultCache([MaxMemory]) -- Clears the cache of operation results\n"
+            "and optionally sets its memory limit in bytes, zero disables the cache"
+        );
+        add_keyword_method("checkShapes",&Module::checkShapes,
+            "checkShapes(shapes, RunBOPCheck=False, Callback=None) -> list of dicts\n"
+            "Checks the shapes concurrently. Each result has the keys 'Valid', 'Issues',\n"
+            "'BRepCheckTime' and 'BOPCheckTime'. An issue has the keys 'Check', 'ShapeType',\n"
+            "'Index' and 'Status'. The boolean argument check is only run on valid shapes.\n"
+            "If given, Callback is called with the index and the result of each shape in order."
         );
         add_keyword_method("getShape",&Module::getShape,
             "getShape(obj,subname=None,mat=None,needSubElement=False,transform=True,retType=0):\n"
@@ -2312,12 +2347,134 @@ private:
     }
 
     Py::Object clearShapeCache(const Py::Tuple &args) {
-        if (!PyArg_ParseTuple(args.ptr(),""))
+        PyObject* maxMemory = nullptr;
+        if (!PyArg_ParseTuple(args.ptr(),"|O!", &PyLong_Type, &maxMemory))
             throw Py::Exception();
         Part::Feature::clearShapeCache();
+        if (maxMemory)
+            Part::Feature::setShapeCacheMaxMemory(static_cast<std::size_t>(PyLong_AsUnsignedLongLong(maxMemory)));
         return Py::Object();
     }
 
+    Py::Object getShapeCacheStatistics(const Py::Tuple &args) {
+        if (!PyArg_ParseTuple(args.ptr(),""))
+            throw Py::Exception();
+        Part::Feature::ShapeCacheStatistics stats = Part::Feature::getShapeCacheStatistics();
+        Py::Dict dict;
+        dict.setItem("Hits", Py::Long(static_cast<unsigned long>(stats.hits)));
+        dict.setItem("Misses", Py::Long(static_cast<unsigned long>(stats.misses)));
+        dict.setItem("TransformHits", Py::Long(static_cast<unsigned long>(stats.transformHits)));
+        dict.setItem("TransformMisses", Py::Long(static_cast<unsigned long>(stats.transformMisses)));
+        dict.setItem("Entries", Py::Long(static_cast<unsigned long>(stats.entries)));
+        dict.setItem("Memory", Py::Long(static_cast<unsigned long>(stats.memory)));
+        dict.setItem("MaxMemory", Py::Long(static_cast<unsigned long>(stats.maxMemory)));
+        return dict;
+    }
+
+    Py::Object getTessellationCacheStatistics(const Py::Tuple &args) {
+        if (!PyArg_ParseTuple(args.ptr(),""))
+            throw Py::Exception();
+        TessellationCache& cache = TessellationCache::instance();
+        TessellationCache::Statistics stats = cache.getStatistics();
+        Py::Dict dict;
+        dict.setItem("Hits", Py::Long(static_cast<unsigned long>(stats.hits)));
+        dict.setItem("Misses", Py::Long(static_cast<unsigned long>(stats.misses)));
+        dict.setItem("Entries", Py::Long(static_cast<unsigned long>(stats.entries)));
+        dict.setItem("Memory", Py::Long(static_cast<unsigned long>(stats.memory)));
+        dict.setItem("MaxMemory", Py::Long(static_cast<unsigned long>(cache.getMaxMemory())));
+        return dict;
+    }
+
+    Py::Object clearTessellationCache(const Py::Tuple &args) {
+        PyObject* maxMemory = nullptr;
+        if (!PyArg_ParseTuple(args.ptr(),"|O!", &PyLong_Type, &maxMemory))
+            throw Py::Exception();
+        TessellationCache& cache = TessellationCache::instance();
+        cache.clear();
+        if (maxMemory)
+            cache.setMaxMemory(static_cast<std::size_t>(PyLong_AsUnsignedLongLong(maxMemory)));
+        return Py::Object();
+    }
+
+    Py::Object getResultCacheStatistics(const Py::Tuple &args) {
+        if (!PyArg_ParseTuple(args.ptr(),""))
+            throw Py::Exception();
+        ResultCache& cache = ResultCache::instance();
+        ResultCache::Statistics stats = cache.getStatistics();
+        Py::Dict dict;
+        dict.setItem("Hits", Py::Long(static_cast<unsigned long>(stats.hits)));
+        dict.setItem("Misses", Py::Long(static_cast<unsigned long>(stats.misses)));
+        dict.setItem("Entries", Py::Long(static_cast<unsigned long>(stats.entries)));
+        dict.setItem("Memory", Py::Long(static_cast<unsigned long>(stats.memory)));
+        dict.setItem("MaxMemory", Py::Long(static_cast<unsigned long>(cache.getMaxMemory())));
+        return dict;
+    }
+
+    Py::Object clearResultCache(const Py::Tuple &args) {
+        PyObject* maxMemory = nullptr;
+        if (!PyArg_ParseTuple(args.ptr(),"|O!", &PyLong_Type, &maxMemory))
+            throw Py::Exception();
+        ResultCache& cache = ResultCache::instance();
+        cache.clear();
+        if (maxMemory)
+            cache.setMaxMemory(static_cast<std::size_t>(PyLong_AsUnsignedLongLong(maxMemory)));
+        return Py::Object();
+    }
+
+    Py::Object checkShapes(const Py::Tuple& args, const Py::Dict &kwds) {
+        PyObject *pShapes;
+        PyObject *runBopCheck = Py_False;
+        PyObject *callback = Py_None;
+        static char* kwd_list[] = {"shapes", "RunBOPCheck", "Callback", nullptr};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O|O!O", kwd_list,
+                &pShapes, &PyBool_Type, &runBopCheck, &callback))
+            throw Py::Exception();
+        if (callback != Py_None && !PyCallable_Check(callback))
+            throw Py::TypeError("Callback must be callable");
+
+        std::vector<TopoDS_Shape> shapes;
+        Py::Sequence list(pShapes);
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+            PyObject* item = (*it).ptr();
+            if (!PyObject_TypeCheck(item, &(TopoShapePy::Type)))
+                throw Py::TypeError("shapes must be a list of shapes");
+            shapes.push_back(static_cast<TopoShapePy*>(item)->getTopoShapePtr()->getShape());
+        }
+
+        auto toDict = [](const ShapeCheckResult& result) {
+            Py::List issues;
+            for (const auto& it : result.issues) {
+                Py::Dict issue;
+                issue.setItem("Check", Py::String(it.check == ShapeCheckIssue::BOPCheck ? "BOPCheck" : "BRepCheck"));
+                issue.setItem("ShapeType", Py::String(ShapeCheck::typeName(it.type)));
+                issue.setItem("Index", Py::Long(it.index));
+                issue.setItem("Status", Py::String(it.status));
+                issues.append(issue);
+            }
+            Py::Dict dict;
+            dict.setItem("Valid", Py::Boolean(result.valid));
+            dict.setItem("Issues", issues);
+            dict.setItem("BRepCheckTime", Py::Float(result.brepCheckTime));
+            dict.setItem("BOPCheckTime", Py::Float(result.bopCheckTime));
+            return dict;
+        };
+
+        Py::List results;
+        ShapeCheck::ReportFunction report = [&](std::size_t index, const ShapeCheckResult& result) {
+            Py::Dict dict = toDict(result);
+            results.append(dict);
+            if (callback != Py_None) {
+                Py::Callable func(callback);
+                Py::Tuple funcArgs(2);
+                funcArgs.setItem(0, Py::Long(static_cast<unsigned long>(index)));
+                funcArgs.setItem(1, dict);
+                func.apply(funcArgs);
+            }
+        };
+        ShapeCheck::check(shapes, PyObject_IsTrue(runBopCheck) ? true : false, report);
+        return results;
+    }
+
     Py::Object splitSubname(const Py::Tuple& args) {
         const char *subname;
         if (!PyArg_ParseTuple(args.ptr(), "s",&subname))
@@ -0,0 +1,253 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <numeric>
+# include <string>
+# include <Bnd_Box.hxx>
+# include <BRep_Builder.hxx>
+# include <BRepAlgoAPI_Fuse.hxx>
+# include <BRepBndLib.hxx>
+# include <Precision.hxx>
+# include <Standard_Failure.hxx>
+# include <Standard_Version.hxx>
+# include <TopExp.hxx>
+# include <TopoDS_Compound.hxx>
+# include <TopoDS_Iterator.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+#endif
+
+#include <QtConcurrentMap>
+
+#include "ClusterFuse.h"
+
+using namespace Part;
+
+struct ClusterFuse::Cluster
+{
+    /// indices of the shapes, in increasing order
+    std::vector<std::size_t> shapes;
+    /// only set if the cluster has more than one shape
+    std::unique_ptr<BRepAlgoAPI_Fuse> fuse;
+    std::string error;
+};
+
+namespace {
+std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t index)
+{
+    while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+void addToCompound(BRep_Builder& builder, TopoDS_Compound& comp, const TopoDS_Shape& shape)
+{
+    // like the result of a general fuse the compound is flat
+    if (shape.ShapeType() == TopAbs_COMPOUND) {
+        for (TopoDS_Iterator it(shape); it.More(); it.Next())
+            builder.Add(comp, it.Value());
+    }
+    else {
+        builder.Add(comp, shape);
+    }
+}
+}
+
+ClusterFuse::ClusterFuse(const std::vector<TopoDS_Shape>& shapes, Standard_Real tolerance)
+  : myShapes(shapes), myTolerance(tolerance)
+{
+}
+
+ClusterFuse::~ClusterFuse()
+{
+}
+
+std::size_t ClusterFuse::countClusters() const
+{
+    return myClusters.size();
+}
+
+void ClusterFuse::makeClusters()
+{
+    std::size_t count = myShapes.size();
+    std::vector<Bnd_Box> boxes(count);
+    for (std::size_t i = 0; i < count; i++) {
+        BRepBndLib::Add(myShapes[i], boxes[i], Standard_False);
+        boxes[i].Enlarge(std::max(myTolerance, Precision::Confusion()));
+    }
+
+    // sweep along x and join the shapes whose boxes overlap
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < count; i++) {
+        if (!boxes[i].IsVoid())
+            order.push_back(i);
+    }
+    std::vector<double> xMin(count), xMax(count);
+    for (std::size_t i : order) {
+        Standard_Real yMin, zMin, yMax, zMax;
+        boxes[i].Get(xMin[i], yMin, zMin, xMax[i], yMax, zMax);
+    }
+    std::sort(order.begin(), order.end(), [&xMin](std::size_t a, std::size_t b) {
+        return xMin[a] < xMin[b];
+    });
+
+    std::vector<std::size_t> parent(count);
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<std::size_t> active;
+    for (std::size_t i : order) {
+        active.erase(std::remove_if(active.begin(), active.end(), [&](std::size_t j) {
+            return xMax[j] < xMin[i];
+        }), active.end());
+        for (std::size_t j : active) {
+            if (!boxes[i].IsOut(boxes[j])) {
+                std::size_t root1 = findRoot(parent, i);
+                std::size_t root2 = findRoot(parent, j);
+                parent[std::max(root1, root2)] = std::min(root1, root2);
+            }
+        }
+        active.push_back(i);
+    }
+
+    // the clusters are ordered by their first shape
+    myClusters.clear();
+    std::vector<std::size_t> clusterOfRoot(count, count);
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t root = findRoot(parent, i);
+        if (clusterOfRoot[root] == count) {
+            clusterOfRoot[root] = myClusters.size();
+            myClusters.emplace_back(new Cluster);
+        }
+        myClusters[clusterOfRoot[root]]->shapes.push_back(i);
+    }
+}
+
+void ClusterFuse::Build()
+{
+    makeClusters();
+
+    myClusterOfShape.Clear();
+    for (std::size_t index = 0; index < myClusters.size(); index++) {
+        const Cluster& cluster = *myClusters[index];
+        if (cluster.shapes.size() < 2)
+            continue;
+        for (std::size_t i : cluster.shapes) {
+            TopTools_IndexedMapOfShape subShapes;
+            TopExp::MapShapes(myShapes[i], subShapes);
+            for (int j=1; j<=subShapes.Extent(); j++)
+                myClusterOfShape.Bind(subShapes(j), static_cast<Standard_Integer>(index));
+        }
+    }
+
+    auto fuseCluster = [this](std::unique_ptr<Cluster>& cluster) {
+        if (cluster->shapes.size() < 2)
+            return;
+        try {
+            cluster->fuse.reset(new BRepAlgoAPI_Fuse());
+            BRepAlgoAPI_Fuse& mkFuse = *cluster->fuse;
+#if OCC_VERSION_HEX >= 0x060900
+            mkFuse.SetRunParallel(true);
+#endif
+#if OCC_VERSION_HEX >= 0x070200
+            // the arguments of different clusters may share sub-shapes
+            mkFuse.SetNonDestructive(Standard_True);
+#endif
+            TopTools_ListOfShape shapeArguments, shapeTools;
+            shapeArguments.Append(myShapes[cluster->shapes.front()]);
+            for (auto it = cluster->shapes.begin() + 1; it != cluster->shapes.end(); ++it)
+                shapeTools.Append(myShapes[*it]);
+            mkFuse.SetArguments(shapeArguments);
+            mkFuse.SetTools(shapeTools);
+            if (myTolerance > 0.0)
+                mkFuse.SetFuzzyValue(myTolerance);
+            mkFuse.Build();
+        }
+        catch (Standard_Failure& e) {
+            cluster->error = e.GetMessageString();
+            if (cluster->error.empty())
+                cluster->error = "Unknown OCC exception";
+        }
+    };
+
+    bool parallel = myClusters.size() > 1;
+#if OCC_VERSION_HEX < 0x070200
+    // without the non-destructive mode a fuse may modify the shared sub-shapes
+    parallel = false;
+#endif
+    if (parallel)
+        QtConcurrent::blockingMap(myClusters, fuseCluster);
+    else
+        std::for_each(myClusters.begin(), myClusters.end(), fuseCluster);
+
+    for (const auto& cluster : myClusters) {
+        if (!cluster->error.empty())
+            Standard_Failure::Raise(cluster->error.c_str());
+        if (cluster->fuse && !cluster->fuse->IsDone())
+            return;
+    }
+
+    if (myClusters.size() == 1 && myClusters.front()->fuse) {
+        myShape = myClusters.front()->fuse->Shape();
+    }
+    else {
+        BRep_Builder builder;
+        TopoDS_Compound comp;
+        builder.MakeCompound(comp);
+        for (const auto& cluster : myClusters) {
+            if (cluster->fuse)
+                addToCompound(builder, comp, cluster->fuse->Shape());
+            else
+                addToCompound(builder, comp, myShapes[cluster->shapes.front()]);
+        }
+        myShape = comp;
+    }
+    Done();
+}
+
+const TopTools_ListOfShape& ClusterFuse::Modified(const TopoDS_Shape& S)
+{
+    if (myClusterOfShape.IsBound(S))
+        return myClusters[myClusterOfShape.Find(S)]->fuse->Modified(S);
+    else
+        return myEmptyList;
+}
+
+const TopTools_ListOfShape& ClusterFuse::Generated(const TopoDS_Shape& S)
+{
+    if (myClusterOfShape.IsBound(S))
+        return myClusters[myClusterOfShape.Find(S)]->fuse->Generated(S);
+    else
+        return myEmptyList;
+}
+
+Standard_Boolean ClusterFuse::IsDeleted(const TopoDS_Shape& S)
+{
+    if (myClusterOfShape.IsBound(S))
+        return myClusters[myClusterOfShape.Find(S)]->fuse->IsDeleted(S);
+    else
+        return Standard_False;
+}
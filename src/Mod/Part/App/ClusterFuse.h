@@ -0,0 +1,80 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef PART_CLUSTERFUSE_H
+#define PART_CLUSTERFUSE_H
+
+#include <memory>
+#include <vector>
+
+#include <BRepBuilderAPI_MakeShape.hxx>
+#include <TopTools_DataMapOfShapeInteger.hxx>
+#include <TopTools_ListOfShape.hxx>
+
+#include <Mod/Part/PartGlobal.h>
+
+namespace Part {
+
+/**
+ * The ClusterFuse class fuses many shapes at once.
+ *
+ * The shapes are grouped into clusters of shapes whose bounding boxes overlap,
+ * directly or through other shapes of the cluster. Only the shapes of a cluster can
+ * touch each other, so each cluster is fused by its own general fuse and the clusters
+ * are fused in parallel. A shape that doesn't touch any other shape is taken as it is.
+ * The result is the compound of the fused clusters.
+ *
+ * Modified(), Generated() and IsDeleted() answer for the sub-shapes of the arguments
+ * like BRepAlgoAPI_Fuse does, so the history of the result can be built as usual.
+ */
+class PartExport ClusterFuse : public BRepBuilderAPI_MakeShape
+{
+public:
+    /// \a tolerance is the fuzzy value of the fuse operations
+    ClusterFuse(const std::vector<TopoDS_Shape>& shapes, Standard_Real tolerance = 0.0);
+    ~ClusterFuse();
+
+    void Build();
+    const TopTools_ListOfShape& Modified(const TopoDS_Shape& S);
+    const TopTools_ListOfShape& Generated(const TopoDS_Shape& S);
+    Standard_Boolean IsDeleted(const TopoDS_Shape& S);
+
+    /// Number of clusters the shapes were split into
+    std::size_t countClusters() const;
+
+private:
+    struct Cluster;
+    void makeClusters();
+
+private:
+    std::vector<TopoDS_Shape> myShapes;
+    Standard_Real myTolerance;
+    std::vector< std::unique_ptr<Cluster> > myClusters;
+    /// maps the sub-shapes of the fused arguments to their cluster
+    TopTools_DataMapOfShapeInteger myClusterOfShape;
+    TopTools_ListOfShape myEmptyList;
+};
+
+}
+
+#endif // PART_CLUSTERFUSE_H
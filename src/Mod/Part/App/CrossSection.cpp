@@ -23,31 +23,95 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <numeric>
+# include <string>
+# include <Bnd_Box.hxx>
+# include <BRep_Builder.hxx>
 # include <BRepAdaptor_Surface.hxx>
 # include <BRepAlgoAPI_Common.hxx>
 # include <BRepAlgoAPI_Cut.hxx>
 # include <BRepAlgoAPI_Section.hxx>
 # include <BRepBuilderAPI_MakeFace.hxx>
 # include <BRepBuilderAPI_MakeWire.hxx>
+# include <BRepBndLib.hxx>
 # include <BRepGProp_Face.hxx>
 # include <BRepPrimAPI_MakeHalfSpace.hxx>
 # include <gp_Pln.hxx>
 # include <Precision.hxx>
 # include <ShapeFix_Wire.hxx>
 # include <ShapeAnalysis_FreeBounds.hxx>
+# include <Standard_Version.hxx>
 # include <TopExp.hxx>
 # include <TopExp_Explorer.hxx>
 # include <TopTools_IndexedMapOfShape.hxx>
 # include <TopTools_HSequenceOfShape.hxx>
+# include <TopTools_ListOfShape.hxx>
 # include <TopoDS.hxx>
+# include <TopoDS_Compound.hxx>
 # include <TopoDS_Edge.hxx>
 # include <TopoDS_Wire.hxx>
 #endif
 
+#include <QtConcurrentMap>
+
 #include "CrossSection.h"
 
 using namespace Part;
 
+namespace {
+/// A sub-shape and the range of a*x+b*y+c*z it covers
+struct SliceRange
+{
+    TopoDS_Shape shape;
+    double first;
+    double last;
+
+    bool contains(double d) const
+    {
+        return first <= d && d <= last;
+    }
+};
+
+SliceRange makeSliceRange(const TopoDS_Shape& shape, double a, double b, double c)
+{
+    SliceRange range;
+    range.shape = shape;
+    range.first = -DBL_MAX;
+    range.last = DBL_MAX;
+
+    // the box may be larger than the shape but never smaller
+    Bnd_Box box;
+    BRepBndLib::Add(shape, box, Standard_False);
+    if (box.IsVoid() || box.IsOpen())
+        return range;
+
+    box.Enlarge(Precision::Confusion());
+    Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+    box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    range.first = (a > 0 ? a * xMin : a * xMax) +
+                  (b > 0 ? b * yMin : b * yMax) +
+                  (c > 0 ? c * zMin : c * zMax);
+    range.last  = (a > 0 ? a * xMax : a * xMin) +
+                  (b > 0 ? b * yMax : b * yMin) +
+                  (c > 0 ? c * zMax : c * zMin);
+    return range;
+}
+
+void prepareBoolean(BRepAlgoAPI_BooleanOperation& op)
+{
+#if OCC_VERSION_HEX >= 0x060900
+    op.SetRunParallel(Standard_True);
+#endif
+#if OCC_VERSION_HEX >= 0x070200
+    // several planes may be sliced at the same time, so the shared sub-shapes
+    // of the input must not be modified
+    op.SetNonDestructive(Standard_True);
+#endif
+}
+}
+
 
 CrossSection::CrossSection(double a, double b, double c, const TopoDS_Shape& s)
   : a(a), b(b), c(c), s(s)
@@ -73,9 +137,89 @@ std::list<TopoDS_Wire> CrossSection::slice(double d) const
     return wires;
 }
 
+std::vector< std::list<TopoDS_Wire> > CrossSection::slices(const std::vector<double>& d, bool parallel) const
+{
+    // The sub-shapes are collected in the same order as in slice() and a solid is
+    // always cut as a whole (see slice()). Of a shell only the faces which can touch
+    // the plane are intersected.
+    std::vector<SliceRange> solids;
+    std::vector< std::vector<SliceRange> > shells;
+    std::vector<SliceRange> faces;
+
+    TopExp_Explorer xp;
+    for (xp.Init(s, TopAbs_SOLID); xp.More(); xp.Next()) {
+        solids.push_back(makeSliceRange(xp.Current(), a, b, c));
+    }
+    for (xp.Init(s, TopAbs_SHELL, TopAbs_SOLID); xp.More(); xp.Next()) {
+        std::vector<SliceRange> shellFaces;
+        for (TopExp_Explorer xp2(xp.Current(), TopAbs_FACE); xp2.More(); xp2.Next())
+            shellFaces.push_back(makeSliceRange(xp2.Current(), a, b, c));
+        shells.push_back(shellFaces);
+    }
+    for (xp.Init(s, TopAbs_FACE, TopAbs_SHELL); xp.More(); xp.Next()) {
+        faces.push_back(makeSliceRange(xp.Current(), a, b, c));
+    }
+
+    std::vector< std::list<TopoDS_Wire> > wires(d.size());
+    std::vector<std::string> errors(d.size());
+    auto sliceAt = [&](std::size_t index) {
+        double dist = d[index];
+        std::list<TopoDS_Wire>& result = wires[index];
+        try {
+            for (const auto& it : solids) {
+                if (it.contains(dist))
+                    sliceSolid(dist, it.shape, result);
+            }
+            for (const auto& it : shells) {
+                TopoDS_Compound comp;
+                BRep_Builder builder;
+                builder.MakeCompound(comp);
+                bool hit = false;
+                for (const auto& jt : it) {
+                    if (jt.contains(dist)) {
+                        builder.Add(comp, jt.shape);
+                        hit = true;
+                    }
+                }
+                if (hit)
+                    sliceNonSolid(dist, comp, result);
+            }
+            for (const auto& it : faces) {
+                if (it.contains(dist))
+                    sliceNonSolid(dist, it.shape, result);
+            }
+        }
+        catch (const Standard_Failure& e) {
+            errors[index] = e.GetMessageString();
+            if (errors[index].empty())
+                errors[index] = "Unknown OCC exception";
+        }
+    };
+
+    std::vector<std::size_t> indices(d.size());
+    std::iota(indices.begin(), indices.end(), 0);
+#if OCC_VERSION_HEX < 0x070200
+    // without the non-destructive mode a boolean may modify the shared sub-shapes
+    parallel = false;
+#endif
+    if (parallel)
+        QtConcurrent::blockingMap(indices, sliceAt);
+    else
+        std::for_each(indices.begin(), indices.end(), sliceAt);
+
+    for (const auto& it : errors) {
+        if (!it.empty())
+            throw Standard_Failure(it.c_str());
+    }
+
+    return wires;
+}
+
 void CrossSection::sliceNonSolid(double d, const TopoDS_Shape& shape, std::list<TopoDS_Wire>& wires) const
 {
-    BRepAlgoAPI_Section cs(shape, gp_Pln(a,b,c,-d));
+    BRepAlgoAPI_Section cs(shape, gp_Pln(a,b,c,-d), Standard_False);
+    prepareBoolean(cs);
+    cs.Build();
     if (cs.IsDone()) {
         std::list<TopoDS_Edge> edges;
         TopExp_Explorer xp;
@@ -113,7 +257,14 @@ void CrossSection::sliceSolid(double d, const TopoDS_Shape& shape, std::list<Top
 
     BRepPrimAPI_MakeHalfSpace mkSolid(face, refPoint);
     TopoDS_Solid solid = mkSolid.Solid();
-    BRepAlgoAPI_Cut mkCut(shape, solid);
+    BRepAlgoAPI_Cut mkCut;
+    prepareBoolean(mkCut);
+    TopTools_ListOfShape shapeArguments, shapeTools;
+    shapeArguments.Append(shape);
+    shapeTools.Append(solid);
+    mkCut.SetArguments(shapeArguments);
+    mkCut.SetTools(shapeTools);
+    mkCut.Build();
 
     if (mkCut.IsDone()) {
         TopTools_IndexedMapOfShape mapOfFaces;
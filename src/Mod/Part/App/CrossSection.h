@@ -26,6 +26,7 @@
 
 #include <Mod/Part/PartGlobal.h>
 #include <list>
+#include <vector>
 #include <TopTools_IndexedMapOfShape.hxx>
 
 class TopoDS_Shape;
@@ -38,6 +39,12 @@ class PartExport CrossSection
 public:
     CrossSection(double a, double b, double c, const TopoDS_Shape& s);
     std::list<TopoDS_Wire> slice(double d) const;
+    /** Slices the shape at all the distances \a d. The extent of each solid, shell
+     * and face along the slice direction is computed once so that a plane is only
+     * intersected with the sub-shapes it can hit. With \a parallel the planes are
+     * handled concurrently. The wires of the planes are returned in the order of \a d.
+     */
+    std::vector< std::list<TopoDS_Wire> > slices(const std::vector<double>& d, bool parallel) const;
 
 private:
     void sliceNonSolid(double d, const TopoDS_Shape&, std::list<TopoDS_Wire>& wires) const;
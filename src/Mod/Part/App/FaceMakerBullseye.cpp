@@ -22,15 +22,27 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <numeric>
+# include <Bnd_Box.hxx>
+# include <Bnd_Box2d.hxx>
 # include <BRep_Builder.hxx>
 # include <BRep_Tool.hxx>
+# include <BRepAdaptor_Curve.hxx>
 # include <BRepAdaptor_Surface.hxx>
+# include <BRepBndLib.hxx>
 # include <BRepBuilderAPI_Copy.hxx>
 # include <BRepBuilderAPI_MakeFace.hxx>
 # include <BRepClass_FaceClassifier.hxx>
 # include <BRepLib_FindSurface.hxx>
+# include <ElSLib.hxx>
+# include <GCPnts_QuasiUniformDeflection.hxx>
 # include <Geom_Plane.hxx>
 # include <GeomAPI_ProjectPointOnSurf.hxx>
+# include <gp_Vec2d.hxx>
+# include <NCollection_UBTree.hxx>
+# include <NCollection_UBTreeFiller.hxx>
 # include <Precision.hxx>
 # include <Standard_Failure.hxx>
 # include <TopoDS.hxx>
@@ -38,6 +50,8 @@
 # include <QtGlobal>
 #endif
 
+#include <QtConcurrentMap>
+
 #include "FaceMakerBullseye.h"
 #include "FaceMakerCheese.h"
 #include "TopoShape.h"
@@ -45,6 +59,142 @@
 
 using namespace Part;
 
+namespace {
+/// The data of a wire that is needed to find the wires enclosing it
+struct WireInfo
+{
+    TopoDS_Wire wire;
+    /// the sort criterion of FaceMakerCheese::Wire_Compare
+    double squareExtent = 0.0;
+    /// the first vertex of the wire, in 3D and in coordinates of the plane
+    gp_Pnt point;
+    gp_Pnt2d point2d;
+    /// the discretized edges in coordinates of the plane
+    std::vector< std::vector<gp_Pnt2d> > polylines;
+    double deflection = 0.0;
+    /// contains the wire, enlarged by the deflection
+    Bnd_Box2d box;
+    int direction = 0;
+    /// position in the sorted order and the position of the innermost enclosing wire
+    int rank = 0;
+    int parent = -1;
+    std::string error;
+    bool occError = true;
+};
+
+typedef NCollection_UBTree<int, Bnd_Box2d> WireTree;
+
+/// Collects the wires whose box contains a point
+class PointSelector : public WireTree::Selector
+{
+public:
+    PointSelector(const gp_Pnt2d& point, std::vector<int>& found)
+        : point(point), found(found) {}
+    virtual Standard_Boolean Reject(const Bnd_Box2d& box) const override
+    {
+        return box.IsOut(point);
+    }
+    virtual Standard_Boolean Accept(const int& index) override
+    {
+        found.push_back(index);
+        return Standard_True;
+    }
+
+private:
+    gp_Pnt2d point;
+    std::vector<int>& found;
+};
+
+void prepareWire(WireInfo& info, const gp_Pln& plane)
+{
+    Bnd_Box box;
+    BRepBndLib::Add(info.wire, box);
+    box.SetGap(0.0);
+    info.squareExtent = box.SquareExtent();
+    info.deflection = std::max(std::sqrt(info.squareExtent) * 1e-3, Precision::Confusion());
+
+    double u, v;
+    info.point = BRep_Tool::Pnt(TopoDS::Vertex(TopExp_Explorer(info.wire, TopAbs_VERTEX).Current()));
+    ElSLib::Parameters(plane, info.point, u, v);
+    info.point2d = gp_Pnt2d(u, v);
+
+    for (TopExp_Explorer xp(info.wire, TopAbs_EDGE); xp.More(); xp.Next()) {
+        const TopoDS_Edge& edge = TopoDS::Edge(xp.Current());
+        if (BRep_Tool::Degenerated(edge))
+            continue;
+        BRepAdaptor_Curve curve(edge);
+        GCPnts_QuasiUniformDeflection discretizer(curve, info.deflection);
+        if (!discretizer.IsDone())
+            Standard_Failure::Raise("FaceMakerBullseye: failed to discretize edge");
+
+        std::vector<gp_Pnt2d> polyline;
+        polyline.reserve(discretizer.NbPoints());
+        for (int i = 1; i <= discretizer.NbPoints(); i++) {
+            ElSLib::Parameters(plane, discretizer.Value(i), u, v);
+            polyline.emplace_back(u, v);
+            info.box.Add(polyline.back());
+        }
+        info.polylines.push_back(std::move(polyline));
+    }
+    // the polylines cut off the arcs by up to the deflection
+    info.box.Enlarge(2.0 * info.deflection + Precision::Confusion());
+
+    info.direction = FaceMakerBullseye::FaceDriller::getWireDirection(plane, info.wire);
+}
+
+/**
+ * Tests if the first vertex of \a inner is inside of \a outer. The test is done on the
+ * discretized wire, only a point closer to it than the deflection is classified exactly.
+ */
+bool isInside(const WireInfo& outer, const WireInfo& inner, const gp_Pln& plane)
+{
+    const gp_Pnt2d& p = inner.point2d;
+    bool inside = false;
+    double minDist2 = Precision::Infinite();
+    for (const auto& polyline : outer.polylines) {
+        for (std::size_t i = 1; i < polyline.size(); i++) {
+            const gp_Pnt2d& a = polyline[i-1];
+            const gp_Pnt2d& b = polyline[i];
+            // crossing number of a ray in +u direction
+            if ((a.Y() > p.Y()) != (b.Y() > p.Y())) {
+                double u = a.X() + (p.Y() - a.Y()) * (b.X() - a.X()) / (b.Y() - a.Y());
+                if (u > p.X())
+                    inside = !inside;
+            }
+
+            gp_Vec2d ab(a, b), ap(a, p);
+            double len2 = ab.SquareMagnitude();
+            double t = len2 > 0.0 ? std::min(std::max(ab.Dot(ap) / len2, 0.0), 1.0) : 0.0;
+            minDist2 = std::min(minDist2, p.SquareDistance(a.Translated(t * ab)));
+        }
+    }
+
+    double tolerance = 2.0 * outer.deflection + Precision::Confusion();
+    if (minDist2 > tolerance * tolerance)
+        return inside;
+
+    FaceMakerBullseye::FaceDriller face(plane, outer.wire, outer.direction);
+    return face.hitTest(inner.point);
+}
+
+/// The wires of one face to be made
+struct FaceBuild
+{
+    int outer;
+    std::vector<int> holes;
+    TopoDS_Face face;
+    std::string error;
+    bool occError = true;
+};
+
+void raiseError(const std::string& error, bool occError)
+{
+    if (occError)
+        Standard_Failure::Raise(error.c_str());
+    throw Base::ValueError(error);
+}
+}
+
 TYPESYSTEM_SOURCE(Part::FaceMakerBullseye, Part::FaceMakerPublic)
 
 void FaceMakerBullseye::setPlane(const gp_Pln &plane)
@@ -93,54 +243,136 @@ void FaceMakerBullseye::Build_Essence()
         plane = GeomAdaptor_Surface(planeFinder.Surface()).Plane();
     }
 
+    //collect what is needed to sort the wires and to test containment.
+    //The wires are independent, so this is done in parallel.
+    std::vector<WireInfo> infos(myWires.size());
+    for (std::size_t i = 0; i < myWires.size(); i++)
+        infos[i].wire = myWires[i];
+    QtConcurrent::blockingMap(infos, [&plane](WireInfo& info) {
+        try {
+            prepareWire(info, plane);
+        }
+        catch (Standard_Failure& e) {
+            info.error = e.GetMessageString() ? e.GetMessageString() : "Unknown OCC exception";
+        }
+        catch (Base::Exception& e) {
+            info.error = e.what();
+            info.occError = false;
+        }
+    });
+    for (const WireInfo& info : infos) {
+        if (!info.error.empty())
+            raiseError(info.error, info.occError);
+    }
+
     //sort wires by length of diagonal of bounding box.
-    std::vector<TopoDS_Wire> wires = this->myWires;
-    std::stable_sort(wires.begin(), wires.end(), FaceMakerCheese::Wire_Compare());
+    std::vector<int> order(infos.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&infos](int a, int b) {
+        return infos[a].squareExtent < infos[b].squareExtent;
+    });
 
-    //add wires one by one to current set of faces.
-    //We go from last to first, to make it so that outer wires come before inner wires.
-    std::vector< std::unique_ptr<FaceDriller> > faces;
-    for (int i = static_cast<int>(wires.size()) - 1; i >= 0; --i) {
-        TopoDS_Wire& w = wires[i];
-
-        //test if this wire is on any of existing faces (if yes, it's a hole;
-        // if no, it's a beginning of a new face).
-        //Since we are assuming the wires do not intersect, testing if one vertex of wire is in a face is enough.
-        gp_Pnt p = BRep_Tool::Pnt(TopoDS::Vertex(TopExp_Explorer(w, TopAbs_VERTEX).Current()));
-        FaceDriller* foundFace = nullptr;
-        for (std::unique_ptr<FaceDriller>& ff : faces) {
-            if (ff->hitTest(p)) {
-                foundFace = &(*ff);
-                break;
+    //Find for each wire the innermost wire enclosing it, i.e. the smallest one that
+    //comes later in the sorted order. Since we are assuming the wires do not intersect,
+    //testing if one vertex of wire is inside is enough. The candidates are taken from a
+    //tree of the bounding boxes, and each wire can be handled in parallel.
+    WireTree tree;
+    {
+        NCollection_UBTreeFiller<int, Bnd_Box2d> filler(tree);
+        for (int i = 0; i < static_cast<int>(order.size()); i++)
+            filler.Add(i, infos[order[i]].box);
+        filler.Fill();
+    }
+
+    for (int i = 0; i < static_cast<int>(order.size()); i++)
+        infos[order[i]].rank = i;
+    QtConcurrent::blockingMap(infos, [&](WireInfo& info) {
+        try {
+            std::vector<int> candidates;
+            PointSelector selector(info.point2d, candidates);
+            tree.Select(selector);
+            std::sort(candidates.begin(), candidates.end());
+            for (int j : candidates) {
+                if (j > info.rank && isInside(infos[order[j]], info, plane)) {
+                    info.parent = j;
+                    break;
+                }
             }
         }
+        catch (Standard_Failure& e) {
+            info.error = e.GetMessageString() ? e.GetMessageString() : "Unknown OCC exception";
+        }
+        catch (Base::Exception& e) {
+            info.error = e.what();
+            info.occError = false;
+        }
+    });
+    for (const WireInfo& info : infos) {
+        if (!info.error.empty())
+            raiseError(info.error, info.occError);
+    }
+
+    //Wires at an even depth of the hierarchy start a new face, the others are holes
+    //of the face of their parent.
+    //We go from last to first, to make it so that outer wires come before inner wires.
+    std::vector<FaceBuild> faces;
+    std::vector<int> depths(order.size(), 0);
+    std::vector<int> faceOfWire(order.size(), -1);
+    for (int i = static_cast<int>(order.size()) - 1; i >= 0; --i) {
+        int parent = infos[order[i]].parent;
+        if (parent >= 0)
+            depths[i] = depths[parent] + 1;
 
-        if (foundFace) {
-            //wire is on a face.
-            foundFace->addHole(w);
+        if (depths[i] % 2 == 1) {
+            faceOfWire[i] = faceOfWire[parent];
+            faces[faceOfWire[i]].holes.push_back(order[i]);
         }
         else {
-            //wire is not on a face. Start a new face.
-            faces.push_back(std::unique_ptr<FaceDriller>(
-                                new FaceDriller(plane, w)
-                           ));
+            faceOfWire[i] = static_cast<int>(faces.size());
+            FaceBuild face;
+            face.outer = order[i];
+            faces.push_back(face);
         }
     }
 
+    //the faces don't share any wires and are made in parallel
+    QtConcurrent::blockingMap(faces, [&](FaceBuild& build) {
+        try {
+            FaceDriller face(plane, infos[build.outer].wire, infos[build.outer].direction);
+            for (int hole : build.holes)
+                face.addHole(infos[hole].wire, infos[hole].direction);
+            build.face = face.Face();
+        }
+        catch (Standard_Failure& e) {
+            build.error = e.GetMessageString() ? e.GetMessageString() : "Unknown OCC exception";
+        }
+        catch (Base::Exception& e) {
+            build.error = e.what();
+            build.occError = false;
+        }
+    });
+
     //and we are done!
-    for (std::unique_ptr<FaceDriller>& ff : faces) {
-        this->myShapesToReturn.push_back(ff->Face());
+    for (const FaceBuild& build : faces) {
+        if (!build.error.empty())
+            raiseError(build.error, build.occError);
+        this->myShapesToReturn.push_back(build.face);
     }
 }
 
 
 FaceMakerBullseye::FaceDriller::FaceDriller(const gp_Pln& plane, TopoDS_Wire outerWire)
+    : FaceDriller(plane, outerWire, getWireDirection(plane, outerWire))
+{
+}
+
+FaceMakerBullseye::FaceDriller::FaceDriller(const gp_Pln& plane, TopoDS_Wire outerWire, int direction)
 {
     this->myPlane = plane;
     this->myFace = TopoDS_Face();
 
     //Ensure correct orientation of the wire.
-    if (getWireDirection(myPlane, outerWire) < 0)
+    if (direction < 0)
         outerWire.Reverse();
 
     myHPlane = new Geom_Plane(this->myPlane);
@@ -166,9 +398,14 @@ bool FaceMakerBullseye::FaceDriller::hitTest(const gp_Pnt& point) const
 }
 
 void FaceMakerBullseye::FaceDriller::addHole(TopoDS_Wire w)
+{
+    addHole(w, getWireDirection(myPlane, w));
+}
+
+void FaceMakerBullseye::FaceDriller::addHole(TopoDS_Wire w, int direction)
 {
     //Ensure correct orientation of the wire.
-    if (getWireDirection(myPlane, w) > 0) //if wire is CCW..
+    if (direction > 0) //if wire is CCW..
         w.Reverse();   //.. we want CW!
 
     BRep_Builder builder;
@@ -39,6 +39,10 @@ namespace Part
  *
  * Strengths: makes faces with holes with islands
  *
+ * The enclosing wire of each wire is searched in a tree of the bounding boxes
+ * of the wires and tested on the discretized wires, so that sketches with
+ * thousands of wires are handled fast. The faces are made in parallel.
+ *
  * Weaknesses: faces of one compound must be on same plane. TBD
  */
 class PartExport FaceMakerBullseye: public FaceMakerPublic
@@ -65,6 +69,7 @@ protected:
     gp_Pln myPlane; //externally supplied plane (if any)
     bool planeSupplied;
 
+public:
     /**
      * @brief The FaceDriller class is similar to BRepBuilderAPI_MakeFace,
      * except that it is tolerant to wire orientation (wires are oriented as
@@ -74,6 +79,8 @@ protected:
     {
     public:
         FaceDriller(const gp_Pln& plane, TopoDS_Wire outerWire);
+        /// \a direction is the result of getWireDirection() for \a outerWire
+        FaceDriller(const gp_Pln& plane, TopoDS_Wire outerWire, int direction);
 
         /**
          * @brief hitTest: returns True if point is on the face
@@ -82,6 +89,8 @@ protected:
         bool hitTest(const gp_Pnt& point) const;
 
         void addHole(TopoDS_Wire w);
+        /// \a direction is the result of getWireDirection() for \a w
+        void addHole(TopoDS_Wire w, int direction);
 
         const TopoDS_Face& Face() const {return myFace;}
     public:
@@ -36,6 +36,7 @@
 
 
 #include "FeatureChamfer.h"
+#include "ResultCache.h"
 
 
 using namespace Part;
@@ -55,43 +56,50 @@ App::DocumentObjectExecReturn *Chamfer::execute(void)
 
     try {
         auto baseShape = Feature::getShape(link);
-        BRepFilletAPI_MakeChamfer mkChamfer(baseShape);
-        TopTools_IndexedMapOfShape mapOfEdges;
-        TopTools_IndexedDataMapOfShapeListOfShape mapEdgeFace;
-        TopExp::MapShapesAndAncestors(baseShape, TopAbs_EDGE, TopAbs_FACE, mapEdgeFace);
-        TopExp::MapShapes(baseShape, TopAbs_EDGE, mapOfEdges);
-
-        std::vector<FilletElement> values = Edges.getValues();
-        for (std::vector<FilletElement>::iterator it = values.begin(); it != values.end(); ++it) {
-            int id = it->edgeid;
-            double radius1 = it->radius1;
-            double radius2 = it->radius2;
-            const TopoDS_Edge& edge = TopoDS::Edge(mapOfEdges.FindKey(id));
-            const TopoDS_Face& face = TopoDS::Face(mapEdgeFace.FindFromKey(edge).First());
-            mkChamfer.Add(radius1, radius2, edge, face);
+        std::string cacheKey = getResultCacheKey(baseShape);
+        TopoDS_Shape shape;
+        std::vector<ShapeHistory> history;
+        if (cacheKey.empty() || !ResultCache::instance().find(cacheKey, shape, history)) {
+            BRepFilletAPI_MakeChamfer mkChamfer(baseShape);
+            TopTools_IndexedMapOfShape mapOfEdges;
+            TopTools_IndexedDataMapOfShapeListOfShape mapEdgeFace;
+            TopExp::MapShapesAndAncestors(baseShape, TopAbs_EDGE, TopAbs_FACE, mapEdgeFace);
+            TopExp::MapShapes(baseShape, TopAbs_EDGE, mapOfEdges);
+
+            std::vector<FilletElement> values = Edges.getValues();
+            for (std::vector<FilletElement>::iterator it = values.begin(); it != values.end(); ++it) {
+                int id = it->edgeid;
+                double radius1 = it->radius1;
+                double radius2 = it->radius2;
+                const TopoDS_Edge& edge = TopoDS::Edge(mapOfEdges.FindKey(id));
+                const TopoDS_Face& face = TopoDS::Face(mapEdgeFace.FindFromKey(edge).First());
+                mkChamfer.Add(radius1, radius2, edge, face);
+            }
+
+            shape = mkChamfer.Shape();
+            if (shape.IsNull())
+                return new App::DocumentObjectExecReturn("Resulting shape is null");
+
+            //shapefix re #4285
+            //https://www.forum.freecadweb.org/viewtopic.php?f=3&t=43890&sid=dae2fa6fda71670863a103b42739e47f
+            TopoShape* ts = new TopoShape(shape);
+            double minTol = 2.0 * Precision::Confusion();
+            double maxTol = 4.0 * Precision::Confusion();
+            bool rc = ts->fix(Precision::Confusion(), minTol, maxTol);
+            if (rc) {
+                shape = ts->getShape();
+            }
+            delete ts;
+
+            history.push_back(buildHistory(mkChamfer, TopAbs_FACE, shape, baseShape));
+            if (!cacheKey.empty())
+                ResultCache::instance().add(cacheKey, shape, history);
         }
-
-        TopoDS_Shape shape = mkChamfer.Shape();
-        if (shape.IsNull())
-            return new App::DocumentObjectExecReturn("Resulting shape is null");
-
-        //shapefix re #4285
-        //https://www.forum.freecadweb.org/viewtopic.php?f=3&t=43890&sid=dae2fa6fda71670863a103b42739e47f
-        TopoShape* ts = new TopoShape(shape);
-        double minTol = 2.0 * Precision::Confusion();
-        double maxTol = 4.0 * Precision::Confusion();
-        bool rc = ts->fix(Precision::Confusion(), minTol, maxTol);
-        if (rc) {
-            shape = ts->getShape();
-        }
-        delete ts;
-
-        ShapeHistory history = buildHistory(mkChamfer, TopAbs_FACE, shape, baseShape);
         this->Shape.setValue(shape);
 
         // make sure the 'PropertyShapeHistory' is not safed in undo/redo (#0001889)
         PropertyShapeHistory prop;
-        prop.setValue(history);
+        prop.setValues(history);
         prop.setContainer(this);
         prop.touch();
 
@@ -33,6 +33,7 @@
 
 
 #include "FeatureFillet.h"
+#include "ResultCache.h"
 #include <Base/Exception.h>
 
 #include <Precision.hxx>
@@ -58,40 +59,47 @@ App::DocumentObjectExecReturn *Fillet::execute(void)
 #if defined(__GNUC__) && defined (FC_OS_LINUX)
         Base::SignalException se;
 #endif
-        BRepFilletAPI_MakeFillet mkFillet(baseShape);
-        TopTools_IndexedMapOfShape mapOfShape;
-        TopExp::MapShapes(baseShape, TopAbs_EDGE, mapOfShape);
-
-        std::vector<FilletElement> values = Edges.getValues();
-        for (std::vector<FilletElement>::iterator it = values.begin(); it != values.end(); ++it) {
-            int id = it->edgeid;
-            double radius1 = it->radius1;
-            double radius2 = it->radius2;
-            const TopoDS_Edge& edge = TopoDS::Edge(mapOfShape.FindKey(id));
-            mkFillet.Add(radius1, radius2, edge);
+        std::string cacheKey = getResultCacheKey(baseShape);
+        TopoDS_Shape shape;
+        std::vector<ShapeHistory> history;
+        if (cacheKey.empty() || !ResultCache::instance().find(cacheKey, shape, history)) {
+            BRepFilletAPI_MakeFillet mkFillet(baseShape);
+            TopTools_IndexedMapOfShape mapOfShape;
+            TopExp::MapShapes(baseShape, TopAbs_EDGE, mapOfShape);
+
+            std::vector<FilletElement> values = Edges.getValues();
+            for (std::vector<FilletElement>::iterator it = values.begin(); it != values.end(); ++it) {
+                int id = it->edgeid;
+                double radius1 = it->radius1;
+                double radius2 = it->radius2;
+                const TopoDS_Edge& edge = TopoDS::Edge(mapOfShape.FindKey(id));
+                mkFillet.Add(radius1, radius2, edge);
+            }
+
+            shape = mkFillet.Shape();
+            if (shape.IsNull())
+                return new App::DocumentObjectExecReturn("Resulting shape is null");
+
+            //shapefix re #4285
+            //https://www.forum.freecadweb.org/viewtopic.php?f=3&t=43890&sid=dae2fa6fda71670863a103b42739e47f
+            TopoShape* ts = new TopoShape(shape);
+            double minTol = 2.0 * Precision::Confusion();
+            double maxTol = 4.0 * Precision::Confusion();
+            bool rc = ts->fix(Precision::Confusion(), minTol, maxTol);
+            if (rc) {
+                shape = ts->getShape();
+            }
+            delete ts;
+
+            history.push_back(buildHistory(mkFillet, TopAbs_FACE, shape, baseShape));
+            if (!cacheKey.empty())
+                ResultCache::instance().add(cacheKey, shape, history);
         }
-
-        TopoDS_Shape shape = mkFillet.Shape();
-        if (shape.IsNull())
-            return new App::DocumentObjectExecReturn("Resulting shape is null");
-
-        //shapefix re #4285
-        //https://www.forum.freecadweb.org/viewtopic.php?f=3&t=43890&sid=dae2fa6fda71670863a103b42739e47f
-        TopoShape* ts = new TopoShape(shape);
-        double minTol = 2.0 * Precision::Confusion();
-        double maxTol = 4.0 * Precision::Confusion();
-        bool rc = ts->fix(Precision::Confusion(), minTol, maxTol);
-        if (rc) {
-            shape = ts->getShape();
-        }
-        delete ts;
-
-        ShapeHistory history = buildHistory(mkFillet, TopAbs_FACE, shape, baseShape);
         this->Shape.setValue(shape);
 
         // make sure the 'PropertyShapeHistory' is not safed in undo/redo (#0001889)
         PropertyShapeHistory prop;
-        prop.setValue(history);
+        prop.setValues(history);
         prop.setContainer(this);
         prop.touch();
 
@@ -27,10 +27,12 @@
 # include <BRepCheck_Analyzer.hxx>
 # include <Standard_Failure.hxx>
 # include <memory>
+# include <sstream>
 #endif
 
 #include "FeaturePartBoolean.h"
 #include "modelRefine.h"
+#include "ResultCache.h"
 #include <App/Application.h>
 #include <Base/Parameter.h>
 
@@ -67,6 +69,10 @@ short Boolean::mustExecute() const
     return 0;
 }
 
+void Boolean::addResultCacheKey(std::ostream&) const
+{
+}
+
 App::DocumentObjectExecReturn *Boolean::execute(void)
 {
     try {
@@ -87,48 +93,67 @@ App::DocumentObjectExecReturn *Boolean::execute(void)
         if (ToolShape.IsNull())
             throw NullShapeException("Tool shape is null");
 
-        std::unique_ptr<BRepAlgoAPI_BooleanOperation> mkBool(makeOperation(BaseShape, ToolShape));
-        if (!mkBool->IsDone()) {
-            std::stringstream error;
-            error << "Boolean operation failed";
-            if (BaseShape.ShapeType() != TopAbs_SOLID) {
-                error << std::endl << base->Label.getValue() << " is not a solid";
-            }
-            if (ToolShape.ShapeType() != TopAbs_SOLID) {
-                error << std::endl << tool->Label.getValue() << " is not a solid";
-            }
-            return new App::DocumentObjectExecReturn(error.str());
-        }
-        TopoDS_Shape resShape = mkBool->Shape();
-        if (resShape.IsNull()) {
-            return new App::DocumentObjectExecReturn("Resulting shape is null");
-        }
         Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter()
             .GetGroup("BaseApp")->GetGroup("Preferences")->GetGroup("Mod/Part/Boolean");
-
-        if (hGrp->GetBool("CheckModel", false)) {
-            BRepCheck_Analyzer aChecker(resShape);
-            if (! aChecker.IsValid() ) {
-                return new App::DocumentObjectExecReturn("Resulting shape is invalid");
-            }
+        bool checkModel = hGrp->GetBool("CheckModel", false);
+
+        // an operation with unchanged input shapes re-uses its last result
+        std::string cacheKey;
+        ResultCache& cache = ResultCache::instance();
+        if (cache.isEnabled()) {
+            std::ostringstream key;
+            key << getTypeId().getName() << ' ' << Refine.getValue() << ' ' << checkModel << ' '
+                << TopoShape(BaseShape).getFingerprint() << ' ' << TopoShape(ToolShape).getFingerprint();
+            addResultCacheKey(key);
+            cacheKey = key.str();
         }
 
+        TopoDS_Shape resShape;
         std::vector<ShapeHistory> history;
-        history.push_back(buildHistory(*mkBool.get(), TopAbs_FACE, resShape, BaseShape));
-        history.push_back(buildHistory(*mkBool.get(), TopAbs_FACE, resShape, ToolShape));
-
-        if (this->Refine.getValue()) {
-            try {
-                TopoDS_Shape oldShape = resShape;
-                BRepBuilderAPI_RefineModel mkRefine(oldShape);
-                resShape = mkRefine.Shape();
-                ShapeHistory hist = buildHistory(mkRefine, TopAbs_FACE, resShape, oldShape);
-                history[0] = joinHistory(history[0], hist);
-                history[1] = joinHistory(history[1], hist);
+        if (cacheKey.empty() || !cache.find(cacheKey, resShape, history)) {
+            std::unique_ptr<BRepAlgoAPI_BooleanOperation> mkBool(makeOperation(BaseShape, ToolShape));
+            if (!mkBool->IsDone()) {
+                std::stringstream error;
+                error << "Boolean operation failed";
+                if (BaseShape.ShapeType() != TopAbs_SOLID) {
+                    error << std::endl << base->Label.getValue() << " is not a solid";
+                }
+                if (ToolShape.ShapeType() != TopAbs_SOLID) {
+                    error << std::endl << tool->Label.getValue() << " is not a solid";
+                }
+                return new App::DocumentObjectExecReturn(error.str());
             }
-            catch (Standard_Failure&) {
-                // do nothing
+            resShape = mkBool->Shape();
+            if (resShape.IsNull()) {
+                return new App::DocumentObjectExecReturn("Resulting shape is null");
+            }
+
+            if (checkModel) {
+                BRepCheck_Analyzer aChecker(resShape);
+                if (! aChecker.IsValid() ) {
+                    return new App::DocumentObjectExecReturn("Resulting shape is invalid");
+                }
             }
+
+            history.push_back(buildHistory(*mkBool.get(), TopAbs_FACE, resShape, BaseShape));
+            history.push_back(buildHistory(*mkBool.get(), TopAbs_FACE, resShape, ToolShape));
+
+            if (this->Refine.getValue()) {
+                try {
+                    TopoDS_Shape oldShape = resShape;
+                    BRepBuilderAPI_RefineModel mkRefine(oldShape);
+                    resShape = mkRefine.Shape();
+                    ShapeHistory hist = buildHistory(mkRefine, TopAbs_FACE, resShape, oldShape);
+                    history[0] = joinHistory(history[0], hist);
+                    history[1] = joinHistory(history[1], hist);
+                }
+                catch (Standard_Failure&) {
+                    // do nothing
+                }
+            }
+
+            if (!cacheKey.empty())
+                cache.add(cacheKey, resShape, history);
         }
 
         this->Shape.setValue(resShape);
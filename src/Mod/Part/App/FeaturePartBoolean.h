@@ -24,6 +24,8 @@
 #ifndef PART_FEATUREPARTBOOLEAN_H
 #define PART_FEATUREPARTBOOLEAN_H
 
+#include <iosfwd>
+
 #include <App/PropertyLinks.h>
 #include "PartFeature.h"
 
@@ -58,6 +60,10 @@ public:
 
 protected:
     virtual BRepAlgoAPI_BooleanOperation* makeOperation(const TopoDS_Shape&, const TopoDS_Shape&) const = 0;
+    /** Writes the parameters of makeOperation() which are not part of Boolean to
+     * \a key, so that a result is only re-used from the ResultCache if they match.
+     */
+    virtual void addResultCacheKey(std::ostream& key) const;
 };
 
 }
@@ -32,6 +32,7 @@
 #endif
 
 
+#include "ClusterFuse.h"
 #include "FeaturePartFuse.h"
 #include "modelRefine.h"
 #include <App/Application.h>
@@ -112,21 +113,13 @@ App::DocumentObjectExecReturn *MultiFuse::execute(void)
     if (s.size() >= 2) {
         try {
             std::vector<ShapeHistory> history;
-            BRepAlgoAPI_Fuse mkFuse;
-            TopTools_ListOfShape shapeArguments,shapeTools;
-            const TopoDS_Shape& shape = s.front();
-            if (shape.IsNull())
-                throw Base::RuntimeError("Input shape is null");
-            shapeArguments.Append(shape);
-
-            for (std::vector<TopoDS_Shape>::iterator it = s.begin()+1; it != s.end(); ++it) {
+            for (std::vector<TopoDS_Shape>::iterator it = s.begin(); it != s.end(); ++it) {
                 if (it->IsNull())
                     throw Base::RuntimeError("Input shape is null");
-                shapeTools.Append(*it);
             }
 
-            mkFuse.SetArguments(shapeArguments);
-            mkFuse.SetTools(shapeTools);
+            // shapes that cannot touch each other are fused independently
+            ClusterFuse mkFuse(s);
             mkFuse.Build();
             if (!mkFuse.IsDone())
                 throw Base::RuntimeError("MultiFusion failed");
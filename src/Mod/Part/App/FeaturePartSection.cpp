@@ -23,6 +23,7 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <ostream>
 # include <BRepAlgoAPI_Section.hxx>
 # include <Standard_Version.hxx>
 #endif
@@ -48,6 +49,11 @@ short Section::mustExecute() const
     return 0;
 }
 
+void Section::addResultCacheKey(std::ostream& key) const
+{
+    key << ' ' << Approximation.getValue();
+}
+
 BRepAlgoAPI_BooleanOperation* Section::makeOperation(const TopoDS_Shape& base, const TopoDS_Shape& tool) const
 {
     // Let's call algorithm computing a section operation:
@@ -46,6 +46,7 @@ public:
     short mustExecute() const;
 protected:
     BRepAlgoAPI_BooleanOperation* makeOperation(const TopoDS_Shape&, const TopoDS_Shape&) const;
+    void addResultCacheKey(std::ostream& key) const;
     //@}
 };
 
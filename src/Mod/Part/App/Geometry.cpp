@@ -100,6 +100,7 @@
 
 # include <cmath>
 # include <ctime>
+# include <mutex>
 #endif //_PreComp_
 
 #include <Base/Exception.h>
@@ -377,6 +378,10 @@ void Geometry::deleteExtension(const std::string & name)
 
 void Geometry::createNewTag()
 {
+    // geometries may be created from several threads, e.g. when copying a PropertyGeometryList
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
     // Initialize a random number generator, to avoid Valgrind false positives.
     static boost::mt19937 ran;
     static bool seeded = false;
@@ -23,6 +23,8 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <list>
+# include <map>
 # include <sstream>
 # include <Bnd_Box.hxx>
 # include <BRepAdaptor_Curve.hxx>
@@ -63,6 +65,7 @@
 #include "PartFeature.h"
 #include "PartFeaturePy.h"
 #include "PartPyCXX.h"
+#include "ResultCache.h"
 #include "TopoShapePy.h"
 
 
@@ -205,14 +208,39 @@ TopoDS_Shape Feature::getShape(const App::DocumentObject *obj, const char *subna
 
 struct ShapeCache {
 
-    std::unordered_map<const App::Document*,
-        std::map<std::pair<const App::DocumentObject*, std::string> ,TopoShape> > cache;
+    typedef std::pair<const App::DocumentObject*, std::string> Key;
+
+    /// a shape with the placement applied
+    struct Transformed {
+        TopoDS_Shape source;
+        Base::Matrix4D mat;
+        TopoShape shape;
+        std::size_t memory;
+    };
+
+    struct Entry {
+        const App::Document *doc = nullptr;
+        TopoShape shape;
+        std::size_t shapeMemory = 0;
+        std::list<Transformed> transformed;
+        std::list<Key>::iterator usage;
+    };
+
+    // number of placements memorized per entry
+    static const std::size_t MaxTransformed = 4;
+
+    std::map<Key, Entry> cache;
+    std::list<Key> usage;
+    Feature::ShapeCacheStatistics stats;
 
     bool inited = false;
     void init() {
         if(inited)
             return;
         inited = true;
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath(
+                "User parameter:BaseApp/Preferences/Mod/Part/General");
+        stats.maxMemory = static_cast<std::size_t>(hGrp->GetUnsigned("ShapeCacheSize", 256)) * 1024 * 1024;
         App::GetApplication().signalDeleteDocument.connect(
                 boost::bind(&ShapeCache::slotDeleteDocument, this, bp::_1));
         App::GetApplication().signalDeletedObject.connect(
@@ -222,7 +250,12 @@ struct ShapeCache {
     }
 
     void slotDeleteDocument(const App::Document &doc) {
-        cache.erase(&doc);
+        for(auto it=cache.begin(); it!=cache.end();) {
+            if(it->second.doc == &doc)
+                it = erase(it);
+            else
+                ++it;
+        }
     }
 
     void slotChanged(const App::DocumentObject &obj, const App::Property &prop) {
@@ -236,39 +269,165 @@ struct ShapeCache {
     }
 
     void slotClear(const App::DocumentObject &obj) {
-        auto it = cache.find(obj.getDocument());
-        if(it==cache.end())
+        if(cache.empty())
             return;
-        auto &map = it->second;
-        for(auto it2=map.lower_bound(std::make_pair(&obj,std::string()));
-                it2!=map.end() && it2->first.first==&obj;)
+        clearObject(&obj);
+        // the shapes of all objects referring to obj, e.g. through a link, are outdated too
+        for(auto inObj : obj.getInListEx(true))
+            clearObject(inObj);
+    }
+
+    void clearObject(const App::DocumentObject *obj) {
+        for(auto it=cache.lower_bound(std::make_pair(obj,std::string()));
+                it!=cache.end() && it->first.first==obj;)
         {
-            it2 = map.erase(it2);
+            it = erase(it);
         }
     }
 
+    void clear() {
+        cache.clear();
+        usage.clear();
+        stats.memory = 0;
+        stats.entries = 0;
+    }
+
+    std::map<Key, Entry>::iterator erase(std::map<Key, Entry>::iterator it) {
+        stats.memory -= memoryOf(it->second);
+        usage.erase(it->second.usage);
+        it = cache.erase(it);
+        stats.entries = cache.size();
+        return it;
+    }
+
+    static std::size_t memoryOf(const Entry &entry) {
+        std::size_t memory = entry.shapeMemory;
+        for(auto &it : entry.transformed)
+            memory += it.memory;
+        return memory;
+    }
+
+    Entry &getEntry(const App::DocumentObject *obj, const char *subname) {
+        init();
+        Key key(obj, std::string(subname?subname:""));
+        auto it = cache.find(key);
+        if(it == cache.end()) {
+            it = cache.insert(std::make_pair(key, Entry())).first;
+            it->second.doc = obj->getDocument();
+            usage.push_front(key);
+            it->second.usage = usage.begin();
+            stats.entries = cache.size();
+        }
+        else {
+            usage.splice(usage.begin(), usage, it->second.usage);
+        }
+        return it->second;
+    }
+
+    void evict() {
+        // the most recently used entry is kept even if it alone exceeds the limit
+        while(stats.memory > stats.maxMemory && usage.size() > 1)
+            erase(cache.find(usage.back()));
+    }
+
+    void setMaxMemory(std::size_t bytes) {
+        init();
+        stats.maxMemory = bytes;
+        evict();
+    }
+
     bool getShape(const App::DocumentObject *obj, TopoShape &shape, const char *subname=nullptr) {
         init();
-        auto &entry = cache[obj->getDocument()];
         if(!subname) subname = "";
-        auto it = entry.find(std::make_pair(obj,std::string(subname)));
-        if(it!=entry.end()) {
-            shape = it->second;
-            return !shape.isNull();
+        auto it = cache.find(std::make_pair(obj,std::string(subname)));
+        if(it!=cache.end() && !it->second.shape.isNull()) {
+            shape = it->second.shape;
+            usage.splice(usage.begin(), usage, it->second.usage);
+            ++stats.hits;
+            return true;
         }
+        ++stats.misses;
         return false;
     }
 
     void setShape(const App::DocumentObject *obj, const TopoShape &shape, const char *subname=nullptr) {
+        Entry &entry = getEntry(obj, subname);
+        stats.memory -= entry.shapeMemory;
+        entry.shape = shape;
+        entry.shapeMemory = shape.getMemSize();
+        stats.memory += entry.shapeMemory;
+        evict();
+    }
+
+    static bool isSameSource(const TopoDS_Shape &s1, const TopoDS_Shape &s2) {
+        if(s1.IsEqual(s2))
+            return true;
+        // the location is often re-created with the same transformation
+        if(s1.TShape()!=s2.TShape() || s1.Orientation()!=s2.Orientation())
+            return false;
+        Base::Matrix4D m1, m2;
+        TopoShape::convertToMatrix(s1.Location().Transformation(), m1);
+        TopoShape::convertToMatrix(s2.Location().Transformation(), m2);
+        return m1 == m2;
+    }
+
+    bool getTransformed(const App::DocumentObject *obj, const char *subname,
+            const TopoShape &source, const Base::Matrix4D &mat, TopoShape &shape)
+    {
         init();
         if(!subname) subname = "";
-        cache[obj->getDocument()][std::make_pair(obj,std::string(subname))] = shape;
+        auto it = cache.find(std::make_pair(obj,std::string(subname)));
+        if(it!=cache.end()) {
+            auto &transformed = it->second.transformed;
+            for(auto jt=transformed.begin(); jt!=transformed.end(); ++jt) {
+                if(jt->mat == mat && isSameSource(jt->source, source.getShape())) {
+                    shape = jt->shape;
+                    transformed.splice(transformed.begin(), transformed, jt);
+                    usage.splice(usage.begin(), usage, it->second.usage);
+                    ++stats.transformHits;
+                    return true;
+                }
+            }
+        }
+        ++stats.transformMisses;
+        return false;
+    }
+
+    void setTransformed(const App::DocumentObject *obj, const char *subname,
+            const TopoShape &source, const Base::Matrix4D &mat, const TopoShape &shape)
+    {
+        Entry &entry = getEntry(obj, subname);
+        if(entry.transformed.size() >= MaxTransformed) {
+            stats.memory -= entry.transformed.back().memory;
+            entry.transformed.pop_back();
+        }
+        Transformed transformed;
+        transformed.source = source.getShape();
+        transformed.mat = mat;
+        transformed.shape = shape;
+        // a shape which is only moved shares its sub-shapes with the source
+        if(shape.getShape().TShape() == transformed.source.TShape())
+            transformed.memory = sizeof(Transformed);
+        else
+            transformed.memory = shape.getMemSize();
+        entry.transformed.push_front(transformed);
+        stats.memory += transformed.memory;
+        evict();
     }
 };
 static ShapeCache _ShapeCache;
 
 void Feature::clearShapeCache() {
-    _ShapeCache.cache.clear();
+    _ShapeCache.clear();
+}
+
+Feature::ShapeCacheStatistics Feature::getShapeCacheStatistics() {
+    _ShapeCache.init();
+    return _ShapeCache.stats;
+}
+
+void Feature::setShapeCacheMaxMemory(std::size_t bytes) {
+    _ShapeCache.setMaxMemory(bytes);
 }
 
 static TopoShape _getTopoShape(const App::DocumentObject *obj, const char *subname, 
@@ -504,9 +663,17 @@ TopoShape Feature::getTopoShape(const App::DocumentObject *obj, const char *subn
         if(transform)
             obj->getSubObject(nullptr,nullptr,&topMat);
 
-        // Apply the top level transformation
-        if(!shape.isNull())
-            shape.transformShape(topMat,false,true);
+        // Apply the top level transformation. The result is memorized because
+        // the same sub-shape is often requested repeatedly, e.g. during selection.
+        if(!shape.isNull()) {
+            TopoShape transformed;
+            if(!_ShapeCache.getTransformed(obj,subname,shape,topMat,transformed)) {
+                transformed = shape;
+                transformed.transformShape(topMat,false,true);
+                _ShapeCache.setTransformed(obj,subname,shape,topMat,transformed);
+            }
+            shape = transformed;
+        }
 
         if(pmat)
             *pmat = topMat * mat;
@@ -672,6 +839,19 @@ short FilletBase::mustExecute() const
     return 0;
 }
 
+std::string FilletBase::getResultCacheKey(const TopoDS_Shape& baseShape) const
+{
+    if (!ResultCache::instance().isEnabled())
+        return std::string();
+
+    std::ostringstream key;
+    key.precision(17);
+    key << getTypeId().getName() << ' ' << TopoShape(baseShape).getFingerprint();
+    for (const auto& it : Edges.getValues())
+        key << ' ' << it.edgeid << ' ' << it.radius1 << ' ' << it.radius2;
+    return key.str();
+}
+
 // ---------------------------------------------------------
 
 PROPERTY_SOURCE(Part::FeatureExt, Part::Feature)
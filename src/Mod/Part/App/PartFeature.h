@@ -98,7 +98,29 @@ public:
             App::DocumentObject **owner=nullptr, bool resolveLink=true, bool transform=true, 
             bool noElementMap=false);
 
+    /// Statistics of the cache used by getTopoShape()
+    struct ShapeCacheStatistics
+    {
+        /// number of shapes found in the cache
+        std::size_t hits = 0;
+        /// number of shapes which had to be built
+        std::size_t misses = 0;
+        /// number of re-used transformed shapes
+        std::size_t transformHits = 0;
+        /// number of shapes which had to be transformed
+        std::size_t transformMisses = 0;
+        /// number of cached objects and sub-objects
+        std::size_t entries = 0;
+        /// estimated memory of the cached shapes in bytes
+        std::size_t memory = 0;
+        /// memory limit in bytes
+        std::size_t maxMemory = 0;
+    };
+
     static void clearShapeCache();
+    static ShapeCacheStatistics getShapeCacheStatistics();
+    /// Sets the memory limit of the shape cache in bytes.
+    static void setShapeCacheMaxMemory(std::size_t bytes);
 
     static App::DocumentObject *getShapeOwner(const App::DocumentObject *obj, const char *subname=nullptr);
 
@@ -136,6 +158,12 @@ public:
     PropertyFilletEdges Edges;
 
     short mustExecute() const;
+
+protected:
+    /** Returns the key of the result in the ResultCache for \a baseShape and the
+     * current edges, or an empty string if the cache is disabled.
+     */
+    std::string getResultCacheKey(const TopoDS_Shape& baseShape) const;
 };
 
 typedef App::FeaturePythonT<Feature> FeaturePython;
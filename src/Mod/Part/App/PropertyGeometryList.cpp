@@ -22,6 +22,16 @@
 
 #include "PreCompiled.h"
 
+#ifndef _PreComp_
+# include <algorithm>
+# include <atomic>
+# include <iterator>
+# include <memory>
+# include <numeric>
+#endif
+
+#include <QtConcurrentMap>
+
 #include <Base/Console.h>
 #include <Base/Reader.h>
 #include <Base/Writer.h>
@@ -36,6 +46,41 @@ using namespace Base;
 using namespace std;
 using namespace Part;
 
+namespace {
+// lists of this size and larger are cloned in parallel
+const std::size_t ParallelCloneSize = 1024;
+
+std::vector<Geometry*> cloneGeometries(const std::vector<Geometry*>& values)
+{
+    std::vector<Geometry*> copy(values.size(), nullptr);
+    if (values.size() < ParallelCloneSize) {
+        for (std::size_t i = 0; i < values.size(); i++)
+            copy[i] = values[i]->clone();
+        return copy;
+    }
+
+    // a sketch can have thousands of geometries, which are copied for each undo step
+    std::atomic<bool> failed(false);
+    std::vector<std::size_t> indices(values.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    QtConcurrent::blockingMap(indices, [&](std::size_t i) {
+        try {
+            copy[i] = values[i]->clone();
+        }
+        catch (...) {
+            failed = true;
+        }
+    });
+
+    if (failed) {
+        for (auto geo : copy)
+            delete geo;
+        throw Base::RuntimeError("Failed to copy geometry list");
+    }
+    return copy;
+}
+}
+
 
 //**************************************************************************
 // PropertyGeometryList
@@ -47,73 +92,122 @@ TYPESYSTEM_SOURCE(Part::PropertyGeometryList, App::PropertyLists)
 // Construction/Destruction
 
 
-PropertyGeometryList::PropertyGeometryList()
+PropertyGeometryList::GeometryData::~GeometryData()
 {
+    for (auto geo : values)
+        delete geo;
+}
 
+PropertyGeometryList::PropertyGeometryList()
+  : _data(std::make_shared<GeometryData>())
+{
+    _data->owner = this;
 }
 
 PropertyGeometryList::~PropertyGeometryList()
 {
-    for (std::vector<Geometry*>::iterator it = _lValueList.begin(); it != _lValueList.end(); ++it)
-        if (*it) delete *it;
+    release();
+}
+
+void PropertyGeometryList::release() const
+{
+    if (_data->owner == this)
+        _data->owner = nullptr;
+}
+
+void PropertyGeometryList::detach() const
+{
+    if (_data.use_count() == 1) {
+        _data->owner = this;
+        return;
+    }
+
+    // The owner may still use pointers to the shared geometries, so it keeps them
+    // and the other properties get copies.
+    auto data = std::make_shared<GeometryData>();
+    std::vector<Geometry*> clones = cloneGeometries(_data->values);
+    if (!_data->owner || _data->owner == this) {
+        data->values = std::move(_data->values);
+        _data->values = std::move(clones);
+    }
+    else {
+        data->values = std::move(clones);
+    }
+    release();
+    data->owner = this;
+    _data = data;
 }
 
 void PropertyGeometryList::setSize(int newSize)
 {
-    for (unsigned int i = newSize; i < _lValueList.size(); i++)
-        delete _lValueList[i];
-    _lValueList.resize(newSize);
+    detach();
+    std::vector<Geometry*>& values = _data->values;
+    for (unsigned int i = newSize; i < values.size(); i++)
+        delete values[i];
+    values.resize(newSize);
 }
 
 int PropertyGeometryList::getSize(void) const
 {
-    return static_cast<int>(_lValueList.size());
+    return static_cast<int>(_data->values.size());
 }
 
 void PropertyGeometryList::setValue(const Geometry* lValue)
 {
-    if (lValue) {
-        aboutToSetValue();
-        Geometry* newVal = lValue->clone();
-        for (unsigned int i = 0; i < _lValueList.size(); i++)
-            delete _lValueList[i];
-        _lValueList.resize(1);
-        _lValueList[0] = newVal;
-        hasSetValue();
-    }
+    if (lValue)
+        setValues(std::vector<Geometry*>(1, lValue->clone()));
 }
 
 void PropertyGeometryList::setValues(const std::vector<Geometry*>& lValue)
 {
-    auto copy = lValue;
-    for(auto &geo : copy) // copy of the individual geometry pointers
-        geo = geo->clone();
-
-    setValues(std::move(copy));
+    setValues(cloneGeometries(lValue));
 }
 
 void PropertyGeometryList::setValues(std::vector<Geometry*> &&lValue)
 {
     aboutToSetValue();
-    std::set<Geometry*> valueSet(_lValueList.begin(),_lValueList.end());
-    for(auto v : lValue)
-        valueSet.erase(v);
-    _lValueList = std::move(lValue);
-    for(auto v : valueSet)
-        delete v;
+    std::vector<Geometry*> newValues(lValue);
+    std::sort(newValues.begin(), newValues.end());
+    if (_data.use_count() == 1) {
+        // delete the current geometries that are not part of the new list
+        std::vector<Geometry*> oldValues = std::move(_data->values);
+        std::sort(oldValues.begin(), oldValues.end());
+        oldValues.erase(std::unique(oldValues.begin(), oldValues.end()), oldValues.end());
+        std::vector<Geometry*> unused;
+        std::set_difference(oldValues.begin(), oldValues.end(), newValues.begin(), newValues.end(),
+                            std::back_inserter(unused));
+        _data->values = std::move(lValue);
+        _data->owner = this;
+        for(auto v : unused)
+            delete v;
+    }
+    else {
+        // the copies sharing the current geometries keep them, except for the ones
+        // taken over by the new list which are replaced by copies
+        for (auto& geo : _data->values) {
+            if (std::binary_search(newValues.begin(), newValues.end(), geo))
+                geo = geo->clone();
+        }
+        release();
+        _data = std::make_shared<GeometryData>();
+        _data->values = std::move(lValue);
+        _data->owner = this;
+    }
     hasSetValue();
 }
 
 void PropertyGeometryList::set1Value(int idx, std::unique_ptr<Geometry> &&lValue)
 {
-    if(idx>=(int)_lValueList.size())
+    if(idx>=getSize())
         throw Base::IndexError("Index out of bound");
     aboutToSetValue();
+    detach();
+    std::vector<Geometry*>& values = _data->values;
     if(idx < 0) 
-        _lValueList.push_back(lValue.release());
+        values.push_back(lValue.release());
     else {
-        delete _lValueList[idx];
-        _lValueList[idx] = lValue.release();
+        delete values[idx];
+        values[idx] = lValue.release();
     }
     hasSetValue();
 }
@@ -122,7 +216,7 @@ PyObject *PropertyGeometryList::getPyObject(void)
 {
     PyObject* list = PyList_New(getSize());
     for (int i = 0; i < getSize(); i++)
-        PyList_SetItem( list, i, _lValueList[i]->getPyObject());
+        PyList_SetItem( list, i, _data->values[i]->getPyObject());
     return list;
 }
 
@@ -170,9 +264,9 @@ void PropertyGeometryList::Save(Writer &writer) const
     writer.incInd();
     for (int i = 0; i < getSize(); i++) {
         writer.Stream() << writer.ind() << "<Geometry  type=\""
-                        << _lValueList[i]->getTypeId().getName() << "\">" << endl;;
+                        << _data->values[i]->getTypeId().getName() << "\">" << endl;;
         writer.incInd();
-        _lValueList[i]->Save(writer);
+        _data->values[i]->Save(writer);
         writer.decInd();
         writer.Stream() << writer.ind() << "</Geometry>" << endl;
     }
@@ -221,21 +315,26 @@ void PropertyGeometryList::Restore(Base::XMLReader &reader)
 
 App::Property *PropertyGeometryList::Copy(void) const
 {
+    // the geometries are shared until one of the properties is changed
     PropertyGeometryList *p = new PropertyGeometryList();
-    p->setValues(_lValueList);
+    p->release();
+    p->_data = _data;
     return p;
 }
 
 void PropertyGeometryList::Paste(const Property &from)
 {
     const PropertyGeometryList& FromList = dynamic_cast<const PropertyGeometryList&>(from);
-    setValues(FromList._lValueList);
+    aboutToSetValue();
+    release();
+    _data = FromList._data;
+    hasSetValue();
 }
 
 unsigned int PropertyGeometryList::getMemSize(void) const
 {
     int size = sizeof(PropertyGeometryList);
     for (int i = 0; i < getSize(); i++)
-        size += _lValueList[i]->getMemSize();
+        size += _data->values[i]->getMemSize();
     return size;
 }
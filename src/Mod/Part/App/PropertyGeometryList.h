@@ -23,6 +23,7 @@
 #ifndef APP_PropertyGeometryList_H
 #define APP_PropertyGeometryList_H
 
+#include <memory>
 #include <vector>
 
 #include <App/Property.h>
@@ -66,11 +67,15 @@ public:
 
     /// index operator
     const Geometry *operator[] (const int idx) const {
-        return _lValueList[idx];
+        return _data->values[idx];
     }
 
+    /** Returns the geometries, which may be changed by the caller. If the list is
+     * shared with a copy of the property, it is copied first.
+     */
     const std::vector<Geometry*> &getValues(void) const {
-        return _lValueList;
+        detach();
+        return _data->values;
     }
 
     void set1Value(int idx, std::unique_ptr<Geometry> &&);
@@ -87,7 +92,20 @@ public:
     virtual unsigned int getMemSize(void) const;
 
 private:
-    std::vector<Geometry*> _lValueList;
+    /// The geometries, shared by copies of the property until one of them is changed
+    struct GeometryData
+    {
+        ~GeometryData();
+        std::vector<Geometry*> values;
+        /// the property which may still use pointers to the geometries from before they were shared
+        const PropertyGeometryList* owner = nullptr;
+    };
+
+    void detach() const;
+    void release() const;
+
+private:
+    mutable std::shared_ptr<GeometryData> _data;
 };
 
 } // namespace Part
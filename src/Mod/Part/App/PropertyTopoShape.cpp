@@ -46,6 +46,7 @@
 #include <Base/Writer.h>
 
 #include "PropertyTopoShape.h"
+#include "ShapeStore.h"
 #include "TopoShapePy.h"
 
 
@@ -196,7 +197,15 @@ void PropertyPartShape::Save (Base::Writer &writer) const
 {
     if(!writer.isForceXML()) {
         //See SaveDocFile(), RestoreDocFile()
-        if (writer.getMode("BinaryBrep")) {
+        ShapeStore* store = writer.getMode("BinaryBrep") ? ShapeStore::getWriterStore(writer) : nullptr;
+        if (store) {
+            writer.Stream() << writer.ind() << "<Part store=\""
+                            << store->getFileName()
+                            << "\" index=\""
+                            << store->addShape(_Shape.getShape())
+                            << "\"/>" << std::endl;
+        }
+        else if (writer.getMode("BinaryBrep")) {
             writer.Stream() << writer.ind() << "<Part file=\""
                             << writer.addFile("PartShape.bin", this)
                             << "\"/>" << std::endl;
@@ -212,6 +221,14 @@ void PropertyPartShape::Save (Base::Writer &writer) const
 void PropertyPartShape::Restore(Base::XMLReader &reader)
 {
     reader.readElement("Part");
+    if (reader.hasAttribute("store")) {
+        // the shape is set when the store is read
+        std::string store (reader.getAttribute("store") );
+        int index = static_cast<int>(reader.getAttributeAsInteger("index"));
+        ShapeStore::getReaderStore(reader, store.c_str())->addProperty(index, this);
+        return;
+    }
+
     std::string file (reader.getAttribute("file") );
 
     if (!file.empty()) {
@@ -0,0 +1,132 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#include <App/Application.h>
+
+#include "ResultCache.h"
+#include "TopoShape.h"
+
+using namespace Part;
+
+ResultCache& ResultCache::instance()
+{
+    // never destroyed as the shapes must not be released after OCC has shut down
+    static ResultCache* cache = new ResultCache();
+    return *cache;
+}
+
+ResultCache::ResultCache()
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Mod/Part/General");
+    maxMemory = static_cast<std::size_t>(hGrp->GetUnsigned("ResultCacheSize", 0)) * 1024 * 1024;
+}
+
+ResultCache::~ResultCache()
+{
+}
+
+bool ResultCache::isEnabled() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxMemory > 0;
+}
+
+bool ResultCache::find(const std::string& key, TopoDS_Shape& shape, std::vector<ShapeHistory>& history)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        stats.misses++;
+        return false;
+    }
+
+    shape = it->second.shape;
+    history = it->second.history;
+    usage.splice(usage.begin(), usage, it->second.usage);
+    stats.hits++;
+    return true;
+}
+
+void ResultCache::add(const std::string& key, const TopoDS_Shape& shape, const std::vector<ShapeHistory>& history)
+{
+    std::size_t memory = key.size() + TopoShape(shape).getMemSize();
+    for (const auto& hist : history) {
+        for (const auto& it : hist.shapeMap)
+            memory += sizeof(it) + it.second.size() * sizeof(int);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (memory > maxMemory || entries.find(key) != entries.end())
+        return;
+
+    usage.push_front(key);
+    Entry& entry = entries[key];
+    entry.shape = shape;
+    entry.history = history;
+    entry.memory = memory;
+    entry.usage = usage.begin();
+    stats.memory += memory;
+    evict();
+}
+
+void ResultCache::evict()
+{
+    while (stats.memory > maxMemory && !usage.empty()) {
+        auto it = entries.find(usage.back());
+        stats.memory -= it->second.memory;
+        entries.erase(it);
+        usage.pop_back();
+    }
+
+    stats.entries = entries.size();
+}
+
+void ResultCache::setMaxMemory(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    maxMemory = bytes;
+    evict();
+}
+
+std::size_t ResultCache::getMaxMemory() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxMemory;
+}
+
+void ResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    usage.clear();
+    stats = Statistics();
+}
+
+ResultCache::Statistics ResultCache::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,117 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef PART_RESULTCACHE_H
+#define PART_RESULTCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+
+#include <Mod/Part/PartGlobal.h>
+#include "PropertyTopoShape.h"
+
+namespace Part
+{
+
+/**
+ * The ResultCache class keeps the results of expensive shape operations.
+ *
+ * A boolean, fillet or chamfer feature is recomputed whenever one of its inputs is
+ * touched, or after a document is reopened, even if the input shapes didn't change.
+ * The features look up their result by a key made of the operation, the
+ * fingerprints of the input shapes (see TopoShape::getFingerprint()) and the
+ * parameters. Only if it isn't found the operation is run and its result is added.
+ *
+ * The cache is disabled unless it has a memory limit. The least recently used
+ * entries are removed when the limit is exceeded. The cache is shared by the whole
+ * process and can be used from several threads.
+ */
+class PartExport ResultCache
+{
+public:
+    struct Statistics
+    {
+        /// number of results that could be re-used
+        std::size_t hits = 0;
+        /// number of results that had to be computed
+        std::size_t misses = 0;
+        /// number of cached results
+        std::size_t entries = 0;
+        /// estimated memory of the cached results in bytes
+        std::size_t memory = 0;
+    };
+
+    static ResultCache& instance();
+
+    /// Returns true if results are cached at all.
+    bool isEnabled() const;
+    /** Looks up the result of the operation \a key. If it is found the shape and the
+     * face history are set and true is returned.
+     */
+    bool find(const std::string& key, TopoDS_Shape& shape, std::vector<ShapeHistory>& history);
+    /// Adds the result of the operation \a key.
+    void add(const std::string& key, const TopoDS_Shape& shape, const std::vector<ShapeHistory>& history);
+
+    /// Sets the memory limit in bytes, zero disables the cache.
+    void setMaxMemory(std::size_t bytes);
+    std::size_t getMaxMemory() const;
+    /// Removes all entries and resets the statistics.
+    void clear();
+    Statistics getStatistics() const;
+
+private:
+    ResultCache();
+    ~ResultCache();
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator = (const ResultCache&) = delete;
+
+    typedef std::list<std::string> UsageList;
+    struct Entry
+    {
+        TopoDS_Shape shape;
+        std::vector<ShapeHistory> history;
+        std::size_t memory = 0;
+        UsageList::iterator usage;
+    };
+
+    void evict();
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    UsageList usage;
+    Statistics stats;
+    std::size_t maxMemory;
+};
+
+} //namespace Part
+
+
+#endif // PART_RESULTCACHE_H
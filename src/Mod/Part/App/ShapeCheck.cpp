@@ -0,0 +1,434 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <numeric>
+# include <set>
+# include <tuple>
+# include <BOPAlgo_ArgumentAnalyzer.hxx>
+# include <BOPAlgo_ListOfCheckResult.hxx>
+# include <BRepBuilderAPI_Copy.hxx>
+# include <BRepCheck_Analyzer.hxx>
+# include <BRepCheck_ListIteratorOfListOfStatus.hxx>
+# include <BRepCheck_Result.hxx>
+# include <Standard_Version.hxx>
+# include <TopExp.hxx>
+# include <TopoDS_Iterator.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+# include <TopTools_ListIteratorOfListOfShape.hxx>
+#endif
+
+#include <QtConcurrentMap>
+
+#include <Base/TimeInfo.h>
+
+#include "ShapeCheck.h"
+
+using namespace Part;
+
+namespace {
+// the order in which TopoShape::analyze() reports the sub-shapes
+const TopAbs_ShapeEnum CheckedTypes[] = {
+    TopAbs_VERTEX, TopAbs_EDGE, TopAbs_WIRE, TopAbs_FACE,
+    TopAbs_SHELL, TopAbs_SOLID, TopAbs_COMPOUND, TopAbs_COMPSOLID
+};
+
+int typeRank(TopAbs_ShapeEnum type)
+{
+    return static_cast<int>(std::find(std::begin(CheckedTypes), std::end(CheckedTypes), type) -
+                            std::begin(CheckedTypes));
+}
+
+const char* bopStatusText(BOPAlgo_CheckStatus status)
+{
+    static const char* texts[] = {
+        "BOPAlgo CheckUnknown",
+        "BOPAlgo BadType",
+        "BOPAlgo SelfIntersect",
+        "BOPAlgo TooSmallEdge",
+        "BOPAlgo NonRecoverableFace",
+        "BOPAlgo IncompatibilityOfVertex",
+        "BOPAlgo IncompatibilityOfEdge",
+        "BOPAlgo IncompatibilityOfFace",
+        "BOPAlgo OperationAborted",
+        "BOPAlgo GeomAbs_C0",
+        "BOPAlgo_InvalidCurveOnSurface",
+        "BOPAlgo NotValid"
+    };
+    std::size_t index = static_cast<std::size_t>(status);
+    if (index < sizeof(texts) / sizeof(texts[0]))
+        return texts[index];
+    return "BOPAlgo CheckUnknown";
+}
+
+/// A part of a shape that BRepCheck_Analyzer can check on its own
+struct CheckUnit
+{
+    TopoDS_Shape shape;
+    std::vector<ShapeCheckIssue> issues;
+    bool valid = true;
+};
+
+void addUnits(const TopoDS_Shape& shape, std::vector<CheckUnit>& units)
+{
+    if (shape.ShapeType() == TopAbs_COMPOUND) {
+        for (TopoDS_Iterator it(shape); it.More(); it.Next())
+            addUnits(it.Value(), units);
+    }
+    else {
+        CheckUnit unit;
+        unit.shape = shape;
+        units.push_back(unit);
+    }
+}
+
+void addIssues(const BRepCheck_ListOfStatus& status, const TopoDS_Shape& shape, int rank,
+               const TopTools_IndexedMapOfShape* shapeMaps, std::vector<ShapeCheckIssue>& issues)
+{
+    for (BRepCheck_ListIteratorOfListOfStatus it(status); it.More(); it.Next()) {
+        if (it.Value() == BRepCheck_NoError)
+            continue;
+        ShapeCheckIssue issue;
+        issue.check = ShapeCheckIssue::BRepCheck;
+        issue.type = CheckedTypes[rank];
+        issue.index = shapeMaps[rank].FindIndex(shape);
+        issue.status = ShapeCheck::statusText(it.Value());
+        issues.push_back(issue);
+    }
+}
+
+void analyzeUnit(CheckUnit& unit, const TopTools_IndexedMapOfShape* shapeMaps, bool parallel)
+{
+#if OCC_VERSION_HEX >= 0x070600
+    BRepCheck_Analyzer aChecker(unit.shape, Standard_True, parallel ? Standard_True : Standard_False);
+#else
+    (void)parallel;
+    BRepCheck_Analyzer aChecker(unit.shape);
+#endif
+    unit.valid = aChecker.IsValid() ? true : false;
+    if (unit.valid)
+        return;
+
+    for (int rank = 0; rank < 8; rank++) {
+        TopAbs_ShapeEnum type = CheckedTypes[rank];
+        TopTools_IndexedMapOfShape subShapes;
+        TopExp::MapShapes(unit.shape, type, subShapes);
+        for (int i = 1; i <= subShapes.Extent(); i++) {
+            const TopoDS_Shape& sub = subShapes(i);
+            if (aChecker.IsValid(sub))
+                continue;
+            const Handle(BRepCheck_Result)& result = aChecker.Result(sub);
+            if (!result.IsNull())
+                addIssues(result->StatusOnShape(sub), sub, rank, shapeMaps, unit.issues);
+
+            // the errors of the sub-shapes in the context of this shape, e.g. an open wire of a face
+            for (int subRank = 0; subRank < rank; subRank++) {
+                TopTools_IndexedMapOfShape children;
+                TopExp::MapShapes(sub, CheckedTypes[subRank], children);
+                for (int j = 1; j <= children.Extent(); j++) {
+                    Handle(BRepCheck_Result) childResult = aChecker.Result(children(j));
+                    if (childResult.IsNull())
+                        continue;
+                    for (childResult->InitContextIterator(); childResult->MoreShapeInContext();
+                         childResult->NextShapeInContext()) {
+                        if (childResult->ContextualShape().IsSame(sub))
+                            addIssues(childResult->StatusOnShape(), children(j), subRank, shapeMaps, unit.issues);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+ShapeCheckIssue makeFailure(ShapeCheckIssue::Check check, const TopoDS_Shape& shape,
+                            const TopTools_IndexedMapOfShape* shapeMaps, Standard_Failure& e)
+{
+    ShapeCheckIssue issue;
+    issue.check = check;
+    issue.type = shape.ShapeType();
+    int rank = typeRank(issue.type);
+    issue.index = rank < 8 ? shapeMaps[rank].FindIndex(shape) : 0;
+    issue.status = e.GetMessageString();
+    if (issue.status.empty())
+        issue.status = ShapeCheck::statusText(BRepCheck_CheckFail);
+    return issue;
+}
+
+void checkUnit(CheckUnit& unit, const TopTools_IndexedMapOfShape* shapeMaps, bool parallel)
+{
+    try {
+        analyzeUnit(unit, shapeMaps, parallel);
+    }
+    catch (Standard_Failure& e) {
+        unit.valid = false;
+        unit.issues.push_back(makeFailure(ShapeCheckIssue::BRepCheck, unit.shape, shapeMaps, e));
+    }
+}
+
+void analyzeBop(const TopoDS_Shape& shape, ShapeCheckResult& result)
+{
+    TopoDS_Shape BOPCopy = BRepBuilderAPI_Copy(shape).Shape();
+    BOPAlgo_ArgumentAnalyzer BOPCheck;
+    BOPCheck.SetShape1(BOPCopy);
+    //all settings are false by default. so only turn on what we want.
+    BOPCheck.ArgumentTypeMode() = true;
+    BOPCheck.SelfInterMode() = true;
+    BOPCheck.SmallEdgeMode() = true;
+    BOPCheck.RebuildFaceMode() = true;
+    BOPCheck.ContinuityMode() = true;
+    BOPCheck.SetParallelMode(true);
+    BOPCheck.SetRunParallel(true);
+    BOPCheck.TangentMode() = true;
+    BOPCheck.MergeVertexMode() = true;
+    BOPCheck.CurveOnSurfaceMode() = true;
+    BOPCheck.MergeEdgeMode() = true;
+    BOPCheck.Perform();
+
+    if (BOPCheck.HasFaulty()) {
+        result.valid = false;
+
+        // the faulty shapes belong to the copy, so they are found by their position
+        TopTools_IndexedMapOfShape copyMaps[8];
+        for (int rank = 0; rank < 8; rank++)
+            TopExp::MapShapes(BOPCopy, CheckedTypes[rank], copyMaps[rank]);
+
+        const BOPAlgo_ListOfCheckResult &BOPResults = BOPCheck.GetCheckResult();
+        BOPAlgo_ListIteratorOfListOfCheckResult BOPResultsIt(BOPResults);
+        for (; BOPResultsIt.More(); BOPResultsIt.Next()) {
+            const BOPAlgo_CheckResult &current = BOPResultsIt.Value();
+            const TopTools_ListOfShape &faultyShapes1 = current.GetFaultyShapes1();
+            TopTools_ListIteratorOfListOfShape faultyShapes1It(faultyShapes1);
+            for (;faultyShapes1It.More(); faultyShapes1It.Next()) {
+                const TopoDS_Shape &faultyShape = faultyShapes1It.Value();
+                ShapeCheckIssue issue;
+                issue.check = ShapeCheckIssue::BOPCheck;
+                issue.type = faultyShape.ShapeType();
+                int rank = typeRank(issue.type);
+                issue.index = rank < 8 ? copyMaps[rank].FindIndex(faultyShape) : 0;
+                issue.status = bopStatusText(current.GetCheckStatus());
+                result.issues.push_back(issue);
+            }
+        }
+    }
+}
+
+void runBopCheck(const TopoDS_Shape& shape, ShapeCheckResult& result)
+{
+    Base::TimeInfo start;
+    try {
+        analyzeBop(shape, result);
+    }
+    catch (Standard_Failure& e) {
+        result.valid = false;
+        ShapeCheckIssue issue;
+        issue.check = ShapeCheckIssue::BOPCheck;
+        issue.type = shape.ShapeType();
+        issue.index = typeRank(issue.type) < 8 ? 1 : 0;
+        issue.status = e.GetMessageString();
+        if (issue.status.empty())
+            issue.status = bopStatusText(BOPAlgo_CheckUnknown);
+        result.issues.push_back(issue);
+    }
+
+    result.bopCheckTime = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+}
+}
+
+ShapeCheckResult ShapeCheck::check(const TopoDS_Shape& shape, bool runBopCheck)
+{
+    ShapeCheckResult result;
+    if (shape.IsNull())
+        return result;
+
+    Base::TimeInfo start;
+    TopTools_IndexedMapOfShape shapeMaps[8];
+    for (int rank = 0; rank < 8; rank++)
+        TopExp::MapShapes(shape, CheckedTypes[rank], shapeMaps[rank]);
+
+    std::vector<CheckUnit> units;
+    addUnits(shape, units);
+    if (units.size() > 1) {
+        QtConcurrent::blockingMap(units, [&shapeMaps](CheckUnit& unit) {
+            checkUnit(unit, shapeMaps, false);
+        });
+    }
+    else if (!units.empty()) {
+        checkUnit(units.front(), shapeMaps, true);
+    }
+
+    for (const auto& unit : units) {
+        result.valid = result.valid && unit.valid;
+        result.issues.insert(result.issues.end(), unit.issues.begin(), unit.issues.end());
+    }
+    // a sub-shape shared by several children is reported once
+    std::stable_sort(result.issues.begin(), result.issues.end(), [](const ShapeCheckIssue& a, const ShapeCheckIssue& b) {
+        return std::make_tuple(typeRank(a.type), a.index) < std::make_tuple(typeRank(b.type), b.index);
+    });
+    if (units.size() > 1) {
+        std::set<std::tuple<int, int, std::string> > seen;
+        result.issues.erase(std::remove_if(result.issues.begin(), result.issues.end(), [&seen](const ShapeCheckIssue& it) {
+            return !seen.insert(std::make_tuple(static_cast<int>(it.type), it.index, it.status)).second;
+        }), result.issues.end());
+    }
+    result.brepCheckTime = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+
+    if (result.valid && runBopCheck)
+        ::runBopCheck(shape, result);
+
+    return result;
+}
+
+std::vector<ShapeCheckResult> ShapeCheck::check(const std::vector<TopoDS_Shape>& shapes, bool runBopCheck,
+                                                const ReportFunction& report)
+{
+    std::vector<std::size_t> indices(shapes.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::function<ShapeCheckResult(std::size_t)> checkShape = [&shapes, runBopCheck](std::size_t index) {
+        return check(shapes[index], runBopCheck);
+    };
+    QFuture<ShapeCheckResult> future = QtConcurrent::mapped(indices, checkShape);
+
+    std::vector<ShapeCheckResult> results;
+    results.reserve(shapes.size());
+    try {
+        for (std::size_t i = 0; i < shapes.size(); i++) {
+            results.push_back(future.resultAt(static_cast<int>(i)));
+            if (report)
+                report(i, results.back());
+        }
+    }
+    catch (...) {
+        // the running checks refer to the shapes
+        future.cancel();
+        future.waitForFinished();
+        throw;
+    }
+
+    return results;
+}
+
+const char* ShapeCheck::statusText(BRepCheck_Status status)
+{
+    switch (status)
+    {
+    case BRepCheck_NoError:
+        return "No error";
+    case BRepCheck_InvalidPointOnCurve:
+        return "Invalid point on curve";
+    case BRepCheck_InvalidPointOnCurveOnSurface:
+        return "Invalid point on curve on surface";
+    case BRepCheck_InvalidPointOnSurface:
+        return "Invalid point on surface";
+    case BRepCheck_No3DCurve:
+        return "No 3D curve";
+    case BRepCheck_Multiple3DCurve:
+        return "Multiple 3D curve";
+    case BRepCheck_Invalid3DCurve:
+        return "Invalid 3D curve";
+    case BRepCheck_NoCurveOnSurface:
+        return "No curve on surface";
+    case BRepCheck_InvalidCurveOnSurface:
+        return "Invalid curve on surface";
+    case BRepCheck_InvalidCurveOnClosedSurface:
+        return "Invalid curve on closed surface";
+    case BRepCheck_InvalidSameRangeFlag:
+        return "Invalid same-range flag";
+    case BRepCheck_InvalidSameParameterFlag:
+        return "Invalid same-parameter flag";
+    case BRepCheck_InvalidDegeneratedFlag:
+        return "Invalid degenerated flag";
+    case BRepCheck_FreeEdge:
+        return "Free edge";
+    case BRepCheck_InvalidMultiConnexity:
+        return "Invalid multi-connexity";
+    case BRepCheck_InvalidRange:
+        return "Invalid range";
+    case BRepCheck_EmptyWire:
+        return "Empty wire";
+    case BRepCheck_RedundantEdge:
+        return "Redundant edge";
+    case BRepCheck_SelfIntersectingWire:
+        return "Self-intersecting wire";
+    case BRepCheck_NoSurface:
+        return "No surface";
+    case BRepCheck_InvalidWire:
+        return "Invalid wires";
+    case BRepCheck_RedundantWire:
+        return "Redundant wires";
+    case BRepCheck_IntersectingWires:
+        return "Intersecting wires";
+    case BRepCheck_InvalidImbricationOfWires:
+        return "Invalid imbrication of wires";
+    case BRepCheck_EmptyShell:
+        return "Empty shell";
+    case BRepCheck_RedundantFace:
+        return "Redundant face";
+    case BRepCheck_UnorientableShape:
+        return "Unorientable shape";
+    case BRepCheck_NotClosed:
+        return "Not closed";
+    case BRepCheck_NotConnected:
+        return "Not connected";
+    case BRepCheck_SubshapeNotInShape:
+        return "Sub-shape not in shape";
+    case BRepCheck_BadOrientation:
+        return "Bad orientation";
+    case BRepCheck_BadOrientationOfSubshape:
+        return "Bad orientation of sub-shape";
+    case BRepCheck_InvalidToleranceValue:
+        return "Invalid tolerance value";
+    case BRepCheck_CheckFail:
+        return "Check failed";
+    default:
+        return "Undetermined error";
+    }
+}
+
+const char* ShapeCheck::typeName(TopAbs_ShapeEnum type)
+{
+    switch (type)
+    {
+    case TopAbs_COMPOUND:
+        return "Compound";
+    case TopAbs_COMPSOLID:
+        return "Compound Solid";
+    case TopAbs_SOLID:
+        return "Solid";
+    case TopAbs_SHELL:
+        return "Shell";
+    case TopAbs_FACE:
+        return "Face";
+    case TopAbs_WIRE:
+        return "Wire";
+    case TopAbs_EDGE:
+        return "Edge";
+    case TopAbs_VERTEX:
+        return "Vertex";
+    default:
+        return "Shape";
+    }
+}
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef PART_SHAPECHECK_H
+#define PART_SHAPECHECK_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <BRepCheck_Status.hxx>
+#include <TopAbs_ShapeEnum.hxx>
+
+#include <Mod/Part/PartGlobal.h>
+
+class TopoDS_Shape;
+
+namespace Part
+{
+
+/// A problem found by ShapeCheck
+struct PartExport ShapeCheckIssue
+{
+    enum Check {
+        BRepCheck,
+        BOPCheck
+    };
+
+    /// the check that found the problem
+    Check check;
+    /// type of the faulty sub-shape
+    TopAbs_ShapeEnum type;
+    /// index of the faulty sub-shape among the sub-shapes of its type, starting at 1
+    int index;
+    std::string status;
+};
+
+/// The outcome of checking one shape
+struct PartExport ShapeCheckResult
+{
+    bool valid = true;
+    std::vector<ShapeCheckIssue> issues;
+    /// time of the geometry and topology check in seconds
+    double brepCheckTime = 0.0;
+    /// time of the boolean argument check in seconds, zero if it wasn't run
+    double bopCheckTime = 0.0;
+};
+
+/**
+ * The ShapeCheck class validates shapes and returns structured results.
+ *
+ * A shape is checked with BRepCheck_Analyzer and, if it is valid and requested,
+ * with BOPAlgo_ArgumentAnalyzer like TopoShape::analyze() does. The children of a
+ * compound are independent for BRepCheck_Analyzer and are checked concurrently,
+ * the boolean argument check is always run on the whole shape because it looks for
+ * intersections between the children. Several shapes are checked concurrently, too.
+ */
+class PartExport ShapeCheck
+{
+public:
+    typedef std::function<void(std::size_t, const ShapeCheckResult&)> ReportFunction;
+
+    /// Checks \a shape.
+    static ShapeCheckResult check(const TopoDS_Shape& shape, bool runBopCheck);
+    /** Checks all \a shapes concurrently and returns the results in the order of
+     * \a shapes. If given, \a report is called in the calling thread with the index
+     * and the result of each shape as soon as the results up to this shape are known.
+     */
+    static std::vector<ShapeCheckResult> check(const std::vector<TopoDS_Shape>& shapes, bool runBopCheck,
+                                               const ReportFunction& report = ReportFunction());
+
+    /// Returns the description of \a status.
+    static const char* statusText(BRepCheck_Status status);
+    /// Returns the name of the shape type, e.g. "Face".
+    static const char* typeName(TopAbs_ShapeEnum type);
+};
+
+} //namespace Part
+
+
+#endif // PART_SHAPECHECK_H
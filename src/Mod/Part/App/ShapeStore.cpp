@@ -0,0 +1,180 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <memory>
+# include <BinTools.hxx>
+# include <BinTools_ShapeSet.hxx>
+# include <Standard_Failure.hxx>
+#endif
+
+#include <App/Application.h>
+#include <Base/Console.h>
+#include <Base/Reader.h>
+#include <Base/Writer.h>
+
+#include "ShapeStore.h"
+#include "PropertyTopoShape.h"
+
+using namespace Part;
+
+TYPESYSTEM_SOURCE(Part::ShapeStore, Base::Persistence)
+
+ShapeStore::ShapeStore()
+{
+}
+
+ShapeStore::~ShapeStore()
+{
+}
+
+ShapeStore* ShapeStore::getWriterStore(Base::Writer& writer)
+{
+    // Older versions cannot read the store, so it must be enabled explicitly. It is only
+    // used for project files because the recovery files are written incrementally.
+    bool shared = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("SharedShapeStorage", false);
+    if (!shared || !dynamic_cast<Base::ZipWriter*>(&writer))
+        return nullptr;
+
+    const char* name = "Part::ShapeStore";
+    auto store = static_cast<ShapeStore*>(writer.getAttachedObject(name));
+    if (!store) {
+        std::shared_ptr<ShapeStore> ptr = std::make_shared<ShapeStore>();
+        ptr->fileName = writer.addFile("PartShapes.bin", ptr.get());
+        writer.attachObject(name, ptr);
+        store = ptr.get();
+    }
+    return store;
+}
+
+ShapeStore* ShapeStore::getReaderStore(Base::XMLReader& reader, const char* fileName)
+{
+    std::string name = std::string("Part::ShapeStore:") + fileName;
+    auto store = static_cast<ShapeStore*>(reader.getAttachedObject(name));
+    if (!store) {
+        std::shared_ptr<ShapeStore> ptr = std::make_shared<ShapeStore>();
+        ptr->fileName = reader.addFile(fileName, ptr.get());
+        reader.attachObject(name, ptr);
+        store = ptr.get();
+    }
+    return store;
+}
+
+int ShapeStore::addShape(const TopoDS_Shape& shape)
+{
+    shapes.push_back(shape);
+    return static_cast<int>(shapes.size()) - 1;
+}
+
+void ShapeStore::addProperty(int index, PropertyPartShape* prop)
+{
+    properties.emplace_back(index, prop);
+}
+
+unsigned int ShapeStore::getMemSize () const
+{
+    return static_cast<unsigned int>(shapes.size() * sizeof(TopoDS_Shape) +
+                                     properties.size() * sizeof(properties.front()));
+}
+
+void ShapeStore::Save (Base::Writer &) const
+{
+    // the properties write the references to the store
+}
+
+void ShapeStore::Restore(Base::XMLReader &)
+{
+    // the properties read the references to the store
+}
+
+void ShapeStore::SaveDocFile (Base::Writer &writer) const
+{
+    // See BinTools_FormatVersion of OCCT 7.6
+    enum {
+        VERSION_3 = 3
+    };
+
+    // the sub-shapes, locations and geometries shared by the shapes are written once
+    BinTools_ShapeSet theShapeSet;
+    theShapeSet.SetFormatNb(VERSION_3);
+    std::vector<Standard_Integer> ids;
+    ids.reserve(3 * shapes.size());
+    for (const auto& it : shapes) {
+        if (it.IsNull()) {
+            ids.insert(ids.end(), 3, -1);
+        }
+        else {
+            ids.push_back(theShapeSet.Add(it));
+            ids.push_back(theShapeSet.Locations().Index(it.Location()));
+            ids.push_back(static_cast<Standard_Integer>(it.Orientation()));
+        }
+    }
+
+    std::ostream& out = writer.Stream();
+    theShapeSet.Write(out);
+    BinTools::PutInteger(out, static_cast<Standard_Integer>(shapes.size()));
+    for (auto id : ids)
+        BinTools::PutInteger(out, id);
+
+    // release the shapes
+    shapes.clear();
+}
+
+void ShapeStore::RestoreDocFile(Base::Reader &reader)
+{
+    std::vector<TopoDS_Shape> restored;
+    try {
+        BinTools_ShapeSet theShapeSet;
+        theShapeSet.Read(reader);
+        Standard_Integer count = 0;
+        BinTools::GetInteger(reader, count);
+        restored.resize(std::max<Standard_Integer>(count, 0));
+        for (auto& it : restored) {
+            Standard_Integer shapeId=0, locId=0, orient=0;
+            BinTools::GetInteger(reader, shapeId);
+            BinTools::GetInteger(reader, locId);
+            BinTools::GetInteger(reader, orient);
+            if (shapeId <= 0 || shapeId > theShapeSet.NbShapes())
+                continue;
+
+            it = theShapeSet.Shape(shapeId);
+            it.Location(theShapeSet.Locations().Location(locId));
+            it.Orientation(static_cast<TopAbs_Orientation>(orient));
+        }
+    }
+    catch (const Standard_Failure& e) {
+        Base::Console().Error("Failed to read shapes from '%s': %s\n",
+                              fileName.c_str(), e.GetMessageString());
+    }
+
+    for (const auto& it : properties) {
+        if (it.first >= 0 && it.first < static_cast<int>(restored.size()))
+            it.second->setValue(restored[it.first]);
+    }
+    properties.clear();
+}
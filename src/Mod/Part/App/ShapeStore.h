@@ -0,0 +1,95 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PART_SHAPESTORE_H
+#define PART_SHAPESTORE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+#include <Base/Persistence.h>
+#include <Mod/Part/PartGlobal.h>
+
+namespace Part
+{
+
+class PropertyPartShape;
+
+/**
+ * The ShapeStore class writes the shapes of all PropertyPartShape of a document
+ * to one binary file.
+ *
+ * Each property only stores the index of its shape in the XML file. As all shapes
+ * are written with one BinTools_ShapeSet a TShape or a curve or surface which is
+ * used by several shapes, e.g. by the features of a PartDesign body, is written
+ * only once. When the file is read the shapes share their TShapes again.
+ *
+ * There is one store per Base::Writer or Base::XMLReader. It is created on demand
+ * by the first property which is saved or restored and is registered as file at
+ * this position, so that the order of the files is the same when reading. The
+ * store is attached to the writer or reader and destroyed together with it.
+ */
+class PartExport ShapeStore : public Base::Persistence
+{
+    TYPESYSTEM_HEADER();
+
+public:
+    /** Returns the store of \a writer or null if the shapes should be written
+     * to a file per property.
+     */
+    static ShapeStore* getWriterStore(Base::Writer& writer);
+    /// Returns the store of \a reader that reads the file \a fileName.
+    static ShapeStore* getReaderStore(Base::XMLReader& reader, const char* fileName);
+
+    ShapeStore();
+    ~ShapeStore();
+
+    const std::string& getFileName() const
+    { return fileName; }
+    /// Adds a shape to be written and returns its index.
+    int addShape(const TopoDS_Shape&);
+    /// Sets the shape with \a index to \a prop once the file is read.
+    void addProperty(int index, PropertyPartShape* prop);
+
+    /** @name Persistence */
+    //@{
+    virtual unsigned int getMemSize () const override;
+    virtual void Save (Base::Writer &writer) const override;
+    virtual void Restore(Base::XMLReader &reader) override;
+    virtual void SaveDocFile (Base::Writer &writer) const override;
+    virtual void RestoreDocFile(Base::Reader &reader) override;
+    //@}
+
+private:
+    std::string fileName;
+    mutable std::vector<TopoDS_Shape> shapes;
+    std::vector<std::pair<int, PropertyPartShape*> > properties;
+};
+
+} //namespace Part
+
+
+#endif // PART_SHAPESTORE_H
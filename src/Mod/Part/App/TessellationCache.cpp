@@ -0,0 +1,324 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <set>
+# include <tuple>
+# include <vector>
+# include <BRep_Builder.hxx>
+# include <BRep_Tool.hxx>
+# include <BRepMesh_IncrementalMesh.hxx>
+# include <Poly_PolygonOnTriangulation.hxx>
+# include <Poly_Triangulation.hxx>
+# include <TopExp.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Edge.hxx>
+# include <TopoDS_Face.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+#endif
+
+#include <App/Application.h>
+
+#include "TessellationCache.h"
+
+using namespace Part;
+
+namespace {
+std::size_t memoryOf(const Handle(Poly_Triangulation)& tria)
+{
+    std::size_t nodes = static_cast<std::size_t>(tria->NbNodes());
+    std::size_t memory = nodes * sizeof(gp_Pnt) +
+                         static_cast<std::size_t>(tria->NbTriangles()) * sizeof(Poly_Triangle);
+    if (tria->HasUVNodes())
+        memory += nodes * sizeof(gp_Pnt2d);
+    if (tria->HasNormals())
+        memory += nodes * 3 * sizeof(float);
+    return memory;
+}
+
+std::size_t memoryOf(const Handle(Poly_PolygonOnTriangulation)& poly)
+{
+    if (poly.IsNull())
+        return 0;
+    std::size_t nodes = static_cast<std::size_t>(poly->NbNodes());
+    std::size_t memory = nodes * sizeof(int);
+    if (poly->HasParameters())
+        memory += nodes * sizeof(double);
+    return memory;
+}
+}
+
+/// Locks the faces and edges of a shape for meshing and unlocks them when it is destroyed.
+class TessellationCache::Lock
+{
+public:
+    Lock(TessellationCache& cache, std::vector<const TopoDS_TShape*>&& shapes)
+        : cache(cache), shapes(std::move(shapes))
+    {
+        // all sub-shapes are locked at once so that two threads cannot wait for each other
+        std::unique_lock<std::mutex> lock(cache.mutex);
+        cache.unlocked.wait(lock, [this]() {
+            for (auto it : this->shapes) {
+                if (this->cache.locked.count(it))
+                    return false;
+            }
+            return true;
+        });
+        cache.locked.insert(this->shapes.begin(), this->shapes.end());
+    }
+    ~Lock()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            for (auto it : shapes)
+                cache.locked.erase(it);
+        }
+        cache.unlocked.notify_all();
+    }
+
+private:
+    TessellationCache& cache;
+    std::vector<const TopoDS_TShape*> shapes;
+};
+
+struct TessellationCache::Entry
+{
+    struct EdgePolygons
+    {
+        TopoDS_Edge edge;
+        Handle(Poly_PolygonOnTriangulation) polygon1;
+        /// only set for seam edges
+        Handle(Poly_PolygonOnTriangulation) polygon2;
+    };
+
+    /// keeps the TShape alive so that its address cannot be re-used by another face,
+    /// the entry is removed once nothing else refers to it
+    Handle(TopoDS_TShape) tshape;
+    Handle(Poly_Triangulation) triangulation;
+    std::vector<EdgePolygons> edges;
+    std::size_t memory = 0;
+    UsageList::iterator usage;
+
+    /// Takes the triangulation of \a face which must have no location.
+    bool read(const TopoDS_Face& face)
+    {
+        TopLoc_Location loc;
+        triangulation = BRep_Tool::Triangulation(face, loc);
+        if (triangulation.IsNull())
+            return false;
+
+        tshape = face.TShape();
+        memory = memoryOf(triangulation);
+
+        TopTools_IndexedMapOfShape edgeMap;
+        TopExp::MapShapes(face, TopAbs_EDGE, edgeMap);
+        for (int i=1; i<=edgeMap.Extent(); i++) {
+            EdgePolygons polygons;
+            polygons.edge = TopoDS::Edge(edgeMap(i).Oriented(TopAbs_FORWARD));
+            polygons.polygon1 = BRep_Tool::PolygonOnTriangulation(polygons.edge, triangulation, loc);
+            if (polygons.polygon1.IsNull())
+                continue;
+            if (BRep_Tool::IsClosed(polygons.edge, face)) {
+                polygons.polygon2 = BRep_Tool::PolygonOnTriangulation(
+                    TopoDS::Edge(polygons.edge.Reversed()), triangulation, loc);
+            }
+
+            memory += memoryOf(polygons.polygon1) + memoryOf(polygons.polygon2);
+            edges.push_back(polygons);
+        }
+
+        return true;
+    }
+
+    /// Puts the triangulation back to \a face which must have no location.
+    void write(const TopoDS_Face& face) const
+    {
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) current = BRep_Tool::Triangulation(face, loc);
+        if (current == triangulation)
+            return;
+        // like BRepMesh keep a finer triangulation
+        if (!current.IsNull() && current->Deflection() <= triangulation->Deflection())
+            return;
+
+        BRep_Builder builder;
+        builder.UpdateFace(face, triangulation);
+        for (const auto& it : edges) {
+            if (it.polygon2.IsNull())
+                builder.UpdateEdge(it.edge, it.polygon1, triangulation, loc);
+            else
+                builder.UpdateEdge(it.edge, it.polygon1, it.polygon2, triangulation, loc);
+        }
+    }
+};
+
+bool TessellationCache::Key::operator < (const Key& key) const
+{
+    return std::tie(tshape, deflection, angularDeflection, relative) <
+           std::tie(key.tshape, key.deflection, key.angularDeflection, key.relative);
+}
+
+TessellationCache& TessellationCache::instance()
+{
+    // never destroyed as the handles must not be released after OCC has shut down
+    static TessellationCache* cache = new TessellationCache();
+    return *cache;
+}
+
+TessellationCache::TessellationCache()
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Mod/Part/General");
+    maxMemory = static_cast<std::size_t>(hGrp->GetUnsigned("TessellationCacheSize", 256)) * 1024 * 1024;
+}
+
+TessellationCache::~TessellationCache()
+{
+}
+
+void TessellationCache::mesh(const TopoDS_Shape& shape, double deflection, double angularDeflection,
+                             bool relative)
+{
+    if (shape.IsNull())
+        return;
+
+    // The triangulation is stored at the TShape, so each face is handled only once
+    // and without its location.
+    std::vector<TopoDS_Face> faces;
+    std::set<const TopoDS_TShape*> visited;
+    TopTools_IndexedMapOfShape faceMap;
+    TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+    for (int i=1; i<=faceMap.Extent(); i++) {
+        TopoDS_Face face = TopoDS::Face(faceMap(i).Oriented(TopAbs_FORWARD));
+        face.Location(TopLoc_Location());
+        if (visited.insert(face.TShape().get()).second)
+            faces.push_back(face);
+    }
+
+    // the mesher also writes the polygons of the edges, which may be shared with other faces
+    TopTools_IndexedMapOfShape edgeMap;
+    TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+    for (int i=1; i<=edgeMap.Extent(); i++)
+        visited.insert(edgeMap(i).TShape().get());
+    Lock meshLock(*this, std::vector<const TopoDS_TShape*>(visited.begin(), visited.end()));
+
+    std::vector<TopoDS_Face> missing;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& face : faces) {
+            auto it = entries.find(Key{face.TShape().get(), deflection, angularDeflection, relative});
+            if (it == entries.end()) {
+                missing.push_back(face);
+                stats.misses++;
+            }
+            else {
+                it->second->write(face);
+                usage.splice(usage.begin(), usage, it->second->usage);
+                stats.hits++;
+            }
+        }
+    }
+
+    // faces with a suitable triangulation are skipped by the mesher
+    BRepMesh_IncrementalMesh(shape, deflection, relative, angularDeflection, Standard_True);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& face : missing) {
+        Key key{face.TShape().get(), deflection, angularDeflection, relative};
+        std::unique_ptr<Entry> entry(new Entry);
+        if (!entry->read(face))
+            continue;
+
+        usage.push_front(key);
+        entry->usage = usage.begin();
+        stats.memory += entry->memory;
+        entries[key] = std::move(entry);
+        addedSinceCheck++;
+    }
+
+    // checking all entries is only worth it when many were added in the meantime
+    if (addedSinceCheck > 64 && addedSinceCheck > entries.size() / 4)
+        removeUnused();
+    stats.entries = entries.size();
+    evict();
+}
+
+void TessellationCache::removeUnused()
+{
+    addedSinceCheck = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+        // the face can never be meshed again if only the cache refers to it
+        if (it->second->tshape->GetRefCount() == 1 && !locked.count(it->first.tshape)) {
+            stats.memory -= it->second->memory;
+            usage.erase(it->second->usage);
+            it = entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void TessellationCache::evict()
+{
+    if (stats.memory > maxMemory)
+        removeUnused();
+    while (stats.memory > maxMemory && !usage.empty()) {
+        auto it = entries.find(usage.back());
+        stats.memory -= it->second->memory;
+        entries.erase(it);
+        usage.pop_back();
+    }
+
+    stats.entries = entries.size();
+}
+
+void TessellationCache::setMaxMemory(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    maxMemory = bytes;
+    evict();
+}
+
+std::size_t TessellationCache::getMaxMemory() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxMemory;
+}
+
+void TessellationCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    usage.clear();
+    stats = Statistics();
+    addedSinceCheck = 0;
+}
+
+TessellationCache::Statistics TessellationCache::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
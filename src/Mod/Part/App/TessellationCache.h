@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef PART_TESSELLATIONCACHE_H
+#define PART_TESSELLATIONCACHE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include <Mod/Part/PartGlobal.h>
+
+class TopoDS_Shape;
+class TopoDS_TShape;
+
+namespace Part
+{
+
+/**
+ * The TessellationCache class keeps the triangulations of faces for re-use.
+ *
+ * OCC stores the triangulation of a face at its TShape, so it is lost when
+ * BRepTools::Clean() is called or when the face is meshed with other parameters
+ * in between, e.g. once for the 3D view and once for an export. The cache keeps
+ * the triangulation and the polygons of the edges of each face for each set of
+ * mesh parameters. Before a shape is meshed the cached triangulations are put back
+ * to its faces so that BRepMesh_IncrementalMesh only has to mesh the faces which
+ * are new, e.g. the faces modified by a boolean operation.
+ *
+ * The least recently used entries are removed when the memory limit is exceeded.
+ * Entries of faces which are not used anywhere else are removed, too, so that the
+ * cache does not keep otherwise deleted faces and their surfaces alive.
+ *
+ * The cache is shared by the whole process. mesh() may be called from several
+ * threads: the faces and edges of a shape are locked while they are meshed, so a
+ * second call with a shape sharing some of them waits. Reading the triangulation
+ * of a shape while another thread meshes it is not safe.
+ */
+class PartExport TessellationCache
+{
+public:
+    struct Statistics
+    {
+        /// number of faces whose triangulation could be re-used
+        std::size_t hits = 0;
+        /// number of faces which had to be meshed
+        std::size_t misses = 0;
+        /// number of cached triangulations
+        std::size_t entries = 0;
+        /// estimated memory of the cached triangulations in bytes
+        std::size_t memory = 0;
+    };
+
+    static TessellationCache& instance();
+
+    /** Makes sure that all faces of \a shape are triangulated with the given parameters.
+     * This replaces a call of BRepMesh_IncrementalMesh.
+     */
+    void mesh(const TopoDS_Shape& shape, double deflection, double angularDeflection,
+              bool relative = false);
+
+    /// Sets the memory limit in bytes.
+    void setMaxMemory(std::size_t bytes);
+    std::size_t getMaxMemory() const;
+    /// Removes all entries and resets the statistics.
+    void clear();
+    Statistics getStatistics() const;
+
+private:
+    TessellationCache();
+    ~TessellationCache();
+
+    TessellationCache(const TessellationCache&) = delete;
+    TessellationCache& operator = (const TessellationCache&) = delete;
+
+    struct Key
+    {
+        const TopoDS_TShape* tshape;
+        double deflection;
+        double angularDeflection;
+        bool relative;
+        bool operator < (const Key&) const;
+    };
+    struct Entry;
+    typedef std::list<Key> UsageList;
+    class Lock;
+
+    void evict();
+    void removeUnused();
+
+private:
+    mutable std::mutex mutex;
+    std::map<Key, std::unique_ptr<Entry> > entries;
+    UsageList usage;
+    Statistics stats;
+    std::size_t maxMemory;
+    std::size_t addedSinceCheck = 0;
+    /// the faces and edges which are currently meshed
+    std::set<const TopoDS_TShape*> locked;
+    std::condition_variable unlocked;
+};
+
+} //namespace Part
+
+
+#endif // PART_TESSELLATIONCACHE_H
@@ -63,7 +63,6 @@
 # include <BRepLib.hxx>
 # include <BRepLib_FindSurface.hxx>
 # include <BRepLProp_SLProps.hxx>
-# include <BRepMesh_IncrementalMesh.hxx>
 # include <BRepOffsetAPI_MakeOffset.hxx>
 # include <BRepOffsetAPI_MakeOffsetShape.hxx>
 # include <BRepOffsetAPI_MakePipe.hxx>
@@ -107,6 +106,7 @@
 # include <GeomFill_SectionLaw.hxx>
 # include <GeomFill_Sweep.hxx>
 # include <GeomLib.hxx>
+# include <GeomTools.hxx>
 # include <gp_Circ.hxx>
 # include <gp_Pln.hxx>
 # include <GProp_GProps.hxx>
@@ -162,6 +162,7 @@
 #endif // _PreComp_
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <QCryptographicHash>
 
 #include <App/Material.h>
 #include <Base/BoundBox.h>
@@ -173,12 +174,14 @@
 
 #include "TopoShape.h"
 #include "BRepOffsetAPI_MakeOffsetFix.h"
+#include "ClusterFuse.h"
 #include "CrossSection.h"
 #include "encodeFilename.h"
 #include "FaceMakerBullseye.h"
 #include "modelRefine.h"
 #include "PartPyCXX.h"
 #include "ProgressIndicator.h"
+#include "TessellationCache.h"
 #include "Tools.h"
 #include "TopoShapeCompoundPy.h"
 #include "TopoShapeCompSolidPy.h"
@@ -1032,11 +1035,8 @@ void TopoShape::dump(std::ostream& out) const
 void TopoShape::exportStl(const char *filename, double deflection) const
 {
     StlAPI_Writer writer;
-    BRepMesh_IncrementalMesh aMesh(this->_Shape, deflection,
-                                   /*isRelative*/ Standard_False,
-                                   /*theAngDeflection*/
-                                   defaultAngularDeflection(deflection),
-                                   /*isInParallel*/ true);
+    TessellationCache::instance().mesh(this->_Shape, deflection,
+                                       defaultAngularDeflection(deflection));
     writer.Write(this->_Shape,encodeFilename(filename).c_str());
 }
 
@@ -1054,11 +1054,7 @@ void TopoShape::exportFaceSet(double dev, double ca,
     bool supportFaceColors = (numFaces == colors.size());
 
     std::size_t index=0;
-    BRepMesh_IncrementalMesh MESH(this->_Shape, dev,
-                                  /*isRelative*/ Standard_False,
-                                  /*theAngDeflection*/
-                                  defaultAngularDeflection(dev),
-                                  /*isInParallel*/ true);
+    TessellationCache::instance().mesh(this->_Shape, dev, defaultAngularDeflection(dev));
     for (ex.Init(this->_Shape, TopAbs_FACE); ex.More(); ex.Next(), index++) {
         // get the shape and mesh it
         const TopoDS_Face& aFace = TopoDS::Face(ex.Current());
@@ -1362,6 +1358,80 @@ unsigned int TopoShape::getMemSize (void) const
     return sizeof(TopoDS_Shape);
 }
 
+std::string TopoShape::getFingerprint() const
+{
+    if (_Shape.IsNull())
+        return std::string();
+
+    auto writeLocation = [](std::ostream& str, const TopLoc_Location& loc) {
+        const gp_Trsf& trsf = loc.Transformation();
+        for (int row=1; row<=3; row++) {
+            for (int col=1; col<=4; col++)
+                str << trsf.Value(row, col) << ' ';
+        }
+    };
+
+    // Each sub-shape is described by its type, its geometry and the indices and
+    // orientations of its children.
+    TopTools_IndexedMapOfShape M;
+    TopExp::MapShapes(_Shape, M);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (int i=1; i<=M.Extent(); i++) {
+        const TopoDS_Shape& shape = M(i);
+        std::ostringstream str;
+        str.precision(17);
+        str << static_cast<int>(shape.ShapeType()) << '\n';
+
+        switch (shape.ShapeType())
+        {
+        case TopAbs_VERTEX:
+            {
+                const TopoDS_Vertex& vertex = TopoDS::Vertex(shape);
+                gp_Pnt pnt = BRep_Tool::Pnt(vertex);
+                str << pnt.X() << ' ' << pnt.Y() << ' ' << pnt.Z() << ' '
+                    << BRep_Tool::Tolerance(vertex) << '\n';
+            } break;
+        case TopAbs_EDGE:
+            {
+                const TopoDS_Edge& edge = TopoDS::Edge(shape);
+                TopLoc_Location loc;
+                Standard_Real first, last;
+                Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, loc, first, last);
+                if (!curve.IsNull()) {
+                    GeomTools::Write(curve, str);
+                    writeLocation(str, loc);
+                    str << first << ' ' << last << ' ';
+                }
+                str << BRep_Tool::Tolerance(edge) << ' ' << BRep_Tool::Degenerated(edge) << '\n';
+            } break;
+        case TopAbs_FACE:
+            {
+                const TopoDS_Face& face = TopoDS::Face(shape);
+                TopLoc_Location loc;
+                Handle(Geom_Surface) surface = BRep_Tool::Surface(face, loc);
+                if (!surface.IsNull()) {
+                    GeomTools::Write(surface, str);
+                    writeLocation(str, loc);
+                }
+                str << BRep_Tool::Tolerance(face) << '\n';
+            } break;
+        default:
+            break;
+        }
+
+        for (TopoDS_Iterator it(shape); it.More(); it.Next())
+            str << M.FindIndex(it.Value()) << ' ' << static_cast<int>(it.Value().Orientation()) << ' ';
+        str << '\n';
+
+        std::string data = str.str();
+        hash.addData(data.c_str(), static_cast<int>(data.size()));
+    }
+
+    std::string orientation = std::to_string(static_cast<int>(_Shape.Orientation()));
+    hash.addData(orientation.c_str(), static_cast<int>(orientation.size()));
+    return std::string(hash.result().toHex().constData());
+}
+
 bool TopoShape::isNull() const
 {
     return this->_Shape.IsNull() ? true : false;
@@ -1369,7 +1439,12 @@ bool TopoShape::isNull() const
 
 bool TopoShape::isValid() const
 {
+#if OCC_VERSION_HEX >= 0x070600
+    // the sub-shapes are checked in parallel
+    BRepCheck_Analyzer aChecker(this->_Shape, Standard_True, Standard_True);
+#else
     BRepCheck_Analyzer aChecker(this->_Shape);
+#endif
     return aChecker.IsValid() ? true : false;
 }
 
@@ -1799,25 +1874,19 @@ TopoDS_Shape TopoShape::fuse(const std::vector<TopoDS_Shape>& shapes, Standard_R
         resShape = mkFuse.Shape();
     }
 #else
-    BRepAlgoAPI_Fuse mkFuse;
-# if OCC_VERSION_HEX >= 0x060900
-    mkFuse.SetRunParallel(true);
-# endif
-    TopTools_ListOfShape shapeArguments,shapeTools;
-    shapeArguments.Append(this->_Shape);
+    // shapes that cannot touch each other are fused independently
+    std::vector<TopoDS_Shape> arguments;
+    arguments.push_back(this->_Shape);
     for (std::vector<TopoDS_Shape>::const_iterator it = shapes.begin(); it != shapes.end(); ++it) {
         if (it->IsNull())
             throw NullShapeException("Tool shape is null");
         if (tolerance > 0.0)
             // workaround for http://dev.opencascade.org/index.php?q=node/1056#comment-520
-            shapeTools.Append(BRepBuilderAPI_Copy(*it).Shape());
+            arguments.push_back(BRepBuilderAPI_Copy(*it).Shape());
         else
-            shapeTools.Append(*it);
+            arguments.push_back(*it);
     }
-    mkFuse.SetArguments(shapeArguments);
-    mkFuse.SetTools(shapeTools);
-    if (tolerance > 0.0)
-        mkFuse.SetFuzzyValue(tolerance);
+    ClusterFuse mkFuse(arguments, tolerance);
     mkFuse.Build();
     if (!mkFuse.IsDone())
         throw Base::RuntimeError("Multi fuse failed");
@@ -1908,13 +1977,10 @@ std::list<TopoDS_Wire> TopoShape::slice(const Base::Vector3d& dir, double d) con
     return cs.slice(d);
 }
 
-TopoDS_Compound TopoShape::slices(const Base::Vector3d& dir, const std::vector<double>& d) const
+TopoDS_Compound TopoShape::slices(const Base::Vector3d& dir, const std::vector<double>& d, bool parallel) const
 {
-    std::vector< std::list<TopoDS_Wire> > wire_list;
     CrossSection cs(dir.x, dir.y, dir.z, this->_Shape);
-    for (std::vector<double>::const_iterator jt = d.begin(); jt != d.end(); ++jt) {
-        wire_list.push_back(cs.slice(*jt));
-    }
+    std::vector< std::list<TopoDS_Wire> > wire_list = cs.slices(d, parallel);
 
     std::vector< std::list<TopoDS_Wire> >::const_iterator ft;
     TopoDS_Compound comp;
@@ -3413,11 +3479,7 @@ void TopoShape::getFaces(std::vector<Base::Vector3d> &aPoints,
         return;
 
     // get the meshes of all faces and then merge them
-    BRepMesh_IncrementalMesh aMesh(this->_Shape, accuracy,
-                                   /*isRelative*/ Standard_False,
-                                   /*theAngDeflection*/
-                                   defaultAngularDeflection(accuracy),
-                                   /*isInParallel*/ true);
+    TessellationCache::instance().mesh(this->_Shape, accuracy, defaultAngularDeflection(accuracy));
     std::vector<Domain> domains;
     getDomains(domains);
 
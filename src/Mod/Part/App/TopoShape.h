@@ -204,6 +204,12 @@ public:
     bool findPlane(gp_Pln &pln, double tol=-1) const;
     /// Returns true if the expansion of the shape is infinite, false otherwise
     bool isInfinite() const;
+    /** Returns a hash of the topology and the geometry of the shape as hex string.
+     * Shapes with the same fingerprint are built of the same geometry in the same
+     * way, even if they don't share any data. Triangulations are not taken into
+     * account. The fingerprint of a null shape is empty.
+     */
+    std::string getFingerprint() const;
     //@}
 
     /** @name Boolean operation*/
@@ -218,7 +224,7 @@ public:
     TopoDS_Shape section(TopoDS_Shape, Standard_Boolean approximate=Standard_False) const;
     TopoDS_Shape section(const std::vector<TopoDS_Shape>&, Standard_Real tolerance = 0.0, Standard_Boolean approximate=Standard_False) const;
     std::list<TopoDS_Wire> slice(const Base::Vector3d&, double) const;
-    TopoDS_Compound slices(const Base::Vector3d&, const std::vector<double>&) const;
+    TopoDS_Compound slices(const Base::Vector3d&, const std::vector<double>&, bool parallel = false) const;
     /**
      * @brief generalFuse: run general fuse algorithm between this and shapes
      * supplied as sOthers
@@ -1022,10 +1022,14 @@ PyObject*  TopoShapePy::slice(PyObject *args)
     }
 }
 
-PyObject*  TopoShapePy::slices(PyObject *args)
+PyObject*  TopoShapePy::slices(PyObject *args, PyObject *kwds)
 {
+    static char *kwlist[] = {"Direction", "Distances", "Parallel", nullptr};
+
     PyObject *dir, *dist;
-    if (!PyArg_ParseTuple(args, "O!O", &(Base::VectorPy::Type), &dir, &dist))
+    PyObject *parallel = Py_False;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O|O!", kwlist, &(Base::VectorPy::Type), &dir, &dist,
+                                     &PyBool_Type, &parallel))
         return nullptr;
 
     try {
@@ -1035,7 +1039,7 @@ PyObject*  TopoShapePy::slices(PyObject *args)
         d.reserve(list.size());
         for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it)
             d.push_back((double)Py::Float(*it));
-        TopoDS_Compound slice = this->getTopoShapePtr()->slices(vec, d);
+        TopoDS_Compound slice = this->getTopoShapePtr()->slices(vec, d, PyObject_IsTrue(parallel) ? true : false);
         return new TopoShapeCompoundPy(new TopoShape(slice));
     }
     catch (Standard_Failure& e) {
@@ -1934,6 +1938,21 @@ PyObject* TopoShapePy::hashCode(PyObject *args)
     return Py_BuildValue("i", hc);
 }
 
+PyObject* TopoShapePy::fingerprint(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return nullptr;
+
+    try {
+        std::string fp = getTopoShapePtr()->getFingerprint();
+        return Py::new_reference_to(Py::String(fp));
+    }
+    catch (Standard_Failure& e) {
+        PyErr_SetString(PartExceptionOCCError, e.GetMessageString());
+        return nullptr;
+    }
+}
+
 PyObject* TopoShapePy::tessellate(PyObject *args)
 {
     float tolerance;
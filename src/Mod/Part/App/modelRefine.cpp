@@ -25,6 +25,8 @@
 #ifndef _PreComp_
 # include <algorithm>
 # include <iterator>
+# include <set>
+# include <string>
 # include <Bnd_Box.hxx>
 # include <BRep_Builder.hxx>
 # include <BRep_Tool.hxx>
@@ -48,6 +50,7 @@
 # include <gp_Cylinder.hxx>
 # include <gp_Pln.hxx>
 # include <GProp_GProps.hxx>
+# include <NCollection_DataMap.hxx>
 # include <ShapeAnalysis_Curve.hxx>
 # include <ShapeAnalysis_Shell.hxx>
 # include <ShapeBuild_ReShape.hxx>
@@ -64,9 +67,13 @@
 # include <TopTools_DataMapIteratorOfDataMapOfIntegerListOfShape.hxx>
 # include <TopTools_DataMapIteratorOfDataMapOfShapeShape.hxx>
 # include <TopTools_ListIteratorOfListOfShape.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
 # include <TopTools_ListOfShape.hxx>
+# include <TopTools_ShapeMapHasher.hxx>
 #endif // _PreComp_
 
+#include <QtConcurrentMap>
+
 #include <Base/Console.h>
 
 #include "modelRefine.h"
@@ -85,7 +92,11 @@ void ModelRefine::getFaceEdges(const TopoDS_Face &face, EdgeVectorType &edges)
 void ModelRefine::boundaryEdges(const FaceVectorType &faces, EdgeVectorType &edgesOut)
 {
     //this finds all the boundary edges. Maybe more than one boundary.
-    std::list<TopoDS_Edge> edges;
+    //an edge used twice is an inner edge. The position of each edge in the list is
+    //kept in a map so that the list doesn't have to be searched.
+    typedef std::list<TopoDS_Edge> EdgeListType;
+    EdgeListType edges;
+    NCollection_DataMap<TopoDS_Shape, EdgeListType::iterator, TopTools_ShapeMapHasher> positions;
     FaceVectorType::const_iterator faceIt;
     for (faceIt = faces.begin(); faceIt != faces.end(); ++faceIt)
     {
@@ -94,19 +105,17 @@ void ModelRefine::boundaryEdges(const FaceVectorType &faces, EdgeVectorType &edg
         getFaceEdges(*faceIt, faceEdges);
         for (faceEdgesIt = faceEdges.begin(); faceEdgesIt != faceEdges.end(); ++faceEdgesIt)
         {
-            bool foundSignal(false);
-            std::list<TopoDS_Edge>::iterator edgesIt;
-            for (edgesIt = edges.begin(); edgesIt != edges.end(); ++edgesIt)
+            EdgeListType::iterator *position = positions.ChangeSeek(*faceEdgesIt);
+            if (position)
             {
-                if ((*edgesIt).IsSame(*faceEdgesIt))
-                {
-                    edgesIt = edges.erase(edgesIt);
-                    foundSignal = true;
-                    break;
-                }
+                edges.erase(*position);
+                positions.UnBind(*faceEdgesIt);
             }
-            if (!foundSignal)
+            else
+            {
                 edges.push_back(*faceEdgesIt);
+                positions.Bind(*faceEdgesIt, std::prev(edges.end()));
+            }
         }
     }
 
@@ -206,7 +215,7 @@ void FaceAdjacencySplitter::split(const FaceVectorType &facesIn)
     for (it = facesIn.begin(); it != facesIn.end(); ++it)
         facesInMap.Add(*it);
     //the reserve call guarantees the vector will never get "pushed back" in the
-    //recursiveFind calls, thus invalidating the iterators. We can be sure of this as any one
+    //findAdjacent calls, thus invalidating the iterators. We can be sure of this as any one
     //matched set can't be bigger than the set passed in. if we have seg faults, we will
     //want to turn this tempFaces vector back into a std::list ensuring valid iterators
     //at the expense of std::find speed.
@@ -221,7 +230,7 @@ void FaceAdjacencySplitter::split(const FaceVectorType &facesIn)
 
         tempFaces.clear();
         processedMap.Add(*it);
-        recursiveFind(*it, tempFaces);
+        findAdjacent(*it, tempFaces);
         if (tempFaces.size() > 1)
         {
             adjacencyArray.push_back(tempFaces);
@@ -229,25 +238,51 @@ void FaceAdjacencySplitter::split(const FaceVectorType &facesIn)
     }
 }
 
-void FaceAdjacencySplitter::recursiveFind(const TopoDS_Face &face, FaceVectorType &outVector)
+void FaceAdjacencySplitter::findAdjacent(const TopoDS_Face &face, FaceVectorType &outVector)
 {
-    outVector.push_back(face);
-
-    const TopTools_ListOfShape &edges = faceToEdgeMap.FindFromKey(face);
-    TopTools_ListIteratorOfListOfShape edgeIt;
-    for (edgeIt.Initialize(edges); edgeIt.More(); edgeIt.Next())
+    //depth first search with an explicit stack, so a large group of faces can't overflow
+    //the call stack. The faces are found in the same order as with a recursive search.
+    struct Frame
     {
-        const TopTools_ListOfShape &faces = edgeToFaceMap.FindFromKey(edgeIt.Value());
+        TopTools_ListIteratorOfListOfShape edgeIt;
         TopTools_ListIteratorOfListOfShape faceIt;
-        for (faceIt.Initialize(faces); faceIt.More(); faceIt.Next())
+    };
+    std::vector<Frame> stack;
+    auto visit = [&](const TopoDS_Shape &current)
+    {
+        outVector.push_back(TopoDS::Face(current));
+        Frame frame;
+        frame.edgeIt.Initialize(faceToEdgeMap.FindFromKey(current));
+        if (frame.edgeIt.More())
+            frame.faceIt.Initialize(edgeToFaceMap.FindFromKey(frame.edgeIt.Value()));
+        stack.push_back(frame);
+    };
+
+    visit(face);
+    while (!stack.empty())
+    {
+        Frame &frame = stack.back();
+        if (!frame.edgeIt.More())
         {
-            if (!facesInMap.Contains(faceIt.Value()))
-                continue;
-            if (processedMap.Contains(faceIt.Value()))
-                continue;
-            processedMap.Add(faceIt.Value());
-            recursiveFind(TopoDS::Face(faceIt.Value()), outVector);
+            stack.pop_back();
+            continue;
         }
+        if (!frame.faceIt.More())
+        {
+            frame.edgeIt.Next();
+            if (frame.edgeIt.More())
+                frame.faceIt.Initialize(edgeToFaceMap.FindFromKey(frame.edgeIt.Value()));
+            continue;
+        }
+
+        TopoDS_Shape current = frame.faceIt.Value();
+        frame.faceIt.Next();
+        if (!facesInMap.Contains(current))
+            continue;
+        if (processedMap.Contains(current))
+            continue;
+        processedMap.Add(current);
+        visit(current);
     }
 }
 
@@ -302,15 +337,41 @@ void FaceTypedBase::boundarySplit(const FaceVectorType &facesIn, std::vector<Edg
     EdgeVectorType bEdges;
     boundaryEdges(facesIn, bEdges);
 
-    std::list<TopoDS_Edge> edges;
-    std::copy(bEdges.begin(), bEdges.end(), back_inserter(edges));
-    while(!edges.empty())
+    //a boundary starts with the first unused edge and is continued with the first unused
+    //edge that starts at its last vertex. The edges are indexed by their first vertex so
+    //that the list of edges doesn't have to be searched for each step.
+    std::vector<bool> used(bEdges.size(), false);
+    NCollection_DataMap<TopoDS_Shape, std::vector<std::size_t>, TopTools_ShapeMapHasher> startMap;
+    for (std::size_t index = 0; index < bEdges.size(); ++index)
+    {
+        TopoDS_Vertex firstVertex = TopExp::FirstVertex(bEdges[index], Standard_True);
+        if (!startMap.IsBound(firstVertex))
+            startMap.Bind(firstVertex, std::vector<std::size_t>());
+        startMap.ChangeFind(firstVertex).push_back(index);
+    }
+    auto nextEdge = [&](const TopoDS_Vertex &vertex)
     {
-        TopoDS_Vertex destination = TopExp::FirstVertex(edges.front(), Standard_True);
-        TopoDS_Vertex lastVertex = TopExp::LastVertex(edges.front(), Standard_True);
+        const std::vector<std::size_t> *indices = startMap.Seek(vertex);
+        if (indices)
+        {
+            for (std::size_t index : *indices)
+            {
+                if (!used[index])
+                    return index;
+            }
+        }
+        return bEdges.size();
+    };
+
+    for (std::size_t start = 0; start < bEdges.size(); ++start)
+    {
+        if (used[start])
+            continue;
+        used[start] = true;
+        TopoDS_Vertex destination = TopExp::FirstVertex(bEdges[start], Standard_True);
+        TopoDS_Vertex lastVertex = TopExp::LastVertex(bEdges[start], Standard_True);
         EdgeVectorType boundary;
-        boundary.push_back(edges.front());
-        edges.pop_front();
+        boundary.push_back(bEdges[start]);
         //single edge closed check.
         if (destination.IsSame(lastVertex))
         {
@@ -319,24 +380,16 @@ void FaceTypedBase::boundarySplit(const FaceVectorType &facesIn, std::vector<Edg
         }
 
         bool closedSignal(false);
-        std::list<TopoDS_Edge>::iterator it;
-        for (it = edges.begin(); it != edges.end();)
+        for (std::size_t index = nextEdge(lastVertex); index < bEdges.size(); index = nextEdge(lastVertex))
         {
-            TopoDS_Vertex currentVertex = TopExp::FirstVertex(*it, Standard_True);
-            if (lastVertex.IsSame(currentVertex))
+            used[index] = true;
+            boundary.push_back(bEdges[index]);
+            lastVertex = TopExp::LastVertex(bEdges[index], Standard_True);
+            if (lastVertex.IsSame(destination))
             {
-                boundary.push_back(*it);
-                lastVertex = TopExp::LastVertex(*it, Standard_True);
-                edges.erase(it);
-                it = edges.begin();
-                if (lastVertex.IsSame(destination))
-                {
-                    closedSignal = true;
-                    break;
-                }
-                continue;
+                closedSignal = true;
+                break;
             }
-            ++it;
         }
         if (closedSignal)
             boundariesOut.push_back(boundary);
@@ -1021,6 +1074,74 @@ FaceTypedBSpline& ModelRefine::getBSplineObject()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+struct FaceGroup
+{
+    FaceTypedBase *type;
+    FaceVectorType faces;
+    TopoDS_Face newFace;
+    std::string error;
+};
+
+//the groups are independent but building a face may update the tolerance or the
+//pcurves of its boundary. So groups sharing a vertex are never built at the same time
+//but in successive rounds.
+void buildFaces(std::vector<FaceGroup> &groups)
+{
+    std::vector<std::vector<FaceGroup*> > rounds;
+    std::vector<std::set<const TopoDS_TShape*> > roundVertices;
+    for (auto &group : groups)
+    {
+        TopTools_IndexedMapOfShape vertexMap;
+        for (const auto &face : group.faces)
+            TopExp::MapShapes(face, TopAbs_VERTEX, vertexMap);
+
+        std::size_t round = 0;
+        for (; round < rounds.size(); ++round)
+        {
+            const std::set<const TopoDS_TShape*> &used = roundVertices[round];
+            bool shared = false;
+            for (int i = 1; i <= vertexMap.Extent() && !shared; ++i)
+                shared = used.find(vertexMap(i).TShape().get()) != used.end();
+            if (!shared)
+                break;
+        }
+        if (round == rounds.size())
+        {
+            rounds.emplace_back();
+            roundVertices.emplace_back();
+        }
+        rounds[round].push_back(&group);
+        for (int i = 1; i <= vertexMap.Extent(); ++i)
+            roundVertices[round].insert(vertexMap(i).TShape().get());
+    }
+
+    for (auto &round : rounds)
+    {
+        QtConcurrent::blockingMap(round, [](FaceGroup *group)
+        {
+            try
+            {
+                group->newFace = group->type->buildFace(group->faces);
+            }
+            catch (const Standard_Failure &e)
+            {
+                group->error = e.GetMessageString();
+                if (group->error.empty())
+                    group->error = "Unknown OCC exception";
+            }
+        });
+    }
+
+    //report the first failure like a serial loop would have done
+    for (const auto &group : groups)
+    {
+        if (!group.error.empty())
+            Standard_Failure::Raise(group.error.c_str());
+    }
+}
+}
+
 FaceUniter::FaceUniter(const TopoDS_Shell &shellIn) : modifiedSignal(false)
 {
     workShell = shellIn;
@@ -1050,6 +1171,8 @@ bool FaceUniter::process()
 
     ModelRefine::FaceAdjacencySplitter adjacencySplitter(workShell);
 
+    // collect the groups of faces to unite first, then build the new faces in parallel
+    std::vector<FaceGroup> groups;
     for(typeIt = typeObjects.begin(); typeIt != typeObjects.end(); ++typeIt)
     {
         ModelRefine::FaceVectorType typedFaces = splitter.getTypedFaceVector((*typeIt)->getType());
@@ -1062,31 +1185,37 @@ bool FaceUniter::process()
             for (std::size_t adjacentIndex(0); adjacentIndex < adjacencySplitter.getGroupCount(); ++adjacentIndex)
             {
 //                    std::cout << "         face count is: " << adjacencySplitter.getGroup(adjacentIndex).size() << std::endl;
-                TopoDS_Face newFace = (*typeIt)->buildFace(adjacencySplitter.getGroup(adjacentIndex));
-                if (!newFace.IsNull())
-                {
-                    // the created face should have the same orientation as the input faces
-                    const FaceVectorType& faces = adjacencySplitter.getGroup(adjacentIndex);
-                    if (!faces.empty() && newFace.Orientation() != faces[0].Orientation()) {
-                        checkFinalShell = true;
-                    }
-                    facesToSew.push_back(newFace);
-                    if (facesToRemove.capacity() <= facesToRemove.size() + adjacencySplitter.getGroup(adjacentIndex).size())
-                        facesToRemove.reserve(facesToRemove.size() + adjacencySplitter.getGroup(adjacentIndex).size());
-                    FaceVectorType temp = adjacencySplitter.getGroup(adjacentIndex);
-                    facesToRemove.insert(facesToRemove.end(), temp.begin(), temp.end());
-                    // the first shape will be marked as modified, i.e. replaced by newFace, all others are marked as deleted
-                    // jrheinlaender: IMHO this is not correct because references to the deleted faces will be broken, whereas they should
-                    // be replaced by references to the new face. To achieve this all shapes should be marked as
-                    // modified, producing one single new face. This is the inverse behaviour to faces that are split e.g.
-                    // by a boolean cut, where one old shape is marked as modified, producing multiple new shapes
-                    if (!temp.empty())
-                    {
-                        for (FaceVectorType::iterator f = temp.begin(); f != temp.end(); ++f)
-                              modifiedShapes.emplace_back(*f, newFace);
-                    }
-                }
+                FaceGroup group;
+                group.type = *typeIt;
+                group.faces = adjacencySplitter.getGroup(adjacentIndex);
+                groups.push_back(group);
+            }
+        }
+    }
+
+    buildFaces(groups);
+
+    for (const auto &group : groups)
+    {
+        const TopoDS_Face &newFace = group.newFace;
+        if (!newFace.IsNull())
+        {
+            // the created face should have the same orientation as the input faces
+            const FaceVectorType& faces = group.faces;
+            if (!faces.empty() && newFace.Orientation() != faces[0].Orientation()) {
+                checkFinalShell = true;
             }
+            facesToSew.push_back(newFace);
+            if (facesToRemove.capacity() <= facesToRemove.size() + faces.size())
+                facesToRemove.reserve(facesToRemove.size() + faces.size());
+            facesToRemove.insert(facesToRemove.end(), faces.begin(), faces.end());
+            // the first shape will be marked as modified, i.e. replaced by newFace, all others are marked as deleted
+            // jrheinlaender: IMHO this is not correct because references to the deleted faces will be broken, whereas they should
+            // be replaced by references to the new face. To achieve this all shapes should be marked as
+            // modified, producing one single new face. This is the inverse behaviour to faces that are split e.g.
+            // by a boolean cut, where one old shape is marked as modified, producing multiple new shapes
+            for (FaceVectorType::const_iterator f = faces.begin(); f != faces.end(); ++f)
+                modifiedShapes.emplace_back(*f, newFace);
         }
     }
     if (facesToSew.size() > 0)
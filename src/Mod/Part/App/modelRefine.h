@@ -134,7 +134,7 @@ namespace ModelRefine
 
     private:
         FaceAdjacencySplitter(){}
-        void recursiveFind(const TopoDS_Face &face, FaceVectorType &outVector);
+        void findAdjacent(const TopoDS_Face &face, FaceVectorType &outVector);
         std::vector<FaceVectorType> adjacencyArray;
         TopTools_MapOfShape processedMap;
         TopTools_MapOfShape facesInMap;
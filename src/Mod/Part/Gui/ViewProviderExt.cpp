@@ -29,7 +29,6 @@
 # include <BRepBndLib.hxx>
 # include <BRepBuilderAPI_MakeVertex.hxx>
 # include <BRepExtrema_DistShapeShape.hxx>
-# include <BRepMesh_IncrementalMesh.hxx>
 # include <gp_Trsf.hxx>
 # include <Precision.hxx>
 # include <Poly_Array1OfTriangle.hxx>
@@ -50,7 +49,9 @@
 # include <TopTools_IndexedMapOfShape.hxx>
 
 # include <QAction>
+# include <QtConcurrentMap>
 # include <QMenu>
+# include <algorithm>
 # include <sstream>
 
 # include <Inventor/SoPickedPoint.h>
@@ -82,6 +83,7 @@
 #include <Gui/SoFCSelectionAction.h>
 #include <Gui/SoFCUnifiedSelection.h>
 #include <Gui/ViewParams.h>
+#include <Mod/Part/App/TessellationCache.h>
 #include <Mod/Part/App/Tools.h>
 
 #include "ViewProviderExt.h"
@@ -951,26 +953,44 @@ void ViewProviderPartExt::updateVisual()
 
         // create or use the mesh on the data structure
         Standard_Real AngDeflectionRads = AngularDeflection.getValue() / 180.0 * M_PI;
-        BRepMesh_IncrementalMesh(cShape, deflection, Standard_False, AngDeflectionRads, Standard_True);
+        Part::TessellationCache::instance().mesh(cShape, deflection, AngDeflectionRads);
 
         // We must reset the location here because the transformation data
         // are set in the placement property
         TopLoc_Location aLoc;
         cShape.Location(aLoc);
 
+        // Per face data. After the counting the offsets of the nodes and triangles of each
+        // face are known so that all faces can be filled up independently.
+        struct FaceData {
+            int index = 0;
+            TopoDS_Face face;
+            Handle (Poly_Triangulation) mesh;
+            TopLoc_Location loc;
+            int nodeOffset = 0;
+            int triaOffset = 0;
+            std::string error;
+        };
+
         // count triangles and nodes in the mesh
         TopTools_IndexedMapOfShape faceMap;
         TopExp::MapShapes(cShape, TopAbs_FACE, faceMap);
+        std::vector<FaceData> faceData(faceMap.Extent());
         for (int i=1; i <= faceMap.Extent(); i++) {
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(faceMap(i)), aLoc);
-            if (mesh.IsNull()) {
-                mesh = Part::Tools::triangulationOfFace(TopoDS::Face(faceMap(i)));
+            FaceData& data = faceData[i-1];
+            data.index = i-1;
+            data.face = TopoDS::Face(faceMap(i));
+            data.mesh = BRep_Tool::Triangulation(data.face, data.loc);
+            if (data.mesh.IsNull()) {
+                data.mesh = Part::Tools::triangulationOfFace(data.face);
             }
+            data.nodeOffset = numNodes;
+            data.triaOffset = numTriangles;
             // Note: we must also count empty faces
-            if (!mesh.IsNull()) {
-                numTriangles += mesh->NbTriangles();
-                numNodes     += mesh->NbNodes();
-                numNorms     += mesh->NbNodes();
+            if (!data.mesh.IsNull()) {
+                numTriangles += data.mesh->NbTriangles();
+                numNodes     += data.mesh->NbNodes();
+                numNorms     += data.mesh->NbNodes();
             }
 
             TopExp_Explorer xp;
@@ -978,6 +998,7 @@ void ViewProviderPartExt::updateVisual()
                 faceEdges.insert(xp.Current().HashCode(INT_MAX));
             numFaces++;
         }
+        int numFaceNodes = numNodes;
 
         // get an indexed map of edges
         TopTools_IndexedMapOfShape edgeMap;
@@ -1033,33 +1054,30 @@ void ViewProviderPartExt::updateVisual()
         for (int i=0;i < numNorms;i++)
             norms[i]= SbVec3f(0.0,0.0,0.0);
 
-        int ii = 0,faceNodeOffset=0,faceTriaOffset=0;
-        for (int i=1; i <= faceMap.Extent(); i++, ii++) {
-            TopLoc_Location aLoc;
-            const TopoDS_Face &actFace = TopoDS::Face(faceMap(i));
-            // get the mesh of the shape
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
-            if (mesh.IsNull()) {
-                mesh = Part::Tools::triangulationOfFace(actFace);
-            }
+        // Fill up the nodes, normals and triangles of a face. Each face only writes
+        // into its own range of the arrays.
+        bool normalsFromUV = NormalsFromUV;
+        auto fillFace = [=](const FaceData& data) {
+            const Handle (Poly_Triangulation)& mesh = data.mesh;
             if (mesh.IsNull()) {
-                parts[ii] = 0;
-                continue;
+                parts[data.index] = 0;
+                return;
             }
 
             // getting the transformation of the shape/face
             gp_Trsf myTransf;
             Standard_Boolean identity = true;
-            if (!aLoc.IsIdentity()) {
+            if (!data.loc.IsIdentity()) {
                 identity = false;
-                myTransf = aLoc.Transformation();
+                myTransf = data.loc.Transformation();
             }
 
-            // getting size of node and triangle array of this face
-            int nbNodesInFace = mesh->NbNodes();
+            // getting size of triangle array of this face
             int nbTriInFace   = mesh->NbTriangles();
+            int faceNodeOffset = data.nodeOffset;
+            int faceTriaOffset = data.triaOffset;
             // check orientation
-            TopAbs_Orientation orient = actFace.Orientation();
+            TopAbs_Orientation orient = data.face.Orientation();
 
 
             // cycling through the poly mesh
@@ -1071,9 +1089,9 @@ void ViewProviderPartExt::updateVisual()
             int numNodes =  mesh->NbNodes();
             TColgp_Array1OfDir Normals (1, numNodes);
 #endif
-            if (NormalsFromUV)
-                Part::Tools::getPointNormals(actFace, mesh, Normals);
-            
+            if (normalsFromUV)
+                Part::Tools::getPointNormals(data.face, mesh, Normals);
+
             for (int g=1;g<=nbTriInFace;g++) {
                 // Get the triangle
                 Standard_Integer N1,N2,N3;
@@ -1099,7 +1117,7 @@ void ViewProviderPartExt::updateVisual()
 
                 // get the 3 normals of this triangle
                 gp_Vec NV1, NV2, NV3;
-                if (NormalsFromUV) {
+                if (normalsFromUV) {
                     NV1.SetXYZ(Normals(N1).XYZ());
                     NV2.SetXYZ(Normals(N2).XYZ());
                     NV3.SetXYZ(Normals(N3).XYZ());
@@ -1119,7 +1137,7 @@ void ViewProviderPartExt::updateVisual()
                     V1.Transform(myTransf);
                     V2.Transform(myTransf);
                     V3.Transform(myTransf);
-                    if (NormalsFromUV) {
+                    if (normalsFromUV) {
                         NV1.Transform(myTransf);
                         NV2.Transform(myTransf);
                         NV3.Transform(myTransf);
@@ -1143,11 +1161,44 @@ void ViewProviderPartExt::updateVisual()
                 index[faceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
             }
 
-            parts[ii] = nbTriInFace; // new part
+            parts[data.index] = nbTriInFace; // new part
+        };
+
+        QtConcurrent::blockingMap(faceData, [&fillFace](FaceData& data) {
+            // exceptions must not escape the worker threads
+            try {
+                fillFace(data);
+            }
+            catch (const Standard_Failure& e) {
+                data.error = e.GetMessageString();
+                if (data.error.empty())
+                    data.error = "Unknown OCC exception";
+            }
+        });
+
+        for (const auto& data : faceData) {
+            if (!data.error.empty())
+                throw Standard_Failure(data.error.c_str());
+        }
+
+        // The edges are assigned to the first face they belong to, so this is done
+        // in the order of the faces
+        for (const auto& data : faceData) {
+            const Handle (Poly_Triangulation)& mesh = data.mesh;
+            if (mesh.IsNull())
+                continue;
+
+            gp_Trsf myTransf;
+            Standard_Boolean identity = true;
+            if (!data.loc.IsIdentity()) {
+                identity = false;
+                myTransf = data.loc.Transformation();
+            }
+            int faceNodeOffset = data.nodeOffset;
 
             // handling the edges lying on this face
             TopExp_Explorer Exp;
-            for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
+            for(Exp.Init(data.face,TopAbs_EDGE);Exp.More();Exp.Next()) {
                 const TopoDS_Edge &curEdge = TopoDS::Edge(Exp.Current());
                 // get the overall index of this edge
                 int edgeIndex = edgeMap.FindIndex(curEdge);
@@ -1156,7 +1207,7 @@ void ViewProviderPartExt::updateVisual()
                 if (edgeIdxSet.find(edgeIndex)!=edgeIdxSet.end()) {
                     
                     // this holds the indices of the edge's triangulation to the current polygon
-                    Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, mesh, aLoc);
+                    Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, mesh, data.loc);
                     if (aPoly.IsNull())
                         continue; // polygon does not exist
                     
@@ -1173,7 +1224,7 @@ void ViewProviderPartExt::updateVisual()
                         // but not by any triangle. Thus, we must apply the coordinates to
                         // make sure that everything is properly set.
 #if OCC_VERSION_HEX < 0x070600
-                        gp_Pnt p(Nodes(nodeIndex));
+                        gp_Pnt p(mesh->Nodes()(nodeIndex));
 #else
                         gp_Pnt p(mesh->Node(nodeIndex));
 #endif
@@ -1188,12 +1239,10 @@ void ViewProviderPartExt::updateVisual()
             }
 
             edgeVector.push_back(-1);
-            
-            // counting up the per Face offsets
-            faceNodeOffset += nbNodesInFace;
-            faceTriaOffset += nbTriInFace;
         }
 
+        int faceNodeOffset = numFaceNodes;
+
         // handling of the free edges
         for (int i=1; i <= edgeMap.Extent(); i++) {
             const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
@@ -1236,9 +1285,15 @@ void ViewProviderPartExt::updateVisual()
             verts[faceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
         }
 
-        // normalize all normals 
-        for (int i = 0; i< numNorms ;i++)
-            norms[i].normalize();
+        // normalize all normals
+        std::vector<int> normalBlocks;
+        for (int i = 0; i < numNorms; i += 4096)
+            normalBlocks.push_back(i);
+        QtConcurrent::blockingMap(normalBlocks, [norms, numNorms](int first) {
+            int last = std::min(first + 4096, numNorms);
+            for (int i = first; i < last; i++)
+                norms[i].normalize();
+        });
         
         std::vector<int32_t> lineSetCoords;
         for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
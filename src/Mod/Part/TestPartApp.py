@@ -22,6 +22,9 @@
 import FreeCAD, unittest, Part
 import copy
 import math
+import os
+import tempfile
+import zipfile
 from FreeCAD import Units
 from FreeCAD import Base
 App = FreeCAD
@@ -744,3 +747,399 @@ class PartTestShapeFix(unittest.TestCase):
         fix.fixGap3d(1, False)
         fix.fixGap2d(1, False)
         fix.fixTails()
+
+class PartTestRefine(unittest.TestCase):
+    """ Face counts of removeSplitter() that must not change """
+    def checkRefine(self, shape, faces):
+        refined = shape.removeSplitter()
+        self.assertTrue(refined.isValid())
+        self.assertEqual(len(refined.Faces), faces)
+        self.assertAlmostEqual(refined.Volume, shape.Volume, 6)
+
+    def testTwoBoxes(self):
+        box1 = Part.makeBox(10, 10, 10)
+        box2 = Part.makeBox(10, 10, 10, Base.Vector(10, 0, 0))
+        self.checkRefine(box1.fuse(box2), 6)
+
+    def testRowOfBoxes(self):
+        boxes = [Part.makeBox(1, 1, 1, Base.Vector(i, 0, 0)) for i in range(10)]
+        self.checkRefine(boxes[0].multiFuse(boxes[1:]), 6)
+
+    def testGridOfBoxes(self):
+        boxes = [Part.makeBox(1, 1, 1, Base.Vector(i, j, k)) for i in range(3) for j in range(3) for k in range(3)]
+        self.checkRefine(boxes[0].multiFuse(boxes[1:]), 6)
+
+    def testLShape(self):
+        box1 = Part.makeBox(20, 10, 10)
+        box2 = Part.makeBox(10, 10, 10, Base.Vector(0, 10, 0))
+        self.checkRefine(box1.fuse(box2), 8)
+
+    def testStackedCylinders(self):
+        cyl1 = Part.makeCylinder(2, 5)
+        cyl2 = Part.makeCylinder(2, 5, Base.Vector(0, 0, 5))
+        self.checkRefine(cyl1.fuse(cyl2), 3)
+
+    def testSeparateGroups(self):
+        # two solids far apart, each made of two boxes
+        shapes = []
+        for x in (0, 100):
+            box1 = Part.makeBox(10, 10, 10, Base.Vector(x, 0, 0))
+            box2 = Part.makeBox(10, 10, 10, Base.Vector(x, 10, 0))
+            shapes.append(box1.fuse(box2))
+        self.checkRefine(shapes[0].fuse(shapes[1]), 12)
+
+class PartTestMultiFuse(unittest.TestCase):
+    def testSeparateClusters(self):
+        # three pairs of overlapping boxes far apart and a box on its own
+        shapes = []
+        for x in (0, 100, 200):
+            shapes.append(Part.makeBox(10, 10, 10, Base.Vector(x, 0, 0)))
+            shapes.append(Part.makeBox(10, 10, 10, Base.Vector(x + 5, 0, 0)))
+        shapes.append(Part.makeBox(10, 10, 10, Base.Vector(300, 0, 0)))
+        fused = shapes[0].multiFuse(shapes[1:])
+        self.assertTrue(fused.isValid())
+        self.assertEqual(len(fused.Solids), 4)
+        self.assertAlmostEqual(fused.Volume, 3 * 1500 + 1000, 6)
+
+    def testChainOfCylinders(self):
+        # each cylinder only overlaps its neighbours, so all of them form one solid
+        cyls = [Part.makeCylinder(1, 3, Base.Vector(2 * i, 0, 0), Base.Vector(1, 0, 0)) for i in range(5)]
+        fused = cyls[0].multiFuse(cyls[1:])
+        self.assertEqual(len(fused.Solids), 1)
+        self.assertAlmostEqual(fused.Volume, math.pi * 11, 6)
+
+    def testFeature(self):
+        doc = FreeCAD.newDocument("MultiFuse")
+        objs = []
+        for x in (0, 5, 100):
+            obj = doc.addObject("Part::Box", "Box")
+            obj.Placement.Base = Base.Vector(x, 0, 0)
+            objs.append(obj)
+        fuse = doc.addObject("Part::MultiFuse", "Fusion")
+        fuse.Shapes = objs
+        doc.recompute()
+        self.assertEqual(len(fuse.Shape.Solids), 2)
+        self.assertAlmostEqual(fuse.Shape.Volume, 2500, 6)
+        FreeCAD.closeDocument(doc.Name)
+
+class PartTestResultCache(unittest.TestCase):
+    def setUp(self):
+        self.maxMemory = Part.getResultCacheStatistics()["MaxMemory"]
+        Part.clearResultCache(64 * 1024 * 1024)
+        self.Doc = FreeCAD.newDocument("ResultCache")
+
+    def testFingerprint(self):
+        box1 = Part.makeBox(1, 2, 3)
+        box2 = Part.makeBox(1, 2, 3)
+        self.assertEqual(box1.fingerprint(), box2.fingerprint())
+        self.assertEqual(box1.fingerprint(), box1.copy().fingerprint())
+        box2.translate(Base.Vector(1, 0, 0))
+        self.assertNotEqual(box1.fingerprint(), box2.fingerprint())
+        box1.tessellate(0.1)
+        self.assertEqual(box1.fingerprint(), Part.makeBox(1, 2, 3).fingerprint())
+        self.assertEqual(Part.Shape().fingerprint(), "")
+
+    def testBoolean(self):
+        box = self.Doc.addObject("Part::Box", "Box")
+        cyl = self.Doc.addObject("Part::Cylinder", "Cylinder")
+        cut = self.Doc.addObject("Part::Cut", "Cut")
+        cut.Base = box
+        cut.Tool = cyl
+        self.Doc.recompute()
+        volume = cut.Shape.Volume
+        stats = Part.getResultCacheStatistics()
+
+        # recomputing with the same input shapes re-uses the result
+        cut.touch()
+        self.Doc.recompute()
+        self.assertEqual(Part.getResultCacheStatistics()["Hits"], stats["Hits"] + 1)
+        self.assertAlmostEqual(cut.Shape.Volume, volume, 6)
+
+        cyl.Radius = 1
+        self.Doc.recompute()
+        self.assertEqual(Part.getResultCacheStatistics()["Hits"], stats["Hits"] + 1)
+        self.assertNotAlmostEqual(cut.Shape.Volume, volume, 3)
+
+    def testSectionApproximation(self):
+        sphere = self.Doc.addObject("Part::Sphere", "Sphere")
+        box = self.Doc.addObject("Part::Box", "Box")
+        box.Placement.Base = Base.Vector(-5, -5, 1)
+        section = self.Doc.addObject("Part::Section", "Section")
+        section.Base = sphere
+        section.Tool = box
+        self.Doc.recompute()
+        self.assertEqual(section.Shape.Edges[0].Curve.TypeId, "Part::GeomCircle")
+        hits = Part.getResultCacheStatistics()["Hits"]
+
+        # the parameters of the section are part of the key
+        section.Approximation = True
+        self.Doc.recompute()
+        self.assertEqual(Part.getResultCacheStatistics()["Hits"], hits)
+        self.assertEqual(section.Shape.Edges[0].Curve.TypeId, "Part::GeomBSplineCurve")
+
+        section.Approximation = False
+        self.Doc.recompute()
+        self.assertEqual(Part.getResultCacheStatistics()["Hits"], hits + 1)
+        self.assertEqual(section.Shape.Edges[0].Curve.TypeId, "Part::GeomCircle")
+
+    def testFillet(self):
+        box = self.Doc.addObject("Part::Box", "Box")
+        fillet = self.Doc.addObject("Part::Fillet", "Fillet")
+        fillet.Base = box
+        fillet.Edges = [(1, 1.0, 1.0)]
+        self.Doc.recompute()
+        volume = fillet.Shape.Volume
+        hits = Part.getResultCacheStatistics()["Hits"]
+        fillet.touch()
+        self.Doc.recompute()
+        self.assertEqual(Part.getResultCacheStatistics()["Hits"], hits + 1)
+        self.assertAlmostEqual(fillet.Shape.Volume, volume, 6)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.Doc.Name)
+        Part.clearResultCache(self.maxMemory)
+
+class PartTestCheckShapes(unittest.TestCase):
+    def testValidShapes(self):
+        shapes = [Part.makeBox(1, 1, 1), Part.makeSphere(2), Part.makeCylinder(1, 3)]
+        reported = []
+        results = Part.checkShapes(shapes, RunBOPCheck=True,
+                                   Callback=lambda index, result: reported.append(index))
+        self.assertEqual(len(results), 3)
+        self.assertEqual(reported, [0, 1, 2])
+        for result in results:
+            self.assertTrue(result["Valid"])
+            self.assertEqual(result["Issues"], [])
+            self.assertGreaterEqual(result["BRepCheckTime"], 0.0)
+
+    def testCompound(self):
+        boxes = [Part.makeBox(1, 1, 1, Base.Vector(2 * i, 0, 0)) for i in range(4)]
+        results = Part.checkShapes([Part.makeCompound(boxes)])
+        self.assertTrue(results[0]["Valid"])
+        self.assertEqual(results[0]["BOPCheckTime"], 0.0)
+
+    def makeOpenFace(self):
+        # a face bounded by an open wire
+        wire = Part.makePolygon([Base.Vector(0, 0, 0), Base.Vector(1, 0, 0),
+                                 Base.Vector(1, 1, 0), Base.Vector(0, 1, 0)])
+        return Part.Face(Part.Plane(), [wire])
+
+    def testInvalidFace(self):
+        face = self.makeOpenFace()
+        result = Part.checkShapes([face], RunBOPCheck=True)[0]
+        self.assertFalse(result["Valid"])
+        self.assertEqual(result["BOPCheckTime"], 0.0)
+        self.assertIn({"Check": "BRepCheck", "ShapeType": "Wire", "Index": 1, "Status": "Not closed"},
+                      result["Issues"])
+        for issue in result["Issues"]:
+            self.assertNotEqual(issue["Status"], "No error")
+
+    def testInvalidCompound(self):
+        face = self.makeOpenFace()
+        compound = Part.makeCompound([Part.makeBox(1, 1, 1), face, face])
+        result = Part.checkShapes([compound])[0]
+        self.assertFalse(result["Valid"])
+        # the wire shared by both faces is reported once with its index in the compound
+        index = [i for i, wire in enumerate(compound.Wires) if wire.isSame(face.Wires[0])][0] + 1
+        issue = {"Check": "BRepCheck", "ShapeType": "Wire", "Index": index, "Status": "Not closed"}
+        self.assertEqual(result["Issues"].count(issue), 1)
+
+class PartTestFaceMakerBullseye(unittest.TestCase):
+    def testNestedCircles(self):
+        # a bull's eye: two rings and a disc in the middle
+        wires = [Part.Wire(Part.makeCircle(r)) for r in (1, 2, 3, 4, 5)]
+        face = Part.makeFace(wires, "Part::FaceMakerBullseye")
+        self.assertEqual(len(face.Faces), 3)
+        self.assertAlmostEqual(face.Area, math.pi * (25 - 16 + 9 - 4 + 1), 6)
+
+    def testPerforatedPlate(self):
+        square = Part.makePolygon([Base.Vector(0, 0, 0), Base.Vector(20, 0, 0),
+                                   Base.Vector(20, 20, 0), Base.Vector(0, 20, 0),
+                                   Base.Vector(0, 0, 0)])
+        wires = [square]
+        for i in range(10):
+            for j in range(10):
+                center = Base.Vector(2 * i + 1, 2 * j + 1, 0)
+                wires.append(Part.Wire(Part.makeCircle(0.5, center)))
+        # an island in one of the holes
+        wires.append(Part.Wire(Part.makeCircle(0.25, Base.Vector(1, 1, 0))))
+        face = Part.makeFace(wires, "Part::FaceMakerBullseye")
+        self.assertEqual(len(face.Faces), 2)
+        self.assertEqual(sorted(len(f.Wires) for f in face.Faces), [1, 101])
+        self.assertAlmostEqual(face.Area, 400 - 100 * math.pi * 0.25 + math.pi * 0.0625, 6)
+
+class PartTestSlices(unittest.TestCase):
+    def testParallelSlices(self):
+        solid = Part.makeCylinder(2, 10)
+        shell = Part.makeBox(3, 3, 10, Base.Vector(5, 0, 0)).Shells[0]
+        shell = Part.Shell(shell.Faces[1:])
+        face = Part.makePlane(10, 3, Base.Vector(10, 0, 0), Base.Vector(1, 0, 0))
+        shape = Part.makeCompound([solid, shell, face])
+        fingerprint = shape.fingerprint()
+        distances = [0.5 * i for i in range(1, 20)]
+        serial = shape.slices(Base.Vector(0, 0, 1), distances)
+        parallel = shape.slices(Base.Vector(0, 0, 1), distances, Parallel=True)
+        self.assertEqual(len(serial.Wires), len(parallel.Wires))
+        for w1, w2 in zip(serial.Wires, parallel.Wires):
+            self.assertAlmostEqual(w1.Length, w2.Length, 6)
+            self.assertTrue(w1.BoundBox.isInside(w2.BoundBox.Center))
+            self.assertAlmostEqual(w1.BoundBox.ZMin, w2.BoundBox.ZMin, 6)
+        # the input is not modified by the booleans
+        self.assertEqual(shape.fingerprint(), fingerprint)
+
+class PartTestSharedShapeStorage(unittest.TestCase):
+    def setUp(self):
+        self.docGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.partGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part/General")
+        self.binaryBrep = self.docGrp.GetBool("SaveBinaryBrep", False)
+        self.sharedStorage = self.partGrp.GetBool("SharedShapeStorage", False)
+        self.fileName = os.path.join(tempfile.gettempdir(), "PartTestSharedShapeStorage.FCStd")
+
+    def saveAndReload(self, shared):
+        self.docGrp.SetBool("SaveBinaryBrep", True)
+        self.partGrp.SetBool("SharedShapeStorage", shared)
+        doc = FreeCAD.newDocument("SharedShapeStorage")
+        box = Part.makeBox(1, 2, 3)
+        solid = doc.addObject("Part::Feature", "Solid")
+        solid.Shape = box
+        faces = doc.addObject("Part::Feature", "Faces")
+        faces.Shape = Part.makeCompound(box.Faces[0:3])
+        edges = doc.addObject("Part::Feature", "Edges")
+        edges.Shape = Part.makeCompound(box.Faces[0].Edges)
+        fingerprints = [obj.Shape.fingerprint() for obj in doc.Objects]
+        doc.saveAs(self.fileName)
+        FreeCAD.closeDocument(doc.Name)
+
+        with zipfile.ZipFile(self.fileName) as archive:
+            self.assertEqual("PartShapes.bin" in archive.namelist(), shared)
+
+        doc = FreeCAD.openDocument(self.fileName)
+        self.assertEqual([obj.Shape.fingerprint() for obj in doc.Objects], fingerprints)
+        self.assertAlmostEqual(doc.Solid.Shape.Volume, 6, 6)
+        return doc
+
+    def testShared(self):
+        doc = self.saveAndReload(True)
+        # the features share their sub-shapes again after loading
+        solid = doc.Solid.Shape
+        self.assertTrue(doc.Faces.Shape.Faces[1].isPartner(solid.Faces[1]))
+        self.assertTrue(doc.Edges.Shape.Edges[2].isPartner(solid.Faces[0].Edges[2]))
+        FreeCAD.closeDocument(doc.Name)
+
+    def testNotShared(self):
+        doc = self.saveAndReload(False)
+        self.assertEqual(len(doc.Faces.Shape.Faces), 3)
+        FreeCAD.closeDocument(doc.Name)
+
+    def tearDown(self):
+        self.docGrp.SetBool("SaveBinaryBrep", self.binaryBrep)
+        self.partGrp.SetBool("SharedShapeStorage", self.sharedStorage)
+        if os.path.exists(self.fileName):
+            os.remove(self.fileName)
+
+class PartTestTessellationCache(unittest.TestCase):
+    def setUp(self):
+        self.maxMemory = Part.getTessellationCacheStatistics()["MaxMemory"]
+        Part.clearTessellationCache(64 * 1024 * 1024)
+
+    def testHitsAndMisses(self):
+        cyl = Part.makeCylinder(2, 5)
+        # the triangulation is removed before each call so that it must be restored
+        mesh1 = cyl.tessellate(0.1, True)
+        stats = Part.getTessellationCacheStatistics()
+        self.assertEqual(stats["Misses"], 3)
+        self.assertEqual(stats["Entries"], 3)
+
+        mesh2 = cyl.tessellate(0.1, True)
+        self.assertEqual(Part.getTessellationCacheStatistics()["Hits"], stats["Hits"] + 3)
+        self.assertEqual(Part.getTessellationCacheStatistics()["Misses"], stats["Misses"])
+        self.assertEqual(mesh1[1], mesh2[1])
+        self.assertEqual(len(mesh1[0]), len(mesh2[0]))
+        for p1, p2 in zip(mesh1[0], mesh2[0]):
+            self.assertEqual(p1, p2)
+
+        # a different deflection is another key
+        mesh3 = cyl.tessellate(0.01, True)
+        self.assertEqual(Part.getTessellationCacheStatistics()["Misses"], stats["Misses"] + 3)
+        self.assertEqual(Part.getTessellationCacheStatistics()["Entries"], 6)
+        self.assertGreater(len(mesh3[1]), len(mesh1[1]))
+
+    def testDeletedFaces(self):
+        box = Part.makeBox(1, 1, 1)
+        box.tessellate(0.1)
+        for i in range(100):
+            Part.makeBox(1, 1, 2 + i).tessellate(0.1)
+
+        # the entries of deleted faces are removed, those of the box are kept
+        self.assertLess(Part.getTessellationCacheStatistics()["Entries"], 100)
+        hits = Part.getTessellationCacheStatistics()["Hits"]
+        box.tessellate(0.1, True)
+        self.assertEqual(Part.getTessellationCacheStatistics()["Hits"], hits + 6)
+
+    def tearDown(self):
+        Part.clearTessellationCache(self.maxMemory)
+
+class PartTestShapeCache(unittest.TestCase):
+    def setUp(self):
+        self.maxMemory = Part.getShapeCacheStatistics()["MaxMemory"]
+        Part.clearShapeCache(64 * 1024 * 1024)
+        self.Doc = FreeCAD.newDocument("ShapeCache")
+        self.Body = self.Doc.addObject("PartDesign::Body", "Body")
+        sketch = self.Doc.addObject("Sketcher::SketchObject", "Sketch")
+        self.Body.addObject(sketch)
+        points = [App.Vector(0, 0, 0), App.Vector(4, 0, 0), App.Vector(4, 3, 0), App.Vector(0, 3, 0)]
+        for i in range(4):
+            sketch.addGeometry(Part.LineSegment(points[i], points[(i + 1) % 4]), False)
+        self.Pad = self.Doc.addObject("PartDesign::Pad", "Pad")
+        self.Pad.Profile = sketch
+        self.Pad.Length = 5
+        self.Body.addObject(self.Pad)
+        self.Link = self.Doc.addObject("App::Link", "Link")
+        self.Link.LinkedObject = self.Body
+        self.Link.Placement.Base = App.Vector(10, 0, 0)
+        self.Doc.recompute()
+
+    def getTopFace(self):
+        for i, face in enumerate(self.Pad.Shape.Faces):
+            if abs(face.BoundBox.ZMin - self.Pad.Length.Value) < 1e-7:
+                return Part.getShape(self.Link, "Pad.Face%d" % (i + 1), needSubElement=True)
+
+    def testTransformHits(self):
+        face = self.getTopFace()
+        stats = Part.getShapeCacheStatistics()
+        for i in range(3):
+            self.assertTrue(self.getTopFace().isEqual(face))
+        self.assertEqual(Part.getShapeCacheStatistics()["TransformHits"], stats["TransformHits"] + 3)
+        self.assertEqual(Part.getShapeCacheStatistics()["TransformMisses"], stats["TransformMisses"])
+        self.assertAlmostEqual(face.BoundBox.XMin, 10, 6)
+        self.assertAlmostEqual(face.BoundBox.ZMin, 5, 6)
+
+    def testModifiedPad(self):
+        self.assertAlmostEqual(Part.getShape(self.Link, "Pad.").Volume, 60, 6)
+        self.getTopFace()
+        self.Pad.Length = 8
+        self.Doc.recompute()
+
+        # the linked shapes must not be taken from the cache
+        self.assertAlmostEqual(Part.getShape(self.Link, "Pad.").Volume, 96, 6)
+        face = self.getTopFace()
+        self.assertAlmostEqual(face.BoundBox.XMin, 10, 6)
+        self.assertAlmostEqual(face.BoundBox.ZMin, 8, 6)
+
+    def testEviction(self):
+        self.getTopFace()
+        Part.getShape(self.Link, "Pad.")
+        self.assertGreater(Part.getShapeCacheStatistics()["Entries"], 1)
+
+        # only the most recently used entry is kept if it alone exceeds the limit
+        Part.clearShapeCache(1)
+        self.assertEqual(Part.getShapeCacheStatistics()["Entries"], 0)
+        Part.getShape(self.Link, "Pad.")
+        self.getTopFace()
+        stats = Part.getShapeCacheStatistics()
+        self.assertEqual(stats["Entries"], 1)
+        self.assertEqual(stats["MaxMemory"], 1)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.Doc.Name)
+        Part.clearShapeCache(self.maxMemory)
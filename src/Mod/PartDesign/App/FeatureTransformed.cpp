@@ -22,6 +22,8 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
+# include <numeric>
 # include <Bnd_Box.hxx>
 # include <BRep_Builder.hxx>
 # include <BRepAlgoAPI_Cut.hxx>
@@ -31,8 +33,11 @@
 # include <BRepBuilderAPI_Transform.hxx>
 # include <Precision.hxx>
 # include <TopExp_Explorer.hxx>
+# include <TopoDS_Compound.hxx>
 #endif
 
+#include <QtConcurrentMap>
+
 #include <App/Application.h>
 #include <Base/Console.h>
 #include <Base/Exception.h>
@@ -51,6 +56,54 @@
 
 using namespace PartDesign;
 
+namespace {
+/// A transformed copy of a tool shape
+struct ToolInstance
+{
+    const gp_Trsf* trsf = nullptr;
+    TopoDS_Shape shape;
+    Bnd_Box box;
+    bool overlapping = false;
+};
+
+/// Marks the instances whose bounding box overlaps the one of another instance
+void markOverlapping(std::vector<ToolInstance*>& instances)
+{
+    for (auto it : instances)
+        it->overlapping = it->box.IsVoid();
+
+    std::vector<ToolInstance*> sorted;
+    for (auto it : instances) {
+        if (!it->overlapping)
+            sorted.push_back(it);
+    }
+
+    // sweep along x and only compare with the boxes which are still open
+    auto xMin = [](const ToolInstance* instance) {
+        return instance->box.CornerMin().X();
+    };
+    std::sort(sorted.begin(), sorted.end(), [&xMin](const ToolInstance* a, const ToolInstance* b) {
+        return xMin(a) < xMin(b);
+    });
+
+    std::vector<ToolInstance*> active;
+    for (auto it : sorted) {
+        double x = xMin(it);
+        active.erase(std::remove_if(active.begin(), active.end(), [x](const ToolInstance* open) {
+            return open->box.CornerMax().X() < x;
+        }), active.end());
+        for (auto open : active) {
+            // touching boxes are not out, so copies sharing a face are separate tools
+            if (!open->box.IsOut(it->box)) {
+                open->overlapping = true;
+                it->overlapping = true;
+            }
+        }
+        active.push_back(it);
+    }
+}
+}
+
 namespace PartDesign {
 
 PROPERTY_SOURCE(PartDesign::Transformed, PartDesign::Feature)
@@ -211,35 +264,65 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
     supportShape.setTransform(Base::Matrix4D());
     TopoDS_Shape support = supportShape.getShape();
 
-    auto getTransformedCompShape = [&](const auto& origShape)
+    // Makes the transformed copies of a tool shape. Copies whose bounding box is outside of
+    // supportBox are skipped. Returns false if a transformation failed.
+    auto getTransformedCompShape = [&](const TopoDS_Shape& origShape, const Bnd_Box* supportBox,
+                                       TopTools_ListOfShape& shapeTools)
     {
-        TopTools_ListOfShape shapeTools;
-        std::vector<TopoDS_Shape> shapes;
-
-        std::vector<gp_Trsf>::const_iterator transformIter = transformations.begin();
-
         // First transformation is skipped since it should not be part of the toolShape.
-        ++transformIter;
-
-        for (; transformIter != transformations.end(); ++transformIter) {
-            // Make an explicit copy of the shape because the "true" parameter to BRepBuilderAPI_Transform
-            // seems to be pretty broken
-            BRepBuilderAPI_Copy copy(origShape);
-
-            TopoDS_Shape shape = copy.Shape();
-
-            BRepBuilderAPI_Transform mkTrf(shape, *transformIter, false); // No need to copy, now
-            if (!mkTrf.IsDone())
-                return shapeTools;
-            shape = mkTrf.Shape();
+        std::vector<ToolInstance> instances(transformations.size() - 1);
+        for (std::size_t i = 0; i < instances.size(); i++)
+            instances[i].trsf = &transformations[i + 1];
+
+        // The copies are independent of each other and can be made in parallel
+        QtConcurrent::blockingMap(instances, [&origShape](ToolInstance& instance) {
+            try {
+                // Make an explicit copy of the shape because the "true" parameter to BRepBuilderAPI_Transform
+                // seems to be pretty broken
+                BRepBuilderAPI_Copy copy(origShape);
+
+                BRepBuilderAPI_Transform mkTrf(copy.Shape(), *instance.trsf, false); // No need to copy, now
+                if (!mkTrf.IsDone())
+                    return;
+                instance.shape = mkTrf.Shape();
+                BRepBndLib::Add(instance.shape, instance.box);
+                instance.box.SetGap(0.0);
+            }
+            catch (const Standard_Failure&) {
+                instance.shape.Nullify();
+            }
+        });
 
-            shapes.emplace_back(shape);
+        std::vector<ToolInstance*> tools;
+        for (auto& it : instances) {
+            if (it.shape.IsNull())
+                return false;
+            if (supportBox && it.box.IsOut(*supportBox))
+                continue;
+            tools.push_back(&it);
         }
 
-        for (auto shape : shapes)
-            shapeTools.Append(shape);
+        // Copies which don't overlap any other copy are passed as one compound, so only the
+        // overlapping ones are separate tools of the boolean operation
+        markOverlapping(tools);
+
+        TopoDS_Compound compound;
+        BRep_Builder builder;
+        builder.MakeCompound(compound);
+        bool disjoint = false;
+        for (auto it : tools) {
+            if (it->overlapping) {
+                shapeTools.Append(it->shape);
+            }
+            else {
+                builder.Add(compound, it->shape);
+                disjoint = true;
+            }
+        }
+        if (disjoint)
+            shapeTools.Append(compound);
 
-        return shapeTools;
+        return true;
     };
 
     // NOTE: It would be possible to build a compound from all original addShapes/subShapes and then
@@ -272,12 +355,13 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
         if (!fuseShape.isNull()) {
             TopTools_ListOfShape shapeArguments;
             shapeArguments.Append(current);
-            TopTools_ListOfShape shapeTools = getTransformedCompShape(fuseShape.getShape());
-            if (shapeTools.Size() == 0)
+            TopTools_ListOfShape shapeTools;
+            if (!getTransformedCompShape(fuseShape.getShape(), nullptr, shapeTools) || shapeTools.Size() == 0)
                 return new App::DocumentObjectExecReturn("Transformation failed", (*o));
             std::unique_ptr<BRepAlgoAPI_BooleanOperation> mkBool(new BRepAlgoAPI_Fuse());
             mkBool->SetArguments(shapeArguments);
             mkBool->SetTools(shapeTools);
+            mkBool->SetRunParallel(true);
             mkBool->Build();
             if (!mkBool->IsDone()) {
                 std::stringstream error;
@@ -289,19 +373,28 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
         if (!cutShape.isNull()) {
             TopTools_ListOfShape shapeArguments;
             shapeArguments.Append(current);
-            TopTools_ListOfShape shapeTools = getTransformedCompShape(cutShape.getShape());
-            if (shapeTools.Size() == 0)
+            // a copy outside of the support cannot remove anything from it
+            Bnd_Box supportBox;
+            BRepBndLib::Add(current, supportBox);
+            supportBox.SetGap(0.0);
+            supportBox.Enlarge(Precision::Confusion());
+
+            TopTools_ListOfShape shapeTools;
+            if (!getTransformedCompShape(cutShape.getShape(), &supportBox, shapeTools))
                 return new App::DocumentObjectExecReturn("Transformation failed", (*o));
-            std::unique_ptr<BRepAlgoAPI_BooleanOperation> mkBool(new BRepAlgoAPI_Cut());
-            mkBool->SetArguments(shapeArguments);
-            mkBool->SetTools(shapeTools);
-            mkBool->Build();
-            if (!mkBool->IsDone()) {
-                std::stringstream error;
-                error << "Boolean operation failed";
-                return new App::DocumentObjectExecReturn(error.str());
+            if (shapeTools.Size() > 0) {
+                std::unique_ptr<BRepAlgoAPI_BooleanOperation> mkBool(new BRepAlgoAPI_Cut());
+                mkBool->SetArguments(shapeArguments);
+                mkBool->SetTools(shapeTools);
+                mkBool->SetRunParallel(true);
+                mkBool->Build();
+                if (!mkBool->IsDone()) {
+                    std::stringstream error;
+                    error << "Boolean operation failed";
+                    return new App::DocumentObjectExecReturn(error.str());
+                }
+                current = mkBool->Shape();
             }
-            current = mkBool->Shape();
         }
 
         support = current; // Use result of this operation for fuse/cut of next original
@@ -339,61 +432,6 @@ TopoDS_Shape Transformed::refineShapeIfActive(const TopoDS_Shape& oldShape) cons
     return oldShape;
 }
 
-void Transformed::divideTools(const std::vector<TopoDS_Shape> &toolsIn, std::vector<TopoDS_Shape> &individualsOut,
-                              TopoDS_Compound &compoundOut) const
-{
-    typedef std::pair<TopoDS_Shape, Bnd_Box> ShapeBoundPair;
-    typedef std::list<ShapeBoundPair> PairList;
-    typedef std::vector<ShapeBoundPair> PairVector;
-
-    PairList pairList;
-
-    std::vector<TopoDS_Shape>::const_iterator it;
-    for (it = toolsIn.begin(); it != toolsIn.end(); ++it) {
-        Bnd_Box bound;
-        BRepBndLib::Add(*it, bound);
-        bound.SetGap(0.0);
-        ShapeBoundPair temp = std::make_pair(*it, bound);
-        pairList.push_back(temp);
-    }
-
-    BRep_Builder builder;
-    builder.MakeCompound(compoundOut);
-
-    while(!pairList.empty()) {
-        PairVector currentGroup;
-        currentGroup.push_back(pairList.front());
-        pairList.pop_front();
-        PairList::iterator it = pairList.begin();
-        while(it != pairList.end()) {
-            PairVector::const_iterator groupIt;
-            bool found(false);
-            for (groupIt = currentGroup.begin(); groupIt != currentGroup.end(); ++groupIt) {
-                if (!(*it).second.IsOut((*groupIt).second)) {//touching means is out.
-                    found = true;
-                    break;
-                }
-            }
-            if (found) {
-                currentGroup.push_back(*it);
-                pairList.erase(it);
-                it=pairList.begin();
-                continue;
-            }
-            ++it;
-        }
-
-        if (currentGroup.size() == 1) {
-            builder.Add(compoundOut, currentGroup.front().first);
-        }
-        else {
-            PairVector::const_iterator groupIt;
-            for (groupIt = currentGroup.begin(); groupIt != currentGroup.end(); ++groupIt)
-                individualsOut.push_back((*groupIt).first);
-        }
-    }
-}
-
 TopoDS_Shape Transformed::getRemainingSolids(const TopoDS_Shape& shape)
 {
     BRep_Builder builder;
@@ -139,6 +139,81 @@ class TestLinearPattern(unittest.TestCase):
         self.Doc.recompute()
         self.assertAlmostEqual(self.LinearPattern.Shape.Volume, 1e4)
 
+    def makeXPattern(self, feature, length, occurrences):
+        self.LinearPattern = self.Doc.addObject("PartDesign::LinearPattern","LinearPattern")
+        self.LinearPattern.Originals = [feature]
+        self.LinearPattern.Direction = (self.Doc.X_Axis,[""])
+        self.LinearPattern.Length = length
+        self.LinearPattern.Occurrences = occurrences
+        self.Body.addObject(self.LinearPattern)
+        self.Doc.recompute()
+        return self.LinearPattern.Shape
+
+    def makePlate(self, length, width, height):
+        self.Body = self.Doc.addObject('PartDesign::Body','Body')
+        self.Plate = self.Doc.addObject('PartDesign::AdditiveBox','Plate')
+        self.Body.addObject(self.Plate)
+        self.Plate.Length = length
+        self.Plate.Width = width
+        self.Plate.Height = height
+        self.Doc.recompute()
+
+    def testOverlappingAdditivePattern(self):
+        self.Body = self.Doc.addObject('PartDesign::Body','Body')
+        self.Box = self.Doc.addObject('PartDesign::AdditiveBox','Box')
+        self.Body.addObject(self.Box)
+        self.Box.Length=10.00
+        self.Box.Width=10.00
+        self.Box.Height=10.00
+        self.Doc.recompute()
+        shape = self.makeXPattern(self.Box, 45.0, 10)
+        self.assertTrue(shape.isValid())
+        self.assertEqual(len(shape.Solids), 1)
+        self.assertAlmostEqual(shape.Volume, 5500)
+
+    def testDisjointAdditivePattern(self):
+        # the copies only touch the plate and are fused as one compound
+        self.makePlate(200, 10, 2)
+        self.Box = self.Doc.addObject('PartDesign::AdditiveBox','Box')
+        self.Body.addObject(self.Box)
+        self.Box.Length=5.00
+        self.Box.Width=5.00
+        self.Box.Height=10.00
+        self.Box.Placement.Base = FreeCAD.Vector(2,2,0)
+        self.Doc.recompute()
+        shape = self.makeXPattern(self.Box, 180.0, 10)
+        self.assertTrue(shape.isValid())
+        self.assertEqual(len(shape.Solids), 1)
+        self.assertAlmostEqual(shape.Volume, 4000 + 10 * 200)
+
+    def testOverlappingSubtractivePattern(self):
+        self.makePlate(100, 20, 10)
+        self.Hole = self.Doc.addObject('PartDesign::SubtractiveBox','Hole')
+        self.Body.addObject(self.Hole)
+        self.Hole.Length=5.00
+        self.Hole.Width=5.00
+        self.Hole.Height=20.00
+        self.Hole.Placement.Base = FreeCAD.Vector(2,2,-5)
+        self.Doc.recompute()
+        shape = self.makeXPattern(self.Hole, 27.0, 10)
+        self.assertTrue(shape.isValid())
+        self.assertAlmostEqual(shape.Volume, 20000 - 32 * 5 * 10)
+
+    def testDisjointSubtractivePattern(self):
+        # the last six copies are outside of the plate and are skipped
+        self.makePlate(100, 20, 10)
+        self.Hole = self.Doc.addObject('PartDesign::SubtractiveBox','Hole')
+        self.Body.addObject(self.Hole)
+        self.Hole.Length=5.00
+        self.Hole.Width=5.00
+        self.Hole.Height=20.00
+        self.Hole.Placement.Base = FreeCAD.Vector(2,2,-5)
+        self.Doc.recompute()
+        shape = self.makeXPattern(self.Hole, 150.0, 16)
+        self.assertTrue(shape.isValid())
+        self.assertEqual(len(shape.Solids), 1)
+        self.assertAlmostEqual(shape.Volume, 20000 - 10 * 5 * 5 * 10)
+
     def tearDown(self):
         #closing doc
         FreeCAD.closeDocument("PartDesignTestLinearPattern")
@@ -26,12 +26,14 @@
 #ifdef FC_OS_LINUX
 # include <unistd.h>
 #endif
+# include <numeric>
 # include <sstream>
 #endif
 
 
 #include "PointsAlgos.h"
 #include "Points.h"
+#include "PointsKDTree.h"
 
 #include <Base/Converter.h>
 #include <Base/Exception.h>
@@ -39,8 +41,15 @@
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
+#include <Base/TimeInfo.h>
 
+#include <atomic>
 #include <memory>
+#include <random>
+#include <unordered_map>
+#include <Eigen/Eigenvalues>
+#include <QtConcurrentMap>
 #include <boost/regex.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
@@ -50,6 +59,34 @@
 
 using namespace Points;
 
+namespace {
+
+/* Splits the range [0, count) into blocks and calls func(first, last) for each
+ * block in parallel. The blocks are large enough to keep the scheduling overhead low. */
+template <typename Func>
+void parallelBlocks(std::size_t count, Func func)
+{
+    const std::size_t blockSize = 16384;
+    std::vector<std::pair<std::size_t, std::size_t> > blocks;
+    for (std::size_t first = 0; first < count; first += blockSize)
+        blocks.emplace_back(first, std::min(count, first + blockSize));
+
+    QtConcurrent::blockingMap(blocks, [&func](const std::pair<std::size_t, std::size_t>& block) {
+        func(block.first, block.second);
+    });
+}
+
+/* Reports the time needed to read the points. */
+void logThroughput(const std::string& filename, std::size_t numPoints, const Base::TimeInfo& start)
+{
+    float seconds = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+    Base::Console().Log("Read %lu points from '%s' in %.2f s (%.0f points/s)\n",
+                        static_cast<unsigned long>(numPoints), filename.c_str(), seconds,
+                        seconds > 0.0f ? static_cast<double>(numPoints) / seconds : 0.0);
+}
+
+}
+
 void PointsAlgos::Load(PointKernel &points, const char *FileName)
 {
     Base::FileInfo File(FileName);
@@ -71,52 +108,314 @@ void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
     //boost::regex rx("(\\b[0-9]+\\.([0-9]+\\b)?|\\.[0-9]+\\b)");
     //boost::regex rx("^\\s*(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s*$");
-    boost::cmatch what;
 
-    Base::Vector3d pt;
-    int LineCnt=0;
-    std::string line;
     Base::FileInfo fi(FileName);
+    Base::ifstream file(fi, std::ios::in);
 
-    Base::ifstream tmp_str(fi, std::ios::in);
-
-    // estimating size
-    while (std::getline(tmp_str,line))
-        LineCnt++;
-
-    // resize the PointKernel
-    points.resize(LineCnt);
+    // the progress is measured in bytes
+    file.seekg(0, std::ios::end);
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+    Base::SequencerLauncher seq("Loading points...", static_cast<size_t>(std::max<std::streamoff>(fileSize, 0)));
 
-    Base::SequencerLauncher seq( "Loading points...", LineCnt );
+    points.clear();
 
-    // again to the beginning
-    Base::ifstream file(fi, std::ios::in);
-    LineCnt = 0;
+    // The lines are read in batches which are parsed in parallel
+    const std::size_t batchSize = 65536;
+    std::vector<std::string> lines;
+    std::vector<Base::Vector3d> batch;
+    std::vector<char> valid;
+    std::string line;
 
     try {
-        // read file
-        while (std::getline(file, line)) {
-            if (boost::regex_match(line.c_str(), what, rx)) {
-                pt.x = std::atof(what[1].first);
-                pt.y = std::atof(what[4].first);
-                pt.z = std::atof(what[7].first);
-
-                points.setPoint(LineCnt,pt);
-                seq.next();
-                LineCnt++;
+        while (file) {
+            lines.clear();
+            while (lines.size() < batchSize && std::getline(file, line))
+                lines.push_back(line);
+
+            batch.resize(lines.size());
+            valid.assign(lines.size(), 0);
+            parallelBlocks(lines.size(), [&](std::size_t first, std::size_t last) {
+                boost::cmatch what;
+                for (std::size_t i = first; i < last; i++) {
+                    if (boost::regex_match(lines[i].c_str(), what, rx)) {
+                        batch[i].x = std::atof(what[1].first);
+                        batch[i].y = std::atof(what[4].first);
+                        batch[i].z = std::atof(what[7].first);
+                        valid[i] = 1;
+                    }
+                }
+            });
+
+            for (std::size_t i = 0; i < lines.size(); i++) {
+                if (valid[i])
+                    points.push_back(batch[i]);
             }
+
+            std::streamoff pos = file.tellg();
+            if (pos > 0)
+                seq.setProgress(static_cast<size_t>(pos));
         }
     }
     catch (...) {
         points.clear();
         throw Base::BadFormatError("Reading in points failed.");
     }
+}
+
+// ----------------------------------------------------------------------------
+
+NormalEstimation::NormalEstimation(const PointKernel& pts)
+  : kernel(pts)
+  , kSearch(10)
+  , searchRadius(0)
+{
+}
+
+void NormalEstimation::setKSearch(int k)
+{
+    if (k < 1)
+        throw Base::ValueError("Number of neighbours must be at least 1");
+    kSearch = k;
+    searchRadius = 0;
+}
+
+void NormalEstimation::setSearchRadius(float radius)
+{
+    searchRadius = radius;
+}
+
+void NormalEstimation::perform(std::vector<Base::Vector3f>& normals) const
+{
+    std::vector<Base::Vector3f> points;
+    points.reserve(kernel.size());
+    for (PointKernel::const_point_iterator it = kernel.begin(); it != kernel.end(); ++it)
+        points.push_back(Base::convertTo<Base::Vector3f>(*it));
+
+    PointsKDTree tree(points);
+    normals.resize(points.size());
+
+    parallelBlocks(points.size(), [&](std::size_t first, std::size_t last) {
+        std::vector<PointsKDTree::size_type> indices;
+        std::vector<float> dists;
+        for (std::size_t i=first; i<last; i++) {
+            indices.clear();
+            if (searchRadius > 0)
+                tree.FindInRadius(points[i], searchRadius, indices);
+            else
+                tree.FindNearest(points[i], static_cast<PointsKDTree::size_type>(kSearch), indices, dists);
+
+            normals[i].Set(0.0f, 0.0f, 0.0f);
+            if (indices.size() < 3)
+                continue;
+
+            // covariance matrix of the neighbourhood
+            Eigen::Vector3d center(0.0, 0.0, 0.0);
+            for (auto it : indices)
+                center += Eigen::Vector3d(points[it].x, points[it].y, points[it].z);
+            center /= static_cast<double>(indices.size());
+
+            Eigen::Matrix3d cov = Eigen::Matrix3d::Zero();
+            for (auto it : indices) {
+                Eigen::Vector3d d = Eigen::Vector3d(points[it].x, points[it].y, points[it].z) - center;
+                cov += d * d.transpose();
+            }
+
+            // the eigenvalues are sorted in increasing order
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(cov);
+            Eigen::Vector3d n = solver.eigenvectors().col(0);
+            Base::Vector3f normal(static_cast<float>(n.x()), static_cast<float>(n.y()), static_cast<float>(n.z()));
+
+            // orient towards the origin as viewpoint
+            if (normal * points[i] > 0.0f)
+                normal = -normal;
+            normals[i] = normal;
+        }
+    });
+}
+
+// ----------------------------------------------------------------------------
+
+PointsFilter::PointsFilter(const PointKernel& pts)
+  : kernel(pts)
+{
+}
+
+std::vector<Base::Vector3f> PointsFilter::getPoints() const
+{
+    std::vector<Base::Vector3f> points;
+    points.reserve(kernel.size());
+    for (PointKernel::const_point_iterator it = kernel.begin(); it != kernel.end(); ++it)
+        points.push_back(Base::convertTo<Base::Vector3f>(*it));
+    return points;
+}
+
+std::vector<PointsFilter::size_type> PointsFilter::voxelGrid(float leafSize) const
+{
+    if (leafSize <= 0.0f)
+        throw Base::ValueError("Leaf size must be positive");
+
+    std::vector<Base::Vector3f> points = getPoints();
+    Base::BoundBox3f box;
+    for (const auto& it : points)
+        box.Add(it);
+
+    // the cell key packs 21 bits per axis
+    const uint64_t maxCells = uint64_t(1) << 21;
+    if (box.LengthX() / leafSize >= maxCells ||
+        box.LengthY() / leafSize >= maxCells ||
+        box.LengthZ() / leafSize >= maxCells)
+        throw Base::ValueError("Leaf size is too small for the extent of the points");
+
+    std::vector<uint64_t> keys(points.size());
+    parallelBlocks(points.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i=first; i<last; i++) {
+            uint64_t x = static_cast<uint64_t>((points[i].x - box.MinX) / leafSize);
+            uint64_t y = static_cast<uint64_t>((points[i].y - box.MinY) / leafSize);
+            uint64_t z = static_cast<uint64_t>((points[i].z - box.MinZ) / leafSize);
+            keys[i] = (x << 42) | (y << 21) | z;
+        }
+    });
+
+    std::vector<size_type> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&keys](size_type a, size_type b) {
+        return keys[a] < keys[b];
+    });
+
+    std::vector<size_type> result;
+    for (std::size_t first = 0; first < order.size();) {
+        std::size_t last = first + 1;
+        while (last < order.size() && keys[order[last]] == keys[order[first]])
+            last++;
+
+        Base::Vector3f center;
+        for (std::size_t i=first; i<last; i++)
+            center += points[order[i]];
+        center /= static_cast<float>(last - first);
+
+        size_type best = order[first];
+        float bestDist = FLT_MAX;
+        for (std::size_t i=first; i<last; i++) {
+            float dist = Base::DistanceP2(center, points[order[i]]);
+            if (dist < bestDist) {
+                bestDist = dist;
+                best = order[i];
+            }
+        }
+
+        result.push_back(best);
+        first = last;
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<PointsFilter::size_type> PointsFilter::poissonDisk(float radius) const
+{
+    if (radius <= 0.0f)
+        throw Base::ValueError("Radius must be positive");
+
+    std::vector<Base::Vector3f> points = getPoints();
+    Base::BoundBox3f box;
+    for (const auto& it : points)
+        box.Add(it);
+
+    const uint64_t maxCells = uint64_t(1) << 21;
+    if (box.LengthX() / radius >= maxCells - 1 ||
+        box.LengthY() / radius >= maxCells - 1 ||
+        box.LengthZ() / radius >= maxCells - 1)
+        throw Base::ValueError("Radius is too small for the extent of the points");
+
+    // The points are visited in a random but fixed order and a point is accepted if
+    // there is no accepted point within the radius. Accepted points are kept in a
+    // hash grid with the radius as cell size.
+    std::vector<size_type> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 rng(0);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    auto cellOf = [&](const Base::Vector3f& p, uint64_t& x, uint64_t& y, uint64_t& z) {
+        x = static_cast<uint64_t>((p.x - box.MinX) / radius) + 1;
+        y = static_cast<uint64_t>((p.y - box.MinY) / radius) + 1;
+        z = static_cast<uint64_t>((p.z - box.MinZ) / radius) + 1;
+    };
+
+    float radius2 = radius * radius;
+    std::unordered_map<uint64_t, std::vector<size_type> > grid;
+    std::vector<size_type> result;
+    for (auto index : order) {
+        const Base::Vector3f& p = points[index];
+        uint64_t x, y, z;
+        cellOf(p, x, y, z);
+
+        bool accept = true;
+        for (uint64_t i = x - 1; i <= x + 1 && accept; i++) {
+            for (uint64_t j = y - 1; j <= y + 1 && accept; j++) {
+                for (uint64_t k = z - 1; k <= z + 1 && accept; k++) {
+                    auto it = grid.find((i << 42) | (j << 21) | k);
+                    if (it == grid.end())
+                        continue;
+                    for (auto jt : it->second) {
+                        if (Base::DistanceP2(p, points[jt]) < radius2) {
+                            accept = false;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (accept) {
+            grid[(x << 42) | (y << 21) | z].push_back(index);
+            result.push_back(index);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<PointsFilter::size_type> PointsFilter::statisticalOutliers(int k, float stdDevMul) const
+{
+    if (k < 1)
+        throw Base::ValueError("Number of neighbours must be at least 1");
+
+    std::vector<Base::Vector3f> points = getPoints();
+    PointsKDTree tree(points);
+
+    // mean distance of each point to its neighbours, the point itself is the first hit
+    std::vector<double> meanDist(points.size(), 0.0);
+    parallelBlocks(points.size(), [&](std::size_t first, std::size_t last) {
+        std::vector<PointsKDTree::size_type> indices;
+        std::vector<float> dists;
+        for (std::size_t i=first; i<last; i++) {
+            tree.FindNearest(points[i], static_cast<PointsKDTree::size_type>(k + 1), indices, dists);
+            if (dists.size() > 1) {
+                double sum = std::accumulate(dists.begin() + 1, dists.end(), 0.0);
+                meanDist[i] = sum / static_cast<double>(dists.size() - 1);
+            }
+        }
+    });
+
+    std::vector<size_type> result;
+    if (points.empty())
+        return result;
+
+    double mean = std::accumulate(meanDist.begin(), meanDist.end(), 0.0) / meanDist.size();
+    double sqsum = 0.0;
+    for (auto it : meanDist)
+        sqsum += (it - mean) * (it - mean);
+    double stdDev = meanDist.size() > 1 ? std::sqrt(sqsum / (meanDist.size() - 1)) : 0.0;
+    double threshold = mean + stdDevMul * stdDev;
+
+    for (size_type i=0; i<meanDist.size(); i++) {
+        if (meanDist[i] <= threshold)
+            result.push_back(i);
+    }
 
-    // now remove the last points from the kernel
-    // Note: first we allocate memory corresponding to the number of lines (points and comments)
-    //       and read in the file twice. But then the size of the kernel is too high
-    if (LineCnt < (int)points.size())
-        points.erase(LineCnt, points.size());
+    return result;
 }
 
 // ----------------------------------------------------------------------------
@@ -205,7 +504,9 @@ AscReader::~AscReader()
 
 void AscReader::read(const std::string& filename)
 {
+    Base::TimeInfo start;
     points.load(filename.c_str());
+    logThroughput(filename, points.size(), start);
 }
 
 // ----------------------------------------------------------------------------
@@ -217,6 +518,7 @@ public:
     virtual ~Converter() = default;
     virtual std::string toString(double) const = 0;
     virtual double toDouble(Base::InputStream&) const = 0;
+    virtual double toDouble(const char*, bool swapByteOrder) const = 0;
     virtual int getSizeOf() const = 0;
 
 private:
@@ -241,6 +543,13 @@ public:
         str >> c;
         return static_cast<double>(c);
     }
+    virtual double toDouble(const char* data, bool swapByteOrder) const {
+        T c;
+        std::memcpy(&c, data, sizeof(T));
+        if (swapByteOrder)
+            Base::SwapEndian<T>(c);
+        return static_cast<double>(c);
+    }
     virtual int getSizeOf() const {
         return sizeof(T);
     }
@@ -248,6 +557,92 @@ public:
 
 typedef std::shared_ptr<Converter> ConverterPtr;
 
+Base::Stream::ByteOrder hostByteOrder()
+{
+    return Base::SwapOrder() == LOW_ENDIAN ? Base::Stream::LittleEndian : Base::Stream::BigEndian;
+}
+
+/* Decodes the binary records of \a buffer in parallel. The values are swapped only if the
+ * \a byteOrder of the file differs from the host. If \a transpose is true the buffer keeps
+ * one array per field, otherwise one record per point. */
+void decodeBinary(const std::vector<char>& buffer,
+                  const std::vector<ConverterPtr>& converters,
+                  Base::Stream::ByteOrder byteOrder, bool transpose,
+                  Eigen::MatrixXd& data)
+{
+    bool swapByteOrder = (byteOrder != hostByteOrder());
+    std::size_t numPoints = data.rows();
+    std::size_t numFields = data.cols();
+
+    std::vector<std::size_t> sizes(numFields), offsets(numFields);
+    std::size_t rowSize = 0;
+    for (std::size_t j=0; j<numFields; j++) {
+        sizes[j] = converters[j]->getSizeOf();
+        offsets[j] = transpose ? rowSize * numPoints : rowSize;
+        rowSize += sizes[j];
+    }
+
+    parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i=first; i<last; i++) {
+            for (std::size_t j=0; j<numFields; j++) {
+                std::size_t pos = transpose ? offsets[j] + i * sizes[j] : i * rowSize + offsets[j];
+                data(i, j) = converters[j]->toDouble(&buffer[pos], swapByteOrder);
+            }
+        }
+    });
+}
+
+/* Reads the ASCII records into \a data. The first \a offset non-empty lines are skipped.
+ * The lines are read in batches which are parsed in parallel. */
+void decodeAscii(std::istream& inp, std::size_t offset, Eigen::MatrixXd& data)
+{
+    std::size_t numPoints = data.rows();
+    std::size_t numFields = data.cols();
+    const std::size_t batchSize = 65536;
+    std::vector<std::string> lines;
+    std::string line;
+    std::size_t row = 0;
+    std::atomic<bool> failed(false);
+
+    while (row < numPoints && inp) {
+        lines.clear();
+        while (row + lines.size() < numPoints && lines.size() < batchSize && std::getline(inp, line)) {
+            if (line.empty())
+                continue;
+
+            if (offset > 0) {
+                offset--;
+                continue;
+            }
+
+            lines.push_back(line);
+        }
+
+        parallelBlocks(lines.size(), [&](std::size_t first, std::size_t last) {
+            std::vector<std::string> list;
+            try {
+                for (std::size_t i=first; i<last; i++) {
+                    // since the file is loaded in binary mode we may get the CR at the end
+                    boost::trim(lines[i]);
+                    boost::split(list, lines[i], boost::is_any_of ("\t\r "), boost::token_compress_on);
+
+                    for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
+                        double value = boost::lexical_cast<double>(list[col]);
+                        data(row + i, col) = value;
+                    }
+                }
+            }
+            catch (const boost::bad_lexical_cast&) {
+                failed = true;
+            }
+        });
+
+        if (failed)
+            throw Base::BadFormatError("Invalid number in point data");
+        row += lines.size();
+    }
+}
+
 class DataStreambuf : public std::streambuf
 {
 public:
@@ -517,6 +912,7 @@ PlyReader::~PlyReader()
 
 void PlyReader::read(const std::string& filename)
 {
+    Base::TimeInfo start;
     clear();
     this->width = 1;
     this->height = 0;
@@ -536,10 +932,10 @@ void PlyReader::read(const std::string& filename)
         readAscii(inp, offset, data);
     }
     else if (format == "binary_little_endian") {
-        readBinary(false, inp, offset, types, sizes, data);
+        readBinary(Base::Stream::LittleEndian, inp, offset, types, sizes, data);
     }
     else if (format == "binary_big_endian") {
-        readBinary(true, inp, offset, types, sizes, data);
+        readBinary(Base::Stream::BigEndian, inp, offset, types, sizes, data);
     }
 
     std::vector<std::string>::iterator it;
@@ -618,53 +1014,64 @@ void PlyReader::read(const std::string& filename)
     bool hasColor = (red != max_size && green != max_size && blue != max_size);
 
     if (hasData) {
-        points.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            points.push_back(Base::Vector3d(data(i,x),data(i,y),data(i,z)));
-        }
+        // the kernel has no placement, so the points can be set directly
+        std::vector<Base::Vector3f>& pts = points.getBasicPoints();
+        pts.resize(numPoints);
+        parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i=first; i<last; i++) {
+                pts[i].Set(data(i,x),data(i,y),data(i,z));
+            }
+        });
     }
 
     if (hasData && hasNormal) {
-        normals.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            normals.emplace_back(data(i,normal_x),data(i,normal_y),data(i,normal_z));
-        }
+        normals.resize(numPoints);
+        parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i=first; i<last; i++) {
+                normals[i].Set(data(i,normal_x),data(i,normal_y),data(i,normal_z));
+            }
+        });
     }
 
     if (hasData && hasIntensity) {
-        intensity.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            intensity.push_back(data(i,greyvalue));
-        }
+        intensity.resize(numPoints);
+        parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i=first; i<last; i++) {
+                intensity[i] = data(i,greyvalue);
+            }
+        });
     }
 
     if (hasData && hasColor) {
-        colors.reserve(numPoints);
-        float a = 1.0;
+        colors.resize(numPoints);
         if (types[red] == "uchar") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                float r = data(i, red);
-                float g = data(i, green);
-                float b = data(i, blue);
-                if (alpha != max_size)
-                    a = data(i, alpha);
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                    static_cast<float>(g)/255.0f,
-                                    static_cast<float>(b)/255.0f,
-                                    static_cast<float>(a)/255.0f);
-            }
+            parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i=first; i<last; i++) {
+                    float r = data(i, red);
+                    float g = data(i, green);
+                    float b = data(i, blue);
+                    float a = alpha != max_size ? data(i, alpha) : 1.0f;
+                    colors[i].set(static_cast<float>(r)/255.0f,
+                                  static_cast<float>(g)/255.0f,
+                                  static_cast<float>(b)/255.0f,
+                                  static_cast<float>(a)/255.0f);
+                }
+            });
         }
         else if (types[red] == "float") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                float r = data(i, red);
-                float g = data(i, green);
-                float b = data(i, blue);
-                if (alpha != max_size)
-                    a = data(i, alpha);
-                colors.emplace_back(r, g, b, a);
-            }
+            parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i=first; i<last; i++) {
+                    float r = data(i, red);
+                    float g = data(i, green);
+                    float b = data(i, blue);
+                    float a = alpha != max_size ? data(i, alpha) : 1.0f;
+                    colors[i].set(r, g, b, a);
+                }
+            });
         }
     }
+
+    logThroughput(filename, points.size(), start);
 }
 
 std::size_t PlyReader::readHeader(std::istream& in,
@@ -837,36 +1244,10 @@ std::size_t PlyReader::readHeader(std::istream& in,
 
 void PlyReader::readAscii(std::istream& inp, std::size_t offset, Eigen::MatrixXd& data)
 {
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        if (offset > 0) {
-            offset--;
-            continue;
-        }
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
+    decodeAscii(inp, offset, data);
 }
 
-void PlyReader::readBinary(bool swapByteOrder,
+void PlyReader::readBinary(Base::Stream::ByteOrder byteOrder,
                            std::istream& inp,
                            std::size_t offset,
                            const std::vector<std::string>& types,
@@ -940,14 +1321,12 @@ void PlyReader::readBinary(bool swapByteOrder,
             throw Base::BadFormatError("File expects too many elements");
     }
 
-    Base::InputStream str(inp);
-    str.setByteOrder(swapByteOrder ? Base::Stream::BigEndian : Base::Stream::LittleEndian);
-    for (std::size_t i=0; i<numPoints; i++) {
-        for (std::size_t j=0; j<numFields; j++) {
-            double value = converters[j]->toDouble(str);
-            data(i, j) = value;
-        }
-    }
+    // read the whole vertex block at once and decode it in parallel
+    std::vector<char> buffer(neededSize * numPoints);
+    inp.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (inp.gcount() != static_cast<std::streamsize>(buffer.size()))
+        throw Base::BadFormatError("File expects too many elements");
+    decodeBinary(buffer, converters, byteOrder, false, data);
 }
 
 // ----------------------------------------------------------------------------
@@ -962,6 +1341,7 @@ PcdReader::~PcdReader()
 
 void PcdReader::read(const std::string& filename)
 {
+    Base::TimeInfo start;
     clear();
     this->width = -1;
     this->height = -1;
@@ -1067,58 +1447,72 @@ void PcdReader::read(const std::string& filename)
     bool hasColor = (rgba != max_size);
 
     if (hasData) {
-        points.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            points.push_back(Base::Vector3d(data(i,x),data(i,y),data(i,z)));
-        }
+        // the kernel has no placement, so the points can be set directly
+        std::vector<Base::Vector3f>& pts = points.getBasicPoints();
+        pts.resize(numPoints);
+        parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i=first; i<last; i++) {
+                pts[i].Set(data(i,x),data(i,y),data(i,z));
+            }
+        });
     }
 
     if (hasData && hasNormal) {
-        normals.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            normals.emplace_back(data(i,normal_x),data(i,normal_y),data(i,normal_z));
-        }
+        normals.resize(numPoints);
+        parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i=first; i<last; i++) {
+                normals[i].Set(data(i,normal_x),data(i,normal_y),data(i,normal_z));
+            }
+        });
     }
 
     if (hasData && hasIntensity) {
-        intensity.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            intensity.push_back(data(i,greyvalue));
-        }
+        intensity.resize(numPoints);
+        parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i=first; i<last; i++) {
+                intensity[i] = data(i,greyvalue);
+            }
+        });
     }
 
     if (hasData && hasColor) {
-        colors.reserve(numPoints);
+        colors.resize(numPoints);
         if (types[rgba] == "U") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                uint32_t packed = static_cast<uint32_t>(data(i,rgba));
-                uint32_t a = (packed >> 24) & 0xff;
-                uint32_t r = (packed >> 16) & 0xff;
-                uint32_t g = (packed >> 8) & 0xff;
-                uint32_t b = packed & 0xff;
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                    static_cast<float>(g)/255.0f,
-                                    static_cast<float>(b)/255.0f,
-                                    static_cast<float>(a)/255.0f);
-            }
+            parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i=first; i<last; i++) {
+                    uint32_t packed = static_cast<uint32_t>(data(i,rgba));
+                    uint32_t a = (packed >> 24) & 0xff;
+                    uint32_t r = (packed >> 16) & 0xff;
+                    uint32_t g = (packed >> 8) & 0xff;
+                    uint32_t b = packed & 0xff;
+                    colors[i].set(static_cast<float>(r)/255.0f,
+                                  static_cast<float>(g)/255.0f,
+                                  static_cast<float>(b)/255.0f,
+                                  static_cast<float>(a)/255.0f);
+                }
+            });
         }
         else if (types[rgba] == "F") {
             static_assert(sizeof(float) == sizeof(uint32_t), "float and uint32_t have different sizes");
-            for (std::size_t i=0; i<numPoints; i++) {
-                float f = static_cast<float>(data(i,rgba));
-                uint32_t packed;
-                std::memcpy(&packed, &f, sizeof(packed));
-                uint32_t a = (packed >> 24) & 0xff;
-                uint32_t r = (packed >> 16) & 0xff;
-                uint32_t g = (packed >> 8) & 0xff;
-                uint32_t b = packed & 0xff;
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                    static_cast<float>(g)/255.0f,
-                                    static_cast<float>(b)/255.0f,
-                                    static_cast<float>(a)/255.0f);
-            }
+            parallelBlocks(numPoints, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i=first; i<last; i++) {
+                    float f = static_cast<float>(data(i,rgba));
+                    uint32_t packed;
+                    std::memcpy(&packed, &f, sizeof(packed));
+                    uint32_t a = (packed >> 24) & 0xff;
+                    uint32_t r = (packed >> 16) & 0xff;
+                    uint32_t g = (packed >> 8) & 0xff;
+                    uint32_t b = packed & 0xff;
+                    colors[i].set(static_cast<float>(r)/255.0f,
+                                  static_cast<float>(g)/255.0f,
+                                  static_cast<float>(b)/255.0f,
+                                  static_cast<float>(a)/255.0f);
+                }
+            });
         }
     }
+
+    logThroughput(filename, points.size(), start);
 }
 
 std::size_t PcdReader::readHeader(std::istream& in,
@@ -1195,28 +1589,7 @@ std::size_t PcdReader::readHeader(std::istream& in,
 
 void PcdReader::readAscii(std::istream& inp, Eigen::MatrixXd& data)
 {
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
+    decodeAscii(inp, 0, data);
 }
 
 void PcdReader::readBinary(bool transpose,
@@ -1292,23 +1665,13 @@ void PcdReader::readBinary(bool transpose,
             throw Base::BadFormatError("File expects too many elements");
     }
 
-    Base::InputStream str(inp);
-    if (transpose) {
-        for (std::size_t j=0; j<numFields; j++) {
-            for (std::size_t i=0; i<numPoints; i++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
-    else {
-        for (std::size_t i=0; i<numPoints; i++) {
-            for (std::size_t j=0; j<numFields; j++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
+    // read the whole data block at once and decode it in parallel
+    std::vector<char> buffer(neededSize * numPoints);
+    inp.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (inp.gcount() != static_cast<std::streamsize>(buffer.size()))
+        throw Base::BadFormatError("File expects too many elements");
+    // PCD stores the binary data in the byte order of the machine that wrote it
+    decodeBinary(buffer, converters, hostByteOrder(), transpose, data);
 }
 
 // ----------------------------------------------------------------------------
@@ -1326,6 +1689,7 @@ E57Reader::~E57Reader()
 
 void E57Reader::read(const std::string& filename)
 {
+    Base::TimeInfo start;
     try {
         // read file
         e57::ImageFile imfi(filename, "r");
@@ -1336,13 +1700,13 @@ void E57Reader::read(const std::string& filename)
                 e57::StructureNode            scan_data(data3D.get(child));
                 e57::CompressedVectorNode     cvn(scan_data.get("points"));
                 e57::StructureNode            prototype(cvn.prototype());
-                // create buffers for the compressed vector reader
-                const size_t buf_size = 1024;
-                double xyz[buf_size * 3];
-                double intensity[buf_size];
-                int64_t state[buf_size];
-                unsigned rgb[buf_size * 3];
-                int64_t nil[buf_size];
+                // create buffers for the compressed vector reader, large buffers
+                // reduce the overhead of the decoder per call
+                const size_t buf_size = 65536;
+                std::vector<double> xyz(buf_size * 3);
+                std::vector<double> intensity(buf_size);
+                std::vector<int64_t> state(buf_size);
+                std::vector<unsigned> rgb(buf_size * 3);
 
                 // check the channels which are needed
                 unsigned ptr_xyz[3];
@@ -1407,19 +1771,6 @@ void E57Reader::read(const std::string& filename)
                                 )
                             );
                         }
-                        else {
-                            sdb.push_back(
-                                e57::SourceDestBuffer(
-                                    imfi
-                                    , n.elementName()
-                                    , &(nil[0])
-                                    , buf_size
-                                    , true
-                                    , true
-                                )
-                            );
-                        }
-
                     }
                     else if (n.type() == e57::E57_INTEGER) {
                         if (n.elementName() == "colorRed") {
@@ -1474,18 +1825,6 @@ void E57Reader::read(const std::string& filename)
                                 )
                             );
                         }
-                        else {
-                            sdb.push_back(
-                                e57::SourceDestBuffer(
-                                    imfi
-                                    , n.elementName()
-                                    , &(nil[0])
-                                    , buf_size
-                                    , true
-                                    , true
-                                )
-                            );
-                        }
                     }
                 }
 
@@ -1500,6 +1839,12 @@ void E57Reader::read(const std::string& filename)
                     bool hasState = inv_state && checkState;
                     bool filter = false;
 
+                    // avoid re-allocations while appending the records of the scan
+                    std::size_t numRecords = static_cast<std::size_t>(cvn.childCount());
+                    points.reserve(points.size() + numRecords);
+                    if (hasColor)
+                        colors.reserve(colors.size() + numRecords);
+
                     while ((count = cvr.read())) {
                         for (size_t i = 0; i < count; ++i) {
                             filter = false;
@@ -1540,6 +1885,8 @@ void E57Reader::read(const std::string& filename)
         points.clear();
         throw Base::BadFormatError("E57");
     }
+
+    logThroughput(filename, points.size(), start);
 }
 
 // ----------------------------------------------------------------------------
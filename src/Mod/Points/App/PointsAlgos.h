@@ -26,6 +26,7 @@
 
 #include "Points.h"
 #include "Properties.h"
+#include <Base/Stream.h>
 #include <Eigen/Core>
 
 namespace Points
@@ -44,6 +45,57 @@ public:
     static void LoadAscii(PointKernel&, const char *FileName);
 };
 
+/**
+ * The NormalEstimation class computes the normals of a point cloud without the need of PCL.
+ * The normal of a point is the direction of least variance of its neighbourhood (PCA). The
+ * neighbours are either the k nearest points or all points within a radius. The normals are
+ * oriented towards the origin and are zero if there are less than three neighbours.
+ */
+class PointsExport NormalEstimation
+{
+public:
+    NormalEstimation(const PointKernel&);
+    /// Sets the number of nearest neighbours, the default is 10. Throws if \a k is less than 1.
+    void setKSearch(int k);
+    /// Uses all points inside the radius as neighbours instead of the k nearest points.
+    void setSearchRadius(float radius);
+    /// Computes the normals in parallel.
+    void perform(std::vector<Base::Vector3f>& normals) const;
+
+private:
+    const PointKernel& kernel;
+    int kSearch;
+    float searchRadius;
+};
+
+/**
+ * The PointsFilter class thins out or cleans a point cloud. All methods return the indices of
+ * the points to keep in increasing order, so that the properties of the points like colors
+ * or normals can be filtered as well.
+ */
+class PointsExport PointsFilter
+{
+public:
+    typedef PointKernel::size_type size_type;
+
+    PointsFilter(const PointKernel&);
+    /** Divides the space into cubes of the edge length \a leafSize and keeps from each
+     * cube the point that is closest to the centroid of its points. */
+    std::vector<size_type> voxelGrid(float leafSize) const;
+    /** Keeps a subset of points so that no two points are closer than \a radius and every
+     * removed point is within \a radius of a kept point. The result is deterministic. */
+    std::vector<size_type> poissonDisk(float radius) const;
+    /** Removes the points whose mean distance to their \a k nearest neighbours exceeds the
+     * average of all points by more than \a stdDevMul standard deviations. */
+    std::vector<size_type> statisticalOutliers(int k, float stdDevMul) const;
+
+private:
+    std::vector<Base::Vector3f> getPoints() const;
+
+private:
+    const PointKernel& kernel;
+};
+
 class Reader
 {
 public:
@@ -92,7 +144,7 @@ private:
         std::vector<std::string>& fields, std::vector<std::string>& types,
         std::vector<int>& sizes);
     void readAscii(std::istream&, std::size_t offset, Eigen::MatrixXd& data);
-    void readBinary(bool swapByteOrder, std::istream&, std::size_t offset,
+    void readBinary(Base::Stream::ByteOrder, std::istream&, std::size_t offset,
         const std::vector<std::string>& types,
         const std::vector<int>& sizes,
         Eigen::MatrixXd& data);
@@ -0,0 +1,255 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+#endif
+
+#include <QtConcurrentRun>
+#include <QThread>
+
+#include <Base/Converter.h>
+
+#include "PointsKDTree.h"
+
+using namespace Points;
+
+namespace {
+// ranges up to this size are searched linearly
+const PointsKDTree::size_type LeafSize = 8;
+// ranges smaller than this are always built in the calling thread
+const PointsKDTree::size_type ParallelSize = 65536;
+}
+
+PointsKDTree::PointsKDTree(const PointKernel& kernel)
+{
+    _entries.resize(kernel.size());
+    size_type index = 0;
+    for (PointKernel::const_point_iterator it = kernel.begin(); it != kernel.end(); ++it, ++index) {
+        Entry& entry = _entries[index];
+        entry.point = Base::convertTo<Base::Vector3f>(*it);
+        entry.index = index;
+    }
+
+    Build();
+}
+
+PointsKDTree::PointsKDTree(const std::vector<Base::Vector3f>& points)
+{
+    _entries.resize(points.size());
+    for (size_type index = 0; index < points.size(); index++) {
+        _entries[index].point = points[index];
+        _entries[index].index = index;
+    }
+
+    Build();
+}
+
+PointsKDTree::~PointsKDTree()
+{
+}
+
+void PointsKDTree::Build()
+{
+    // split the work until each thread has at least one sub-tree
+    _parallelDepth = 0;
+    for (int threads = 1; threads < QThread::idealThreadCount(); threads *= 2)
+        _parallelDepth++;
+
+    _axes.resize(_entries.size());
+    Build(0, _entries.size(), 0);
+}
+
+void PointsKDTree::Build(size_type first, size_type last, int depth)
+{
+    if (last - first <= LeafSize)
+        return;
+
+    // split along the axis of the largest extent
+    Base::BoundBox3f box;
+    for (size_type i = first; i < last; i++)
+        box.Add(_entries[i].point);
+
+    float lengths[3] = {box.LengthX(), box.LengthY(), box.LengthZ()};
+    unsigned char axis = static_cast<unsigned char>(std::max_element(lengths, lengths + 3) - lengths);
+
+    size_type mid = first + (last - first) / 2;
+    std::nth_element(_entries.begin() + first, _entries.begin() + mid, _entries.begin() + last,
+                     [axis](const Entry& a, const Entry& b) {
+        return a.point[axis] < b.point[axis];
+    });
+    _axes[mid] = axis;
+
+    // the two halves are independent and can be built concurrently
+    if (depth < _parallelDepth && last - first > ParallelSize) {
+        QFuture<void> future = QtConcurrent::run([this, first, mid, depth]() {
+            Build(first, mid, depth + 1);
+        });
+        Build(mid + 1, last, depth + 1);
+        future.waitForFinished();
+    }
+    else {
+        Build(first, mid, depth + 1);
+        Build(mid + 1, last, depth + 1);
+    }
+}
+
+bool PointsKDTree::FindNearest(const Base::Vector3f& point, float maxDist, size_type& index, float& dist) const
+{
+    CandidateQueue queue;
+    float maxDist2 = maxDist < FLT_MAX ? maxDist * maxDist : FLT_MAX;
+    SearchNearest(0, _entries.size(), point, 1, maxDist2, queue);
+    if (queue.empty())
+        return false;
+
+    index = queue.top().second;
+    dist = std::sqrt(queue.top().first);
+    return true;
+}
+
+void PointsKDTree::FindNearest(const Base::Vector3f& point, size_type k,
+                               std::vector<size_type>& indices, std::vector<float>& dists) const
+{
+    indices.clear();
+    dists.clear();
+    if (k == 0)
+        return;
+
+    CandidateQueue queue;
+    SearchNearest(0, _entries.size(), point, k, FLT_MAX, queue);
+
+    // the queue returns the farthest point first
+    indices.resize(queue.size());
+    dists.resize(queue.size());
+    for (size_type i = queue.size(); i > 0; i--) {
+        indices[i - 1] = queue.top().second;
+        dists[i - 1] = std::sqrt(queue.top().first);
+        queue.pop();
+    }
+}
+
+void PointsKDTree::FindInRadius(const Base::Vector3f& point, float radius, std::vector<size_type>& indices) const
+{
+    SearchRadius(0, _entries.size(), point, radius * radius, indices);
+}
+
+void PointsKDTree::FindInBox(const Base::BoundBox3f& box, std::vector<size_type>& indices) const
+{
+    SearchBox(0, _entries.size(), box, indices);
+}
+
+void PointsKDTree::SearchNearest(size_type first, size_type last, const Base::Vector3f& point,
+                                 size_type k, float maxDist2, CandidateQueue& queue) const
+{
+    auto check = [&](const Entry& entry) {
+        float dist2 = Base::DistanceP2(point, entry.point);
+        if (dist2 > maxDist2)
+            return;
+        if (queue.size() < k) {
+            queue.emplace(dist2, entry.index);
+        }
+        else if (dist2 < queue.top().first) {
+            queue.pop();
+            queue.emplace(dist2, entry.index);
+        }
+    };
+
+    if (last - first <= LeafSize) {
+        for (size_type i = first; i < last; i++)
+            check(_entries[i]);
+        return;
+    }
+
+    size_type mid = first + (last - first) / 2;
+    const Entry& split = _entries[mid];
+    unsigned char axis = _axes[mid];
+    float diff = point[axis] - split.point[axis];
+
+    check(split);
+    if (diff < 0.0f)
+        SearchNearest(first, mid, point, k, maxDist2, queue);
+    else
+        SearchNearest(mid + 1, last, point, k, maxDist2, queue);
+
+    // visit the other side only if it can contain a closer point
+    float diff2 = diff * diff;
+    if (diff2 <= maxDist2 && (queue.size() < k || diff2 < queue.top().first)) {
+        if (diff < 0.0f)
+            SearchNearest(mid + 1, last, point, k, maxDist2, queue);
+        else
+            SearchNearest(first, mid, point, k, maxDist2, queue);
+    }
+}
+
+void PointsKDTree::SearchRadius(size_type first, size_type last, const Base::Vector3f& point,
+                                float radius2, std::vector<size_type>& indices) const
+{
+    if (last - first <= LeafSize) {
+        for (size_type i = first; i < last; i++) {
+            if (Base::DistanceP2(point, _entries[i].point) <= radius2)
+                indices.push_back(_entries[i].index);
+        }
+        return;
+    }
+
+    size_type mid = first + (last - first) / 2;
+    const Entry& split = _entries[mid];
+    unsigned char axis = _axes[mid];
+    float diff = point[axis] - split.point[axis];
+
+    if (Base::DistanceP2(point, split.point) <= radius2)
+        indices.push_back(split.index);
+    if (diff <= 0.0f || diff * diff <= radius2)
+        SearchRadius(first, mid, point, radius2, indices);
+    if (diff >= 0.0f || diff * diff <= radius2)
+        SearchRadius(mid + 1, last, point, radius2, indices);
+}
+
+void PointsKDTree::SearchBox(size_type first, size_type last, const Base::BoundBox3f& box,
+                             std::vector<size_type>& indices) const
+{
+    if (last - first <= LeafSize) {
+        for (size_type i = first; i < last; i++) {
+            if (box.IsInBox(_entries[i].point))
+                indices.push_back(_entries[i].index);
+        }
+        return;
+    }
+
+    size_type mid = first + (last - first) / 2;
+    const Entry& split = _entries[mid];
+    unsigned char axis = _axes[mid];
+    float minValue = axis == 0 ? box.MinX : (axis == 1 ? box.MinY : box.MinZ);
+    float maxValue = axis == 0 ? box.MaxX : (axis == 1 ? box.MaxY : box.MaxZ);
+    float value = split.point[axis];
+
+    if (box.IsInBox(split.point))
+        indices.push_back(split.index);
+    if (minValue <= value)
+        SearchBox(first, mid, box, indices);
+    if (maxValue >= value)
+        SearchBox(mid + 1, last, box, indices);
+}
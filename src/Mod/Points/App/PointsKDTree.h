@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright (c) 2022 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_KDTREE_H
+#define POINTS_KDTREE_H
+
+#include <cfloat>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <Base/BoundBox.h>
+#include <Base/Vector3D.h>
+
+#include "Points.h"
+
+namespace Points
+{
+
+/**
+ * The PointsKDTree class is a static k-d tree over a point cloud.
+ *
+ * The tree is balanced and built once with the points in global coordinates. The
+ * points are kept in tree order in one array, the median of a range is its split
+ * point. The upper levels of the tree are built in parallel.
+ *
+ * All queries are const and can be run from several threads at the same time. The
+ * returned indices refer to the points of the kernel the tree was built from.
+ */
+class PointsExport PointsKDTree
+{
+public:
+    typedef PointKernel::size_type size_type;
+
+    /// Construction
+    PointsKDTree(const PointKernel& kernel);
+    /// Construction
+    PointsKDTree(const std::vector<Base::Vector3f>& points);
+    /// Destruction
+    ~PointsKDTree();
+
+    PointsKDTree(const PointsKDTree&) = delete;
+    PointsKDTree& operator = (const PointsKDTree&) = delete;
+
+    /// Number of points in the tree
+    size_type Size() const
+    { return _entries.size(); }
+    bool IsEmpty() const
+    { return _entries.empty(); }
+
+    /** @name Search */
+    //@{
+    /** Searches for the nearest point to \a point that is not farther away than \a maxDist.
+     * Returns false if there is no such point.
+     */
+    bool FindNearest(const Base::Vector3f& point, float maxDist, size_type& index, float& dist) const;
+    /** Searches for the \a k nearest points to \a point. The indices and distances are sorted
+     * by increasing distance.
+     */
+    void FindNearest(const Base::Vector3f& point, size_type k,
+                     std::vector<size_type>& indices, std::vector<float>& dists) const;
+    /// Searches for all points with a distance to \a point less or equal to \a radius.
+    void FindInRadius(const Base::Vector3f& point, float radius, std::vector<size_type>& indices) const;
+    /// Searches for all points inside the box.
+    void FindInBox(const Base::BoundBox3f& box, std::vector<size_type>& indices) const;
+    //@}
+
+private:
+    struct Entry
+    {
+        Base::Vector3f point;
+        size_type index;
+    };
+    typedef std::pair<float, size_type> Candidate;
+    typedef std::priority_queue<Candidate> CandidateQueue;
+
+    void Build();
+    void Build(size_type first, size_type last, int depth);
+    void SearchNearest(size_type first, size_type last, const Base::Vector3f& point,
+                       size_type k, float maxDist2, CandidateQueue& queue) const;
+    void SearchRadius(size_type first, size_type last, const Base::Vector3f& point,
+                      float radius2, std::vector<size_type>& indices) const;
+    void SearchBox(size_type first, size_type last, const Base::BoundBox3f& box,
+                   std::vector<size_type>& indices) const;
+
+private:
+    std::vector<Entry> _entries;
+    std::vector<unsigned char> _axes;
+    int _parallelDepth;
+};
+
+} // namespace Points
+
+
+#endif // POINTS_KDTREE_H
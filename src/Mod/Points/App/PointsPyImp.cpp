@@ -23,8 +23,19 @@
 
 #include "PreCompiled.h"
 
+#ifndef _PreComp_
+# include <algorithm>
+# include <numeric>
+#endif
+
+#include <QtConcurrentMap>
+
 #include "Mod/Points/App/Points.h"
+#include "Mod/Points/App/PointsAlgos.h"
+#include "Mod/Points/App/PointsKDTree.h"
+#include <Base/BoundBoxPy.h>
 #include <Base/Builder3D.h>
+#include <Base/Converter.h>
 #include <Base/VectorPy.h>
 #include <Base/GeometryPyCXX.h>
 #include <boost/math/special_functions/fpclassify.hpp>
@@ -217,6 +228,173 @@ PyObject* PointsPy::fromValid(PyObject * args)
     }
 }
 
+namespace {
+Py::List indicesToList(const std::vector<PointsFilter::size_type>& indices)
+{
+    Py::List list;
+    for (auto it : indices)
+        list.append(Py::Long(static_cast<long>(it)));
+    return list;
+}
+}
+
+PyObject* PointsPy::nearestNeighbours(PyObject * args)
+{
+    PyObject *obj;
+    int k;
+    if (!PyArg_ParseTuple(args, "Oi", &obj, &k))
+        return nullptr;
+
+    if (k < 1) {
+        PyErr_SetString(PyExc_ValueError, "K must be at least 1");
+        return nullptr;
+    }
+
+    std::vector<Base::Vector3f> queries;
+    bool single = PyObject_TypeCheck(obj, &(Base::VectorPy::Type));
+    try {
+        if (single) {
+            queries.push_back(Base::convertTo<Base::Vector3f>(Py::Vector(obj, false).toVector()));
+        }
+        else {
+            Py::Sequence list(obj);
+            queries.reserve(list.size());
+            for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+                Py::Vector pnt(*it);
+                queries.push_back(Base::convertTo<Base::Vector3f>(pnt.toVector()));
+            }
+        }
+    }
+    catch (const Py::Exception&) {
+        PyErr_SetString(PyExc_TypeError, "either expect\n"
+            "-- Vector\n"
+            "-- [Vector,...]");
+        return nullptr;
+    }
+
+    PY_TRY {
+        PointsKDTree tree(*getPointKernelPtr());
+        std::vector<std::vector<PointsKDTree::size_type> > results(queries.size());
+        std::vector<std::size_t> indices(queries.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        QtConcurrent::blockingMap(indices, [&](std::size_t index) {
+            std::vector<float> dists;
+            tree.FindNearest(queries[index], static_cast<PointsKDTree::size_type>(k), results[index], dists);
+        });
+
+        Py::List list;
+        for (const auto& it : results) {
+            Py::List neighbours;
+            for (auto jt : it)
+                neighbours.append(Py::Long(static_cast<long>(jt)));
+            if (single)
+                return Py::new_reference_to(neighbours);
+            list.append(neighbours);
+        }
+
+        return Py::new_reference_to(list);
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::pointsInRadius(PyObject * args)
+{
+    PyObject *obj;
+    double radius;
+    if (!PyArg_ParseTuple(args, "O!d", &(Base::VectorPy::Type), &obj, &radius))
+        return nullptr;
+
+    PY_TRY {
+        Base::Vector3d pnt = static_cast<Base::VectorPy*>(obj)->value();
+        PointsKDTree tree(*getPointKernelPtr());
+        std::vector<PointsKDTree::size_type> indices;
+        tree.FindInRadius(Base::convertTo<Base::Vector3f>(pnt), static_cast<float>(radius), indices);
+        std::sort(indices.begin(), indices.end());
+        return Py::new_reference_to(indicesToList(indices));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::pointsInBox(PyObject * args)
+{
+    PyObject *obj;
+    if (!PyArg_ParseTuple(args, "O!", &(Base::BoundBoxPy::Type), &obj))
+        return nullptr;
+
+    PY_TRY {
+        Base::BoundBox3d box = *static_cast<Base::BoundBoxPy*>(obj)->getBoundBoxPtr();
+        Base::BoundBox3f boxf(static_cast<float>(box.MinX), static_cast<float>(box.MinY),
+                              static_cast<float>(box.MinZ), static_cast<float>(box.MaxX),
+                              static_cast<float>(box.MaxY), static_cast<float>(box.MaxZ));
+        PointsKDTree tree(*getPointKernelPtr());
+        std::vector<PointsKDTree::size_type> indices;
+        tree.FindInBox(boxf, indices);
+        std::sort(indices.begin(), indices.end());
+        return Py::new_reference_to(indicesToList(indices));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::estimateNormals(PyObject *args, PyObject *kwds)
+{
+    int kSearch = 10;
+    double searchRadius = 0;
+    static char* kwds_normals[] = {"KSearch", "SearchRadius", nullptr};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|id", kwds_normals, &kSearch, &searchRadius))
+        return nullptr;
+
+    PY_TRY {
+        NormalEstimation estimation(*getPointKernelPtr());
+        if (searchRadius > 0)
+            estimation.setSearchRadius(static_cast<float>(searchRadius));
+        else
+            estimation.setKSearch(kSearch);
+
+        std::vector<Base::Vector3f> normals;
+        estimation.perform(normals);
+
+        Py::List list;
+        for (const auto& it : normals)
+            list.append(Py::Vector(it));
+        return Py::new_reference_to(list);
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::filterVoxelGrid(PyObject *args)
+{
+    double leafSize;
+    if (!PyArg_ParseTuple(args, "d", &leafSize))
+        return nullptr;
+
+    PY_TRY {
+        PointsFilter filter(*getPointKernelPtr());
+        return Py::new_reference_to(indicesToList(filter.voxelGrid(static_cast<float>(leafSize))));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::filterPoissonDisk(PyObject *args)
+{
+    double radius;
+    if (!PyArg_ParseTuple(args, "d", &radius))
+        return nullptr;
+
+    PY_TRY {
+        PointsFilter filter(*getPointKernelPtr());
+        return Py::new_reference_to(indicesToList(filter.poissonDisk(static_cast<float>(radius))));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::filterOutliers(PyObject *args, PyObject *kwds)
+{
+    int kSearch = 8;
+    double stdDev = 1.0;
+    static char* kwds_outliers[] = {"KSearch", "StdDev", nullptr};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|id", kwds_outliers, &kSearch, &stdDev))
+        return nullptr;
+
+    PY_TRY {
+        PointsFilter filter(*getPointKernelPtr());
+        return Py::new_reference_to(indicesToList(filter.statisticalOutliers(kSearch, static_cast<float>(stdDev))));
+    } PY_CATCH;
+}
+
 Py::Long PointsPy::getCountPoints() const
 {
     return Py::Long((long)getPointKernelPtr()->size());
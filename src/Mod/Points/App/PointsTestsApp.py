@@ -0,0 +1,128 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+#  LGPL
+
+import os
+import random
+import struct
+import tempfile
+import unittest
+import FreeCAD, Points
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD points module
+#---------------------------------------------------------------------------
+
+
+class PointsIOTestCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("PointsIOTest")
+        self.points = [FreeCAD.Vector(0.25 * i, -0.5 * i, 1.0 + 0.125 * i) for i in range(50)]
+        self.fileName = None
+
+    def roundTrip(self, ext):
+        cloud = self.doc.addObject("Points::Feature", "Cloud")
+        cloud.Points = Points.Points(self.points)
+        self.fileName = tempfile.gettempdir() + os.sep + "PointsIOTest." + ext
+        Points.export([cloud], self.fileName)
+        Points.insert(self.fileName, self.doc.Name)
+
+        result = self.doc.Objects[-1]
+        self.assertNotEqual(result, cloud)
+        self.assertEqual(result.Points.CountPoints, len(self.points))
+        for p, q in zip(self.points, result.Points.Points):
+            self.assertAlmostEqual(p.x, q.x, places=5)
+            self.assertAlmostEqual(p.y, q.y, places=5)
+            self.assertAlmostEqual(p.z, q.z, places=5)
+
+    def testRoundTripPLY(self):
+        self.roundTrip("ply")
+
+    def testRoundTripPCD(self):
+        self.roundTrip("pcd")
+
+    def readBinaryPLY(self, fmt, order):
+        self.fileName = tempfile.gettempdir() + os.sep + "PointsIOTest.ply"
+        with open(self.fileName, "wb") as f:
+            f.write("ply\nformat {} 1.0\nelement vertex {}\n"
+                    "property float x\nproperty float y\nproperty double z\n"
+                    "end_header\n".format(fmt, len(self.points)).encode("ascii"))
+            for p in self.points:
+                f.write(struct.pack(order + "ffd", p.x, p.y, p.z))
+        Points.insert(self.fileName, self.doc.Name)
+
+        result = self.doc.Objects[-1]
+        self.assertEqual(result.Points.CountPoints, len(self.points))
+        for p, q in zip(self.points, result.Points.Points):
+            self.assertAlmostEqual(p.x, q.x, places=5)
+            self.assertAlmostEqual(p.y, q.y, places=5)
+            self.assertAlmostEqual(p.z, q.z, places=5)
+
+    def testBinaryLittleEndianPLY(self):
+        self.readBinaryPLY("binary_little_endian", "<")
+
+    def testBinaryBigEndianPLY(self):
+        self.readBinaryPLY("binary_big_endian", ">")
+
+    def tearDown(self):
+        if self.fileName and os.path.exists(self.fileName):
+            os.remove(self.fileName)
+        FreeCAD.closeDocument(self.doc.Name)
+
+
+class PointsSearchTestCases(unittest.TestCase):
+    def setUp(self):
+        rand = random.Random(42)
+        self.points = [FreeCAD.Vector(rand.uniform(-10, 10),
+                                      rand.uniform(-10, 10),
+                                      rand.uniform(-10, 10)) for i in range(200)]
+        self.cloud = Points.Points(self.points)
+
+    def bruteForce(self, point, k):
+        order = sorted(range(len(self.points)), key=lambda i: (self.points[i] - point).Length)
+        return order[0:k]
+
+    def testNearestNeighbours(self):
+        query = FreeCAD.Vector(1.5, -2.0, 0.5)
+        self.assertEqual(self.cloud.nearestNeighbours(query, 7), self.bruteForce(query, 7))
+
+    def testNearestNeighboursList(self):
+        queries = [FreeCAD.Vector(0, 0, 0), FreeCAD.Vector(9, 9, 9), self.points[17]]
+        result = self.cloud.nearestNeighbours(queries, 5)
+        self.assertEqual(len(result), len(queries))
+        for query, neighbours in zip(queries, result):
+            self.assertEqual(neighbours, self.bruteForce(query, 5))
+        self.assertEqual(result[2][0], 17)
+
+    def testInvalidNeighbourCount(self):
+        with self.assertRaises(ValueError):
+            self.cloud.nearestNeighbours(FreeCAD.Vector(), 0)
+        with self.assertRaises(ValueError):
+            self.cloud.estimateNormals(KSearch=0)
+        with self.assertRaises(ValueError):
+            self.cloud.estimateNormals(KSearch=-5)
+        with self.assertRaises(ValueError):
+            self.cloud.filterOutliers(KSearch=-1)
+
+
+class PointsAlgorithmTestCases(unittest.TestCase):
+    def setUp(self):
+        # a planar 10x10 grid with a spacing of 1
+        self.grid = Points.Points([FreeCAD.Vector(x, y, 0) for x in range(10) for y in range(10)])
+
+    def testEstimateNormals(self):
+        normals = self.grid.estimateNormals(KSearch=8)
+        self.assertEqual(len(normals), self.grid.CountPoints)
+        for n in normals:
+            self.assertAlmostEqual(abs(n.z), 1.0, places=5)
+
+    def testFilterVoxelGrid(self):
+        indices = self.grid.filterVoxelGrid(2.0)
+        self.assertEqual(len(indices), 25)
+        self.assertEqual(indices, sorted(indices))
+
+    def testFilterOutliers(self):
+        cloud = Points.Points(self.grid.Points + [FreeCAD.Vector(4.5, 4.5, 50)])
+        indices = cloud.filterOutliers(KSearch=4, StdDev=1.0)
+        self.assertNotIn(100, indices)
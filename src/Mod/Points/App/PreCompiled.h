@@ -45,6 +45,8 @@
 #include <fstream>
 #include <list>
 #include <map>
+#include <memory>
+#include <numeric>
 #include <queue>
 #include <set>
 #include <sstream>
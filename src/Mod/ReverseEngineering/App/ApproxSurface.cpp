@@ -22,13 +22,15 @@
 
 
 #include "PreCompiled.h"
-#include <math_Gauss.hxx>
-#include <math_Householder.hxx>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 #include <Geom_BSplineSurface.hxx>
+#include <gp.hxx>
 #include <Precision.hxx>
 
-#include <QFuture>
-#include <QFutureWatcher>
+#include <QThread>
 #include <QtConcurrentMap>
 
 #include <Mod/Mesh/App/Core/Approximation.h>
@@ -39,7 +41,6 @@
 #include "ApproxSurface.h"
 
 using namespace Reen;
-namespace bp = boost::placeholders;
 
 // SplineBasisfunction
 
@@ -857,64 +858,199 @@ void BSplineParameterCorrection::SetVKnots(const std::vector<double>& afKnots)
     _clVSpline.SetKnots(_vVKnots, _vVMults, _usVOrder);
 }
 
+namespace {
+/**
+ * Symmetric positive definite band matrix. Only the diagonal and the upper band are stored.
+ */
+class SymmetricBandMatrix
+{
+public:
+    SymmetricBandMatrix(int dim, int band)
+      : dim(dim), band(band), values(static_cast<std::size_t>(dim) * (band + 1), 0.0)
+    {
+    }
+    /// Element access for row <= col <= row + band
+    double& operator()(int row, int col)
+    {
+        return values[static_cast<std::size_t>(row) * (band + 1) + (col - row)];
+    }
+    double operator()(int row, int col) const
+    {
+        return values[static_cast<std::size_t>(row) * (band + 1) + (col - row)];
+    }
+    int size() const
+    {
+        return dim;
+    }
+    int bandWidth() const
+    {
+        return band;
+    }
+    SymmetricBandMatrix& operator += (const SymmetricBandMatrix& mat)
+    {
+        std::transform(values.begin(), values.end(), mat.values.begin(), values.begin(), std::plus<double>());
+        return *this;
+    }
+    /**
+     * Replaces the matrix by its Cholesky factor U with A = U^T * U.
+     * Returns false if the matrix is not positive definite.
+     */
+    bool decompose()
+    {
+        for (int i=0; i<dim; i++) {
+            double diag = (*this)(i,i);
+            double sum = diag;
+            for (int k=std::max(0, i-band); k<i; k++)
+                sum -= (*this)(k,i) * (*this)(k,i);
+            if (sum <= std::numeric_limits<double>::epsilon() * diag || sum <= 0.0)
+                return false;
+            double pivot = std::sqrt(sum);
+            (*this)(i,i) = pivot;
+
+            int last = std::min(dim-1, i+band);
+            for (int j=i+1; j<=last; j++) {
+                double val = (*this)(i,j);
+                for (int k=std::max(0, j-band); k<i; k++)
+                    val -= (*this)(k,i) * (*this)(k,j);
+                (*this)(i,j) = val / pivot;
+            }
+        }
+        return true;
+    }
+    /// Solves the system in place after decompose()
+    void solve(std::vector<double>& x) const
+    {
+        for (int i=0; i<dim; i++) {
+            double val = x[i];
+            for (int k=std::max(0, i-band); k<i; k++)
+                val -= (*this)(k,i) * x[k];
+            x[i] = val / (*this)(i,i);
+        }
+        for (int i=dim-1; i>=0; i--) {
+            double val = x[i];
+            int last = std::min(dim-1, i+band);
+            for (int j=i+1; j<=last; j++)
+                val -= (*this)(i,j) * x[j];
+            x[i] = val / (*this)(i,i);
+        }
+    }
+
+private:
+    int dim;
+    int band;
+    std::vector<double> values;
+};
+
+/**
+ * The normal equations M^T*M*x = M^T*b of the least-squares problem for a range of points.
+ */
+struct NormalEquations
+{
+    NormalEquations(int dim, int band)
+      : mtm(dim, band), mtbx(dim, 0.0), mtby(dim, 0.0), mtbz(dim, 0.0)
+    {
+    }
+    SymmetricBandMatrix mtm;
+    std::vector<double> mtbx;
+    std::vector<double> mtby;
+    std::vector<double> mtbz;
+};
+
+/**
+ * Splits the range [0, size) into one block per thread.
+ */
+std::vector<std::pair<int, int> > threadBlocks(int size, int minBlockSize)
+{
+    int numBlocks = std::max(1, std::min(QThread::idealThreadCount(), size / minBlockSize));
+    std::vector<std::pair<int, int> > blocks;
+    for (int i=0; i<numBlocks; i++) {
+        int first = static_cast<int>(static_cast<long long>(size) * i / numBlocks);
+        int last = static_cast<int>(static_cast<long long>(size) * (i+1) / numBlocks);
+        blocks.emplace_back(first, last);
+    }
+    return blocks;
+}
+}
+
 void BSplineParameterCorrection::DoParameterCorrection(int iIter)
 {
     int i=0;
     double fMaxDiff=0.0, fMaxScalar=1.0;
     double fWeight = _fSmoothInfluence;
+    const int lower = _pvcPoints->Lower();
+    const int numPoints = _pvcPoints->Length();
 
-    Base::SequencerLauncher seq("Calc surface...", iIter*_pvcPoints->Length());
+    Base::SequencerLauncher seq("Calc surface...", iIter*numPoints);
 
-    do {
-        fMaxScalar = 1.0;
-        fMaxDiff   = 0.0;
+    // Each point is corrected independently. The points are processed in blocks
+    // and the blocks report their maximum changes.
+    struct Result {
+        double fMaxDiff = 0.0;
+        double fMaxScalar = 1.0;
+    };
+    std::vector<std::pair<int, int> > blocks = threadBlocks(numPoints, 1024);
 
+    do {
         Handle(Geom_BSplineSurface) pclBSplineSurf = new Geom_BSplineSurface(_vCtrlPntsOfSurf,
                                                     _vUKnots, _vVKnots, _vUMults, _vVMults, _usUOrder-1, _usVOrder-1);
 
-        for (int ii=_pvcPoints->Lower();ii <=_pvcPoints->Upper();ii++) {
-            double fDeltaU, fDeltaV, fU, fV;
-            const gp_Pnt& pnt = (*_pvcPoints)(ii);
-            gp_Vec P(pnt.X(), pnt.Y(), pnt.Z());
-            gp_Pnt PntX;
-            gp_Vec Xu, Xv, Xuv, Xuu, Xvv;
-            // Calculate the first two derivatives and point at (u,v)
-            gp_Pnt2d& uvValue = (*_pvcUVParam)(ii);
-            pclBSplineSurf->D2(uvValue.X(), uvValue.Y(), PntX, Xu, Xv, Xuu, Xvv, Xuv);
-            gp_Vec X(PntX.X(), PntX.Y(), PntX.Z());
-            gp_Vec ErrorVec = X - P;
-
-            // Calculate Xu x Xv the normal in X(u,v)
-            gp_Dir clNormal = Xu ^ Xv;
-
-            //Check, if X = P
-            if (!(X.IsEqual(P,0.001,0.001))) {
-                ErrorVec.Normalize();
-                if (fabs(clNormal*ErrorVec) < fMaxScalar)
-                    fMaxScalar = fabs(clNormal*ErrorVec);
-            }
+        std::vector<Result> results(blocks.size());
+        std::vector<int> indices(blocks.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        QtConcurrent::blockingMap(indices, [&](int block) {
+            Result& res = results[block];
+            for (int ii=lower+blocks[block].first; ii<lower+blocks[block].second; ii++) {
+                double fDeltaU, fDeltaV, fU, fV;
+                const gp_Pnt& pnt = (*_pvcPoints)(ii);
+                gp_Vec P(pnt.X(), pnt.Y(), pnt.Z());
+                gp_Pnt PntX;
+                gp_Vec Xu, Xv, Xuv, Xuu, Xvv;
+                // Calculate the first two derivatives and point at (u,v)
+                gp_Pnt2d& uvValue = (*_pvcUVParam)(ii);
+                pclBSplineSurf->D2(uvValue.X(), uvValue.Y(), PntX, Xu, Xv, Xuu, Xvv, Xuv);
+                gp_Vec X(PntX.X(), PntX.Y(), PntX.Z());
+                gp_Vec ErrorVec = X - P;
+
+                //Check, if X = P
+                // Calculate Xu x Xv the normal in X(u,v)
+                // (checked explicitly as exceptions must not escape the worker threads)
+                gp_Vec clNormal = Xu ^ Xv;
+                if (!(X.IsEqual(P,0.001,0.001)) && clNormal.Magnitude() > gp::Resolution()) {
+                    clNormal.Normalize();
+                    ErrorVec.Normalize();
+                    if (fabs(clNormal*ErrorVec) < res.fMaxScalar)
+                        res.fMaxScalar = fabs(clNormal*ErrorVec);
+                }
 
-            fDeltaU =  ( (P-X) * Xu ) / ( (P-X)*Xuu - Xu*Xu );
-            if (fabs(fDeltaU) < Precision::Confusion())
-                fDeltaU = 0.0;
-            fDeltaV =  ( (P-X) * Xv ) / ( (P-X)*Xvv - Xv*Xv );
-            if (fabs(fDeltaV) < Precision::Confusion())
-                fDeltaV = 0.0;
-
-            //Replace old u/v values with new ones
-            fU = uvValue.X() - fDeltaU;
-            fV = uvValue.Y() - fDeltaV;
-            if (fU <= 1.0 && fU >= 0.0 &&
-                fV <= 1.0 && fV >= 0.0) {
-                uvValue.SetX(fU);
-                uvValue.SetY(fV);
-                fMaxDiff = std::max<double>(fabs(fDeltaU), fMaxDiff);
-                fMaxDiff = std::max<double>(fabs(fDeltaV), fMaxDiff);
+                fDeltaU =  ( (P-X) * Xu ) / ( (P-X)*Xuu - Xu*Xu );
+                if (fabs(fDeltaU) < Precision::Confusion())
+                    fDeltaU = 0.0;
+                fDeltaV =  ( (P-X) * Xv ) / ( (P-X)*Xvv - Xv*Xv );
+                if (fabs(fDeltaV) < Precision::Confusion())
+                    fDeltaV = 0.0;
+
+                //Replace old u/v values with new ones
+                fU = uvValue.X() - fDeltaU;
+                fV = uvValue.Y() - fDeltaV;
+                if (fU <= 1.0 && fU >= 0.0 &&
+                    fV <= 1.0 && fV >= 0.0) {
+                    uvValue.SetX(fU);
+                    uvValue.SetY(fV);
+                    res.fMaxDiff = std::max<double>(fabs(fDeltaU), res.fMaxDiff);
+                    res.fMaxDiff = std::max<double>(fabs(fDeltaV), res.fMaxDiff);
+                }
             }
+        });
 
-            seq.next();
+        fMaxScalar = 1.0;
+        fMaxDiff   = 0.0;
+        for (const auto& it : results) {
+            fMaxScalar = std::min<double>(it.fMaxScalar, fMaxScalar);
+            fMaxDiff = std::max<double>(it.fMaxDiff, fMaxDiff);
         }
 
+        seq.setProgress(static_cast<size_t>(i+1)*numPoints);
+
         if (_bSmoothing) {
             fWeight *= 0.5f;
             SolveWithSmoothing(fWeight);
@@ -930,215 +1066,106 @@ void BSplineParameterCorrection::DoParameterCorrection(int iIter)
 
 bool BSplineParameterCorrection::SolveWithoutSmoothing()
 {
-    unsigned ulSize = _pvcPoints->Length();
-    unsigned ulDim  = _usUCtrlpoints*_usVCtrlpoints;
-    math_Matrix M  (0, ulSize-1, 0, ulDim-1);
-    math_Matrix Xx (0, ulDim-1, 0, 0);
-    math_Matrix Xy (0, ulDim-1, 0, 0);
-    math_Matrix Xz (0, ulDim-1, 0, 0);
-    math_Vector bx (0, ulSize-1);
-    math_Vector by (0, ulSize-1);
-    math_Vector bz (0, ulSize-1);
-
-    // Determining the coefficient matrix of the overdetermined LGS
-    for (unsigned i=0; i<ulSize; i++) {
-        const gp_Pnt2d& uvValue = (*_pvcUVParam)(i);
-        double fU = uvValue.X();
-        double fV = uvValue.Y();
-        unsigned ulIdx=0;
-
-        // Pre-calculation of the values of the base functions
-        std::vector<double> basisU(_usUCtrlpoints);
-        for (unsigned j=0; j<_usUCtrlpoints; j++) {
-            basisU[j] = _clUSpline.BasisFunction(j,fU);
-        }
-        std::vector<double> basisV(_usVCtrlpoints);
-        for (unsigned k=0; k<_usVCtrlpoints; k++) {
-            basisV[k] = _clVSpline.BasisFunction(k,fV);
-        }
-
-        for (unsigned j=0; j<_usUCtrlpoints; j++) {
-            double valueU = basisU[j];
-            if (valueU == 0.0) {
-                for (unsigned k=0; k<_usVCtrlpoints; k++) {
-                    M(i,ulIdx) = 0.0;
-                    ulIdx++;
-                }
-            }
-            else {
-                for (unsigned k=0; k<_usVCtrlpoints; k++) {
-                    M(i,ulIdx) = valueU * basisV[k];
-                    ulIdx++;
-                }
-            }
-        }
-    }
-
-    // Determine the right side
-    for (int ii=_pvcPoints->Lower(); ii<=_pvcPoints->Upper(); ii++) {
-        const gp_Pnt& pnt = (*_pvcPoints)(ii);
-        bx(ii) = pnt.X(); by(ii) = pnt.Y(); bz(ii) = pnt.Z();
-    }
-
-    // Solve the over-determined LGS with Householder-Transformation
-    math_Householder hhX(M,bx);
-    math_Householder hhY(M,by);
-    math_Householder hhZ(M,bz);
-
-    if (!(hhX.IsDone() && hhY.IsDone() && hhZ.IsDone()))
-        // LGS could not be solved
-        return false;
-    Xx = hhX.AllValues();
-    Xy = hhY.AllValues();
-    Xz = hhZ.AllValues();
-
-    unsigned ulIdx=0;
-    for (unsigned j=0;j<_usUCtrlpoints;j++) {
-        for (unsigned k=0;k<_usVCtrlpoints;k++) {
-            _vCtrlPntsOfSurf(j,k) = gp_Pnt(Xx(ulIdx,0),Xy(ulIdx,0),Xz(ulIdx,0));
-            ulIdx++;
-        }
-    }
-
-    return true;
+    return SolveNormalEquations(0.0);
 }
 
-namespace Reen {
-class ScalarProduct
+bool BSplineParameterCorrection::SolveWithSmoothing(double fWeight)
 {
-public:
-    ScalarProduct(const math_Matrix& mat) : mat(mat)
-    {
-    }
-    std::vector<double> multiply(int col) const
-    {
-        math_Vector vec = mat.Col(col);
-        std::vector<double> out(mat.ColNumber());
-        for (int n=mat.LowerCol(); n<=mat.UpperCol(); n++) {
-            out[n] = vec * mat.Col(n);
-        }
-        return out;
-    }
-
-private:
-    const math_Matrix& mat;
-};
+    return SolveNormalEquations(fWeight);
 }
 
-bool BSplineParameterCorrection::SolveWithSmoothing(double fWeight)
+bool BSplineParameterCorrection::SolveNormalEquations(double fWeight)
 {
-    unsigned ulSize = _pvcPoints->Length();
-    unsigned ulDim  = _usUCtrlpoints*_usVCtrlpoints;
-    math_Matrix M  (0, ulSize-1, 0, ulDim-1);
-    math_Vector Xx (0, ulDim-1);
-    math_Vector Xy (0, ulDim-1);
-    math_Vector Xz (0, ulDim-1);
-    math_Vector bx (0, ulSize-1);
-    math_Vector by (0, ulSize-1);
-    math_Vector bz (0, ulSize-1);
-    math_Vector Mbx(0, ulDim-1);
-    math_Vector Mby(0, ulDim-1);
-    math_Vector Mbz(0, ulDim-1);
-
-    // Determining the coefficient matrix of the overdetermined LGS
-    for (unsigned i=0; i<ulSize; i++) {
-        const gp_Pnt2d& uvValue = (*_pvcUVParam)(i);
-        double fU = uvValue.X();
-        double fV = uvValue.Y();
-        int ulIdx=0;
-
-        // Pre-calculation of the values of the basis functions
-        std::vector<double> basisU(_usUCtrlpoints);
-        for (unsigned j=0; j<_usUCtrlpoints; j++) {
-            basisU[j] = _clUSpline.BasisFunction(j,fU);
-        }
-        std::vector<double> basisV(_usVCtrlpoints);
-        for (unsigned k=0; k<_usVCtrlpoints; k++) {
-            basisV[k] = _clVSpline.BasisFunction(k,fV);
-        }
-
-        for (unsigned j=0; j<_usUCtrlpoints; j++) {
-            double valueU = basisU[j];
-            if (valueU == 0.0) {
-                for (unsigned k=0; k<_usVCtrlpoints; k++) {
-                    M(i,ulIdx) = 0.0;
-                    ulIdx++;
+    const int lower = _pvcPoints->Lower();
+    const int numPoints = _pvcPoints->Length();
+    const int uOrder = static_cast<int>(_usUOrder);
+    const int vOrder = static_cast<int>(_usVOrder);
+    const int numV = static_cast<int>(_usVCtrlpoints);
+    const int ulDim = static_cast<int>(_usUCtrlpoints*_usVCtrlpoints);
+
+    // A point only affects the uOrder x vOrder control points of its knot span. With the
+    // control point (j,k) at index j*numV+k all non-zero entries of M^T*M lie in this band.
+    const int band = std::min(ulDim-1, (uOrder-1)*numV + vOrder-1);
+
+    // Each thread accumulates the contributions of its points into its own system
+    std::vector<std::pair<int, int> > blocks = threadBlocks(numPoints, 4096);
+    std::vector<NormalEquations> systems(blocks.size(), NormalEquations(ulDim, band));
+    std::vector<int> indices(blocks.size());
+    std::iota(indices.begin(), indices.end(), 0);
+
+    QtConcurrent::blockingMap(indices, [&](int block) {
+        NormalEquations& system = systems[block];
+        TColStd_Array1OfReal basisU(0, uOrder-1);
+        TColStd_Array1OfReal basisV(0, vOrder-1);
+        std::vector<int> index(uOrder*vOrder);
+        std::vector<double> value(uOrder*vOrder);
+
+        for (int ii=lower+blocks[block].first; ii<lower+blocks[block].second; ii++) {
+            const gp_Pnt2d& uvValue = (*_pvcUVParam)(ii);
+            double fU = uvValue.X();
+            double fV = uvValue.Y();
+            // all basis functions vanish outside the parameter range
+            if (fU < 0.0 || fU > 1.0 || fV < 0.0 || fV > 1.0)
+                continue;
+
+            // Only the basis functions of the knot span are non-zero
+            int firstU = _clUSpline.FindSpan(fU) - (uOrder-1);
+            int firstV = _clVSpline.FindSpan(fV) - (vOrder-1);
+            _clUSpline.AllBasisFunctions(fU, basisU);
+            _clVSpline.AllBasisFunctions(fV, basisV);
+
+            int num=0;
+            for (int j=0; j<uOrder; j++) {
+                for (int k=0; k<vOrder; k++) {
+                    index[num] = (firstU+j)*numV + firstV+k;
+                    value[num] = basisU(j) * basisV(k);
+                    num++;
                 }
             }
-            else {
-                for (unsigned k=0; k<_usVCtrlpoints; k++) {
-                    M(i,ulIdx) = valueU * basisV[k];
-                    ulIdx++;
-                }
+
+            const gp_Pnt& pnt = (*_pvcPoints)(ii);
+            for (int m=0; m<num; m++) {
+                int row = index[m];
+                double val = value[m];
+                if (val == 0.0)
+                    continue;
+                for (int n=m; n<num; n++)
+                    system.mtm(row, index[n]) += val * value[n];
+                system.mtbx[row] += val * pnt.X();
+                system.mtby[row] += val * pnt.Y();
+                system.mtbz[row] += val * pnt.Z();
             }
         }
-    }
-
-    // The product of its transform and itself results in the quadratic
-    // system matrix (slowly)
-#if 0
-    math_Matrix MTM = M.TMultiply(M);
-#elif 0
-    math_Matrix MTM(0, ulDim-1, 0, ulDim-1);
-    for (unsigned m=0; m<ulDim; m++) {
-        math_Vector Mm = M.Col(m);
-        for (unsigned n=m; n<ulDim; n++) {
-            MTM(m,n) = MTM(n,m) = Mm * M.Col(n);
+    });
+
+    NormalEquations& system = systems.front();
+    for (std::size_t i=1; i<systems.size(); i++) {
+        system.mtm += systems[i].mtm;
+        std::transform(system.mtbx.begin(), system.mtbx.end(), systems[i].mtbx.begin(), system.mtbx.begin(), std::plus<double>());
+        std::transform(system.mtby.begin(), system.mtby.end(), systems[i].mtby.begin(), system.mtby.begin(), std::plus<double>());
+        std::transform(system.mtbz.begin(), system.mtbz.end(), systems[i].mtbz.begin(), system.mtbz.begin(), std::plus<double>());
+    }
+
+    // The smoothing functionals have the same local support as the basis functions
+    if (fWeight != 0.0) {
+        for (int m=0; m<ulDim; m++) {
+            int last = std::min(ulDim-1, m+band);
+            for (int n=m; n<=last; n++)
+                system.mtm(m,n) += fWeight * _clSmoothMatrix(m,n);
         }
     }
-#else // multi-threaded
-    std::vector<int> columns(ulDim);
-    std::generate(columns.begin(), columns.end(), Base::iotaGen<int>(0));
-    ScalarProduct scalar(M);
-    QFuture< std::vector<double> > future = QtConcurrent::mapped
-        (columns, boost::bind(&ScalarProduct::multiply, &scalar, bp::_1));
-    QFutureWatcher< std::vector<double> > watcher;
-    watcher.setFuture(future);
-    watcher.waitForFinished();
-
-    math_Matrix MTM(0, ulDim-1, 0, ulDim-1);
-    int rowIndex=0;
-    for (QFuture< std::vector<double> >::const_iterator it = future.begin(); it != future.end(); ++it) {
-        int colIndex=0;
-        for (std::vector<double>::const_iterator jt = it->begin(); jt != it->end(); ++jt, colIndex++)
-            MTM(rowIndex, colIndex) = *jt;
-        rowIndex++;
-    }
-#endif
-
-    // Determine the right side
-    for (int ii=_pvcPoints->Lower(); ii<=_pvcPoints->Upper(); ii++) {
-        const gp_Pnt& pnt = (*_pvcPoints)(ii);
-        bx(ii) = pnt.X(); by(ii) = pnt.Y(); bz(ii) = pnt.Z();
-    }
-    for (unsigned i=0; i<ulDim; i++) {
-        math_Vector Mi = M.Col(i);
-        Mbx(i) = Mi * bx;
-        Mby(i) = Mi * by;
-        Mbz(i) = Mi * bz;
-    }
-
-    // Solve the LGS with the LU decomposition
-    math_Gauss mgGaussX(MTM+fWeight*_clSmoothMatrix);
-    math_Gauss mgGaussY(MTM+fWeight*_clSmoothMatrix);
-    math_Gauss mgGaussZ(MTM+fWeight*_clSmoothMatrix);
-
-    mgGaussX.Solve(Mbx,Xx);
-    if (!mgGaussX.IsDone())
-        return false;
-
-    mgGaussY.Solve(Mby,Xy);
-    if (!mgGaussY.IsDone())
-        return false;
 
-    mgGaussZ.Solve(Mbz,Xz);
-    if (!mgGaussZ.IsDone())
+    // Solve the LGS with the Cholesky decomposition
+    if (!system.mtm.decompose())
         return false;
+    system.mtm.solve(system.mtbx);
+    system.mtm.solve(system.mtby);
+    system.mtm.solve(system.mtbz);
 
     unsigned ulIdx=0;
     for (unsigned j=0;j<_usUCtrlpoints;j++) {
         for (unsigned k=0;k<_usVCtrlpoints;k++) {
-            _vCtrlPntsOfSurf(j,k) = gp_Pnt(Xx(ulIdx),Xy(ulIdx),Xz(ulIdx));
+            _vCtrlPntsOfSurf(j,k) = gp_Pnt(system.mtbx[ulIdx],system.mtby[ulIdx],system.mtbz[ulIdx]);
             ulIdx++;
         }
     }
@@ -1160,6 +1187,13 @@ void BSplineParameterCorrection::CalcSmoothingTerms(bool bRecalc, double fFirst,
                       fThird  * _clThirdMatrix  ;
 }
 
+bool BSplineParameterCorrection::HasCommonSupport(unsigned i, unsigned j, unsigned k, unsigned l) const
+{
+    unsigned du = i > k ? i - k : k - i;
+    unsigned dv = j > l ? j - l : l - j;
+    return du < _usUOrder && dv < _usVOrder;
+}
+
 void BSplineParameterCorrection::CalcFirstSmoothMatrix(Base::SequencerLauncher& seq)
 {
     unsigned m=0;
@@ -1169,6 +1203,13 @@ void BSplineParameterCorrection::CalcFirstSmoothMatrix(Base::SequencerLauncher&
 
             for (unsigned i=0; i<_usUCtrlpoints; i++) {
                 for (unsigned j=0; j<_usVCtrlpoints; j++) {
+                    // the integrals vanish if the supports of the basis functions are disjoint
+                    if (!HasCommonSupport(i, j, k, l)) {
+                        _clFirstMatrix(m,n) = 0.0;
+                        seq.next();
+                        n++;
+                        continue;
+                    }
                     _clFirstMatrix(m,n) =   _clUSpline.GetIntegralOfProductOfBSplines(i,k,1,1) *
                                             _clVSpline.GetIntegralOfProductOfBSplines(j,l,0,0) +
                                             _clUSpline.GetIntegralOfProductOfBSplines(i,k,0,0) *
@@ -1191,6 +1232,13 @@ void BSplineParameterCorrection::CalcSecondSmoothMatrix(Base::SequencerLauncher&
 
             for (unsigned i=0; i<_usUCtrlpoints; i++) {
                 for (unsigned j=0; j<_usVCtrlpoints; j++) {
+                    // the integrals vanish if the supports of the basis functions are disjoint
+                    if (!HasCommonSupport(i, j, k, l)) {
+                        _clSecondMatrix(m,n) = 0.0;
+                        seq.next();
+                        n++;
+                        continue;
+                    }
                     _clSecondMatrix(m,n) =  _clUSpline.GetIntegralOfProductOfBSplines(i,k,2,2) *
                                             _clVSpline.GetIntegralOfProductOfBSplines(j,l,0,0) +
                                           2*_clUSpline.GetIntegralOfProductOfBSplines(i,k,1,1) *
@@ -1215,6 +1263,13 @@ void BSplineParameterCorrection::CalcThirdSmoothMatrix(Base::SequencerLauncher&
 
             for (unsigned i=0; i<_usUCtrlpoints; i++) {
                 for (unsigned j=0; j<_usVCtrlpoints; j++) {
+                    // the integrals vanish if the supports of the basis functions are disjoint
+                    if (!HasCommonSupport(i, j, k, l)) {
+                        _clThirdMatrix(m,n) = 0.0;
+                        seq.next();
+                        n++;
+                        continue;
+                    }
                     _clThirdMatrix(m,n) = _clUSpline.GetIntegralOfProductOfBSplines(i,k,3,3) *
                                           _clVSpline.GetIntegralOfProductOfBSplines(j,l,0,0) +
                                           _clUSpline.GetIntegralOfProductOfBSplines(i,k,3,1) *
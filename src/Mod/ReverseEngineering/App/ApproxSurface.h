@@ -389,16 +389,23 @@ protected:
     virtual void DoParameterCorrection(int iIter);
 
     /**
-     * Solve an overdetermined LGS with the help of the Householder-Tansformation
+     * Solve the overdetermined LGS in the least-squares sense
      */
     virtual bool SolveWithoutSmoothing();
 
     /**
-     * Solve a regular system of equations by LU decomposition. Depending on the weighting,
+     * Solve the overdetermined LGS in the least-squares sense. Depending on the weighting,
      * smoothing terms are included
      */
     virtual bool SolveWithSmoothing(double fWeight);
 
+    /**
+     * Sets up the normal equations in parallel and solves them with a Cholesky decomposition.
+     * As the B-spline basis functions have a local support the system matrix is banded and
+     * only the band is stored.
+     */
+    bool SolveNormalEquations(double fWeight);
+
 public:
     /**
      * Setting the knot vector
@@ -475,6 +482,11 @@ protected:
      */
     virtual void CalcThirdSmoothMatrix(Base::SequencerLauncher&);
 
+    /**
+     * Checks whether the basis functions of the control points (i,j) and (k,l) overlap
+     */
+    bool HasCommonSupport(unsigned i, unsigned j, unsigned k, unsigned l) const;
+
 protected:
     BSplineBasis           _clUSpline;        //! B-spline basic function in the u-direction
     BSplineBasis           _clVSpline;        //! B-spline basic function in the v-direction
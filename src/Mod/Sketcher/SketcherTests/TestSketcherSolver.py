@@ -267,6 +267,51 @@ class TestSketcherSolver(unittest.TestCase):
         sketch.addConstraint(Sketcher.Constraint('Coincident',2,1,1,2))
         self.assertEqual(sketch.detectMissingPointOnPointConstraints(0.0001), 0)
 
+    def testUndoManyGeometries(self):
+        # large geometry lists are copied in parallel for undo and redo
+        self.Doc.UndoMode = 1
+        sketch = self.Doc.addObject('Sketcher::SketchObject','Sketch')
+        self.Doc.openTransaction("Add lines")
+        sketch.addGeometry([Part.LineSegment(App.Vector(i,0,0),App.Vector(i,1,0)) for i in range(2000)],False)
+        self.Doc.commitTransaction()
+        self.Doc.openTransaction("Add circle")
+        sketch.addGeometry(Part.Circle(App.Vector(0,0,0),App.Vector(0,0,1),5),False)
+        self.Doc.commitTransaction()
+        self.Doc.undo()
+        self.assertEqual(len(sketch.Geometry), 2000)
+        self.assertAlmostEqual(sketch.Geometry[1999].StartPoint.x, 1999)
+        self.Doc.redo()
+        self.assertEqual(len(sketch.Geometry), 2001)
+        self.assertAlmostEqual(sketch.Geometry[2000].Radius, 5)
+
+    def testUndoSharedGeometry(self):
+        # undo and redo share the geometries until the sketch is changed
+        self.Doc.UndoMode = 1
+        sketch = self.Doc.addObject('Sketcher::SketchObject','Sketch')
+        self.Doc.openTransaction("Add lines")
+        sketch.addGeometry([Part.LineSegment(App.Vector(i,0,0),App.Vector(i,1,0)) for i in range(10)],False)
+        self.Doc.commitTransaction()
+        self.Doc.openTransaction("Move point")
+        sketch.movePoint(3,2,App.Vector(3,5,0))
+        self.Doc.commitTransaction()
+        self.assertAlmostEqual(sketch.Geometry[3].EndPoint.y, 5)
+        self.Doc.undo()
+        self.assertAlmostEqual(sketch.Geometry[3].EndPoint.y, 1)
+        self.Doc.redo()
+        self.assertAlmostEqual(sketch.Geometry[3].EndPoint.y, 5)
+
+        # changing the sketch doesn't change the state kept for undo
+        self.Doc.openTransaction("Move again")
+        sketch.movePoint(3,2,App.Vector(3,7,0))
+        self.Doc.commitTransaction()
+        copy = sketch.Geometry
+        self.Doc.undo()
+        self.assertAlmostEqual(sketch.Geometry[3].EndPoint.y, 5)
+        self.assertAlmostEqual(copy[3].EndPoint.y, 7)
+        self.Doc.undo()
+        self.assertAlmostEqual(sketch.Geometry[3].EndPoint.y, 1)
+        self.assertEqual(len(set(g.Tag for g in sketch.Geometry)), 10)
+
     def tearDown(self):
         #closing doc
         FreeCAD.closeDocument("SketchSolverTest")